@@ -0,0 +1,216 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * A microbenchmark of the point-in-tetrahedron and tetrahedron-in-box tests.
+ * Each test is executed on windows of consecutive tetrahedra (as the runs of a leaf) with three implementations:
+ * - legacy: the previous wrappers, that allocate the coordinates arrays on the heap at each test
+ * - scalar: the current Geometry_Wrapper tests, one tetrahedron at a time
+ * - batched: the SIMD tests, on Geometry_Wrapper::BATCH_SIZE tetrahedra at a time
+ * The three implementations must return the same number of positive tests.
+ *
+ * usage: geometry_benchmark mesh.ts [queries_num]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <bitset>
+#include "geometry/geometry_wrapper.h"
+#include "io/reader.h"
+#include "utilities/timer.h"
+
+using namespace std;
+
+///the number of consecutive tetrahedra tested by each query
+static const int WINDOW = 64;
+
+/**
+ * @brief A class replicating the tests executed before the introduction of the stack-based wrappers
+ */
+class Legacy_Geometry : public Geometry
+{
+public:
+    static bool point_in_tetra(int t_id, Point& point, Mesh &mesh)
+    {
+        Tetrahedron &tet = mesh.get_tetrahedron(t_id);
+        double **c = new double* [4];
+        for (int i = 0; i < tet.vertices_num(); i++)
+        {
+            c[i] = new double[3];
+            Vertex v = mesh.get_vertex(tet.TV(i));
+            c[i][0] = v.get_x(); c[i][1] = v.get_y(); c[i][2] = v.get_z();
+        }
+        bool ret = PointInTetra(point.get_x(),point.get_y(),point.get_z(),c[0],c[1],c[2],c[3]);
+        for (int i = 0; i < 4; i++)
+            delete[] c[i];
+        delete[] c;
+        return ret;
+    }
+
+    static bool tetra_in_box(int t_id, Box& box, Mesh& mesh)
+    {
+        Tetrahedron &t = mesh.get_tetrahedron(t_id);
+        double* minf = new double[3];
+        minf[0] = box.get_min().get_x(); minf[1] = box.get_min().get_y(); minf[2] = box.get_min().get_z();
+        double* maxf = new double[3];
+        maxf[0] = box.get_max().get_x(); maxf[1] = box.get_max().get_y(); maxf[2] = box.get_max().get_z();
+        double **c = new double* [4];
+        for (int i = 0; i < t.vertices_num(); i++)
+        {
+            c[i] = new double[3];
+            Vertex v = mesh.get_vertex(t.TV(i));
+            c[i][0] = v.get_x(); c[i][1] = v.get_y(); c[i][2] = v.get_z();
+        }
+        bool ret = tetra_in_box_strict(minf, maxf, c);
+        delete[] minf;
+        delete[] maxf;
+        for (int i = 0; i < t.vertices_num(); i++)
+            delete[] c[i];
+        delete[] c;
+        return ret;
+    }
+};
+
+static void print_result(string name, double time, double base_time, long hits)
+{
+    cout<<"  "<<name<<": "<<time<<" sec  speedup "<<base_time/time<<"x  (positive tests "<<hits<<")"<<endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        cerr<<"usage: "<<argv[0]<<" mesh.ts [queries_num]"<<endl;
+        return EXIT_FAILURE;
+    }
+    int queries_num = (argc > 2) ? atoi(argv[2]) : 200000;
+
+    Mesh mesh;
+    if(!Reader::read_mesh(mesh, argv[1], 1))
+    {
+        cerr<<"[ERROR] cannot read the mesh "<<argv[1]<<endl;
+        return EXIT_FAILURE;
+    }
+    int num_t = mesh.get_num_tetrahedra();
+    int window = (num_t < WINDOW) ? num_t : WINDOW;
+
+    // each query tests a window of tetrahedra starting from a random one,
+    // with a point (and a box) placed around the centroid of a tetrahedron of the window
+    mt19937 gen(42);
+    uniform_int_distribution<int> first_dist(1, num_t - window + 1);
+    uniform_real_distribution<double> offset_dist(-0.5, 0.5);
+    Box &dom = mesh.get_domain();
+    double extent = (dom.get_max().get_x() - dom.get_min().get_x()) / 100.0;
+
+    vector<int> firsts(queries_num);
+    vector<Point> points(queries_num);
+    vector<Box> boxes(queries_num);
+    for(int q=0; q<queries_num; q++)
+    {
+        firsts[q] = first_dist(gen);
+        Point c;
+        Geometry_Wrapper::get_tetrahedron_centroid(firsts[q] + window/2, c, mesh);
+        points[q] = Point(c.get_x() + offset_dist(gen)*extent, c.get_y() + offset_dist(gen)*extent, c.get_z() + offset_dist(gen)*extent);
+        Point min(c.get_x() - extent, c.get_y() - extent, c.get_z() - extent);
+        Point max(c.get_x() + extent, c.get_y() + extent, c.get_z() + extent);
+        boxes[q] = Box(min, max);
+    }
+
+    Timer time;
+    long hits[3] = {0, 0, 0};
+    double times[3];
+
+    cout<<"point-in-tetrahedron ("<<queries_num<<" queries, "<<window<<" tetrahedra each)"<<endl;
+    time.start();
+    for(int q=0; q<queries_num; q++)
+        for(int t=firsts[q]; t<firsts[q]+window; t++)
+            hits[0] += Legacy_Geometry::point_in_tetra(t, points[q], mesh);
+    time.stop();
+    times[0] = time.get_elapsed_time();
+    time.start();
+    for(int q=0; q<queries_num; q++)
+        for(int t=firsts[q]; t<firsts[q]+window; t++)
+            hits[1] += Geometry_Wrapper::point_in_tetra(t, points[q], mesh);
+    time.stop();
+    times[1] = time.get_elapsed_time();
+    time.start();
+    for(int q=0; q<queries_num; q++)
+    {
+        int t_ids[Geometry_Wrapper::BATCH_SIZE];
+        for(int t=firsts[q]; t<firsts[q]+window; t+=Geometry_Wrapper::BATCH_SIZE)
+        {
+            int num = min(Geometry_Wrapper::BATCH_SIZE, firsts[q]+window-t);
+            for(int i=0; i<num; i++)
+                t_ids[i] = t + i;
+            hits[2] += bitset<Geometry_Wrapper::BATCH_SIZE>(Geometry_Wrapper::point_in_tetra_batch(t_ids, num, points[q], mesh)).count();
+        }
+    }
+    time.stop();
+    times[2] = time.get_elapsed_time();
+    print_result("legacy ", times[0], times[0], hits[0]);
+    print_result("scalar ", times[1], times[0], hits[1]);
+    print_result("batched", times[2], times[0], hits[2]);
+    bool same = (hits[0] == hits[1] && hits[1] == hits[2]);
+
+    hits[0] = hits[1] = hits[2] = 0;
+    cout<<"tetrahedron-in-box ("<<queries_num<<" queries, "<<window<<" tetrahedra each)"<<endl;
+    time.start();
+    for(int q=0; q<queries_num; q++)
+        for(int t=firsts[q]; t<firsts[q]+window; t++)
+            hits[0] += Legacy_Geometry::tetra_in_box(t, boxes[q], mesh);
+    time.stop();
+    times[0] = time.get_elapsed_time();
+    time.start();
+    for(int q=0; q<queries_num; q++)
+        for(int t=firsts[q]; t<firsts[q]+window; t++)
+            hits[1] += Geometry_Wrapper::tetra_in_box(t, boxes[q], mesh);
+    time.stop();
+    times[1] = time.get_elapsed_time();
+    time.start();
+    for(int q=0; q<queries_num; q++)
+    {
+        int t_ids[Geometry_Wrapper::BATCH_SIZE];
+        for(int t=firsts[q]; t<firsts[q]+window; t+=Geometry_Wrapper::BATCH_SIZE)
+        {
+            int num = min(Geometry_Wrapper::BATCH_SIZE, firsts[q]+window-t);
+            for(int i=0; i<num; i++)
+                t_ids[i] = t + i;
+            hits[2] += bitset<Geometry_Wrapper::BATCH_SIZE>(Geometry_Wrapper::tetra_in_box_batch(t_ids, num, boxes[q], mesh)).count();
+        }
+    }
+    time.stop();
+    times[2] = time.get_elapsed_time();
+    print_result("legacy ", times[0], times[0], hits[0]);
+    print_result("scalar ", times[1], times[0], hits[1]);
+    print_result("batched", times[2], times[0], hits[2]);
+    same = same && (hits[0] == hits[1] && hits[1] == hits[2]);
+
+    if(!same)
+    {
+        cerr<<"[ERROR] the implementations returned different results"<<endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Microbenchmark of the geometric tests
+# (legacy heap-based wrappers vs. stack-based and batched SIMD tests)
+#
+#-------------------------------------------------
+
+include(../tetrahedral_trees.pri)
+
+TEMPLATE = app
+TARGET = geometry_benchmark
+
+# Directories
+DESTDIR = ../dist/
+OBJECTS_DIR = ../build/geometry_benchmark/
+
+# the library sources are not compiled again, but linked from the library (built by the main project)
+LIBS += -L$$OUT_PWD/../dist -ltetrahedral_trees
+# the shared library is searched next to the executable
+QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+
+SOURCES += \
+    geometry_benchmark.cpp
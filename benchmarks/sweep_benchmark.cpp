@@ -0,0 +1,484 @@
+/*
+ * A benchmark that sweeps the Tetrahedral trees built on a mesh, for choosing the index parameters of a dataset.
+ * For each subdivision (ok, kd), criterion (pr, pm, pm2, pmr) and threshold of the grids, the tree is built and reindexed,
+ * its size is measured, and the point locations, box queries, line queries, windowed VT and windowed TT queries are executed.
+ * Each phase is executed a number of times without measuring it (warmup), and then measured for a number of repetitions:
+ * the build and reindexing times are the medians of the repetitions, while the latencies of all the measured queries are collected in a histogram.
+ * The queries are generated from a fixed seed, thus two executions (e.g., of two versions of the library) are directly comparable.
+ * The results of all the configurations are written in a single report, in the files report.csv and report.json
+ * (report is the prefix given by -o: sweep_report.csv and sweep_report.json by default).
+ * A threshold not used by a criterion is reported as -1.
+ *
+ * usage: sweep_benchmark mesh.ts [options]
+ *   -d [divisions]   comma-separated subdivisions (default ok,kd)
+ *   -c [criteria]    comma-separated criteria (default pr,pm,pm2,pmr)
+ *   -v [grid]        comma-separated vertices thresholds, used by pr and pm (default 10,20,50,100)
+ *   -t [grid]        comma-separated tetrahedra thresholds, used by pm, pm2 and pmr (default 30,60,120,240)
+ *   -b [build]       construction type: seq, bulk or morton (default seq)
+ *   -p [threads]     threads used by the bulk and morton constructions (default: hardware threads)
+ *   -n [queries]     number of queries of each type (default 1000)
+ *   -x [ratio]       side of the boxes and length of the lines, as a fraction of the maximum side of the domain (default 0.05)
+ *   -w [warmup]      number of warmup executions (default 1)
+ *   -r [repetitions] number of measured executions (default 3)
+ *   -s [seed]        seed of the query generator (default 42)
+ *   -o [report]      prefix of the report files (default sweep_report)
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include "tetrahedral_trees/ok_subdivision.h"
+#include "tetrahedral_trees/kd_subdivision.h"
+#include "tetrahedral_trees/p_tree.h"
+#include "tetrahedral_trees/pt_tree.h"
+#include "tetrahedral_trees/t_tree.h"
+#include "tetrahedral_trees/rt_tree.h"
+#include "tetrahedral_trees/reindexer.h"
+#include "tetrahedral_trees/frozen_tree.h"
+#include "queries/spatial_queries.h"
+#include "queries/topological_queries.h"
+#include "geometry/geometry_wrapper.h"
+#include "statistics/latency_histogram.h"
+#include "io/reader.h"
+#include "utilities/string_management.h"
+#include "utilities/thread_pool.h"
+
+using namespace std;
+using namespace string_management;
+
+///the parameters of the sweep
+struct Sweep_Parameters
+{
+    vector<string> divisions, criteria;
+    vector<int> vertices_grid, tetrahedra_grid;
+    string build_type;
+    int threads_num, queries_num, warmup, repetitions;
+    unsigned seed;
+    double ratio;
+    string report_path;
+
+    Sweep_Parameters()
+    {
+        divisions = { "ok", "kd" };
+        criteria = { "pr", "pm", "pm2", "pmr" };
+        vertices_grid = { 10, 20, 50, 100 };
+        tetrahedra_grid = { 30, 60, 120, 240 };
+        build_type = "seq";
+        threads_num = Thread_Pool::get_hardware_threads_num();
+        queries_num = 1000;
+        warmup = 1;
+        repetitions = 3;
+        seed = 42;
+        ratio = 0.05;
+        report_path = "sweep_report";
+    }
+};
+
+///the query types measured by the benchmark
+enum Query_Type { POINT_QUERY, BOX_QUERY, LINE_QUERY, WVT_QUERY, WTT_QUERY, QUERY_TYPES_NUM };
+static const char* QUERY_NAMES[QUERY_TYPES_NUM] = { "point", "box", "line", "wvt", "wtt" };
+
+///the measures of a configuration
+struct Sweep_Result
+{
+    string division, criterion;
+    int vertices_per_leaf, tetrahedra_per_leaf;
+    double build_time, reindex_time;
+    size_t nodes_num, arena_bytes, frozen_bytes;
+    ///the median time of a measured execution of all the queries of a type
+    double pass_time[QUERY_TYPES_NUM];
+    Latency_Histogram latency[QUERY_TYPES_NUM];
+};
+
+///the queries executed on each configuration
+struct Sweep_Queries
+{
+    vector<Point> points;
+    vector<Box> boxes, lines;
+};
+
+static double get_median(vector<double> values)
+{
+    if(values.empty())
+        return 0;
+    sort(values.begin(),values.end());
+    return values[values.size()/2];
+}
+
+static bool parse_grid(const char *arg, vector<int> &grid)
+{
+    vector<string> tokens;
+    tokenize(arg,tokens,",");
+    grid.clear();
+    for(unsigned i=0; i<tokens.size(); i++)
+    {
+        int value = atoi(tokens[i].c_str());
+        if(value < 1)
+            return false;
+        grid.push_back(value);
+    }
+    return !grid.empty();
+}
+
+static int read_parameters(int argc, char** argv, Sweep_Parameters &params)
+{
+    for(int i=2; i<argc; i++)
+    {
+        if(i+1 >= argc)
+        {
+            cerr<<"[ERROR] missing value for the option "<<argv[i]<<endl;
+            return -1;
+        }
+        const char *tag = argv[i];
+        const char *value = argv[++i];
+        if(strcmp(tag,"-d") == 0)
+        {
+            params.divisions.clear();
+            tokenize(value,params.divisions,",");
+            for(unsigned j=0; j<params.divisions.size(); j++)
+            {
+                if(params.divisions[j] != "ok" && params.divisions[j] != "kd")
+                {
+                    cerr<<"[ERROR] the subdivisions must be ok or kd"<<endl;
+                    return -1;
+                }
+            }
+        }
+        else if(strcmp(tag,"-c") == 0)
+        {
+            params.criteria.clear();
+            tokenize(value,params.criteria,",");
+            for(unsigned j=0; j<params.criteria.size(); j++)
+            {
+                if(params.criteria[j] != "pr" && params.criteria[j] != "pm" && params.criteria[j] != "pm2" && params.criteria[j] != "pmr")
+                {
+                    cerr<<"[ERROR] the criteria must be pr, pm, pm2 or pmr"<<endl;
+                    return -1;
+                }
+            }
+        }
+        else if(strcmp(tag,"-v") == 0 || strcmp(tag,"-t") == 0)
+        {
+            if(!parse_grid(value,(tag[1] == 'v') ? params.vertices_grid : params.tetrahedra_grid))
+            {
+                cerr<<"[ERROR] the thresholds must be greater than 0"<<endl;
+                return -1;
+            }
+        }
+        else if(strcmp(tag,"-b") == 0)
+        {
+            params.build_type = value;
+            if(params.build_type != "seq" && params.build_type != "bulk" && params.build_type != "morton")
+            {
+                cerr<<"[ERROR] the construction type must be seq, bulk or morton"<<endl;
+                return -1;
+            }
+        }
+        else if(strcmp(tag,"-p") == 0)
+            params.threads_num = max(1,atoi(value));
+        else if(strcmp(tag,"-n") == 0)
+            params.queries_num = max(0,atoi(value));
+        else if(strcmp(tag,"-x") == 0)
+        {
+            params.ratio = atof(value);
+            if(!(params.ratio > 0))
+            {
+                cerr<<"[ERROR] the ratio must be greater than 0"<<endl;
+                return -1;
+            }
+        }
+        else if(strcmp(tag,"-w") == 0)
+            params.warmup = max(0,atoi(value));
+        else if(strcmp(tag,"-r") == 0)
+            params.repetitions = max(1,atoi(value));
+        else if(strcmp(tag,"-s") == 0)
+            params.seed = strtoul(value,NULL,10);
+        else if(strcmp(tag,"-o") == 0)
+            params.report_path = value;
+        else
+        {
+            cerr<<"[ERROR] unknown option "<<tag<<endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void generate_queries(Box &dom, Sweep_Parameters &params, Sweep_Queries &queries)
+{
+    mt19937 gen(params.seed);
+    uniform_real_distribution<double> x_dist(dom.get_min().get_x(), dom.get_max().get_x());
+    uniform_real_distribution<double> y_dist(dom.get_min().get_y(), dom.get_max().get_y());
+    uniform_real_distribution<double> z_dist(dom.get_min().get_z(), dom.get_max().get_z());
+    normal_distribution<double> versor_dist(0.0,1.0);
+
+    Point diagonal = dom.get_max() - dom.get_min();
+    double side = params.ratio * max(diagonal.get_x(),max(diagonal.get_y(),diagonal.get_z()));
+
+    for(int i=0; i<params.queries_num; i++)
+        queries.points.push_back(Point(x_dist(gen), y_dist(gen), z_dist(gen)));
+    for(int i=0; i<params.queries_num; i++)
+    {
+        Point min(x_dist(gen), y_dist(gen), z_dist(gen));
+        Point max(min.get_x()+side, min.get_y()+side, min.get_z()+side);
+        queries.boxes.push_back(Box(min,max));
+    }
+    // the lines are segments of the given length with a random direction, entirely contained in the domain
+    while((int)queries.lines.size() < params.queries_num)
+    {
+        Point min(x_dist(gen), y_dist(gen), z_dist(gen));
+        Point versor(versor_dist(gen), versor_dist(gen), versor_dist(gen));
+        double norm = versor.norm_3D();
+        if(norm == 0)
+            continue;
+        Point max(min.get_x()+versor.get_x()/norm*side, min.get_y()+versor.get_y()/norm*side, min.get_z()+versor.get_z()/norm*side);
+        if(!dom.contains_with_all_closed_faces(max))
+            continue;
+        queries.lines.push_back(Box(min,max));
+    }
+}
+
+///executes the queries of a type, once without measuring them for each warmup, and once for each repetition
+template<class T> void measure_queries(T& tree, Query_Type type, Sweep_Queries &queries, Sweep_Parameters &params, Sweep_Result &result)
+{
+    Spatial_Queries sq;
+    Topological_Queries tq;
+    Mesh &mesh = tree.get_mesh();
+    QueryStatistics qS(mesh.get_num_tetrahedra(),(type == LINE_QUERY) ? 8 : 4);
+    VT_Result vt;
+    TT_Result tt;
+    Visited_Set checkTetra(mesh.get_num_tetrahedra()+1);
+
+    int queries_num = (type == POINT_QUERY) ? queries.points.size() : queries.boxes.size();
+    vector<double> pass_times;
+    for(int rep=0; rep<params.warmup+params.repetitions; rep++)
+    {
+        bool measured = (rep >= params.warmup);
+        uint64_t pass_start = Latency_Histogram::get_time_ns();
+        for(int i=0; i<queries_num; i++)
+        {
+            uint64_t start = Latency_Histogram::get_time_ns();
+            uint64_t nodes = 0, tests = 0;
+            switch(type)
+            {
+            case POINT_QUERY:
+                sq.locate_point(tree,queries.points[i]);
+                break;
+            case BOX_QUERY:
+                sq.box_query(tree,queries.boxes[i],qS);
+                break;
+            case LINE_QUERY:
+                sq.line_query(tree,queries.lines[i],qS);
+                break;
+            case WVT_QUERY:
+                tq.windowed_VT_query(tree.get_root(),mesh.get_domain(),mesh,tree.get_decomposition(),queries.boxes[i],true,vt);
+                nodes = tq.get_visited_nodes_num();
+                tests = tq.get_geometric_tests_num();
+                break;
+            case WTT_QUERY:
+                tq.windowed_TT_query(tree.get_root(),mesh.get_domain(),mesh,tree.get_decomposition(),queries.boxes[i],tt,checkTetra);
+                nodes = tq.get_visited_nodes_num();
+                tests = tq.get_geometric_tests_num();
+                break;
+            default:
+                break;
+            }
+            if(measured)
+                result.latency[type].record(Latency_Histogram::get_time_ns() - start,nodes,tests);
+        }
+        if(measured)
+            pass_times.push_back((Latency_Histogram::get_time_ns() - pass_start) * 1e-9);
+    }
+    result.pass_time[type] = get_median(pass_times);
+}
+
+///builds and reindexes a tree for each warmup and repetition, and measures the size of the last one and its queries
+template<class T, class D> void run_configuration(const function<T*()> &make_tree, Mesh &mesh, Sweep_Queries &queries, Sweep_Parameters &params, Sweep_Result &result)
+{
+    unique_ptr<T> tree;
+    vector<double> build_times, reindex_times;
+    for(int rep=0; rep<params.warmup+params.repetitions; rep++)
+    {
+        // the reindexing permutes the mesh, thus each tree is built on a fresh copy
+        tree.reset(make_tree());
+        tree->get_mesh() = mesh;
+
+        uint64_t start = Latency_Histogram::get_time_ns();
+        if(params.build_type == "bulk")
+            tree->build_tree_bulk(params.threads_num);
+        else if(params.build_type == "morton")
+            build_tree_morton(*tree,params.threads_num);
+        else
+            tree->build_tree();
+        uint64_t built = Latency_Histogram::get_time_ns();
+        Reindexer reindexer = Reindexer();
+        reindexer.reindex_tree_and_mesh(*tree);
+        uint64_t reindexed = Latency_Histogram::get_time_ns();
+
+        if(rep >= params.warmup)
+        {
+            build_times.push_back((built - start) * 1e-9);
+            reindex_times.push_back((reindexed - built) * 1e-9);
+        }
+    }
+    result.build_time = get_median(build_times);
+    result.reindex_time = get_median(reindex_times);
+
+    // the root is not allocated in the arena
+    result.nodes_num = tree->get_nodes().get_nodes_num() + 1;
+    result.arena_bytes = tree->get_nodes().get_reserved_bytes();
+    {
+        Frozen_Tree<D> frozen(*tree);
+        result.frozen_bytes = frozen.get_layout().get_bytes();
+    }
+
+    //the face ordering is needed only by the line in tetra test
+    Geometry_Wrapper::set_faces_ordering(tree->get_mesh());
+    for(int q=0; q<QUERY_TYPES_NUM; q++)
+        measure_queries(*tree,(Query_Type)q,queries,params,result);
+}
+
+template<class D> void run_division(string division, Mesh &mesh, Sweep_Queries &queries, Sweep_Parameters &params, vector<Sweep_Result> &results)
+{
+    for(unsigned c=0; c<params.criteria.size(); c++)
+    {
+        string crit = params.criteria[c];
+        // only the thresholds used by the criterion are swept
+        vector<int> v_grid = (crit == "pr" || crit == "pm") ? params.vertices_grid : vector<int>(1,-1);
+        vector<int> t_grid = (crit != "pr") ? params.tetrahedra_grid : vector<int>(1,-1);
+
+        for(unsigned i=0; i<v_grid.size(); i++)
+        {
+            for(unsigned j=0; j<t_grid.size(); j++)
+            {
+                int v = v_grid[i], t = t_grid[j];
+                Sweep_Result result;
+                result.division = division;
+                result.criterion = crit;
+                result.vertices_per_leaf = v;
+                result.tetrahedra_per_leaf = t;
+
+                if(crit == "pr")
+                    run_configuration<P_Tree<D>,D>([v]() { return new P_Tree<D>(v); },mesh,queries,params,result);
+                else if(crit == "pm")
+                    run_configuration<PT_Tree<D>,D>([v,t]() { return new PT_Tree<D>(v,t); },mesh,queries,params,result);
+                else if(crit == "pm2")
+                    run_configuration<T_Tree<D>,D>([t]() { return new T_Tree<D>(t); },mesh,queries,params,result);
+                else
+                    run_configuration<RT_Tree<D>,D>([t]() { return new RT_Tree<D>(t); },mesh,queries,params,result);
+
+                cout<<division<<" "<<crit<<" v "<<v<<" t "<<t<<": build "<<result.build_time<<" sec, reindex "<<result.reindex_time
+                    <<" sec, nodes "<<result.nodes_num<<", frozen "<<result.frozen_bytes<<" bytes";
+                for(int q=0; q<QUERY_TYPES_NUM; q++)
+                    cout<<", "<<QUERY_NAMES[q]<<" "<<result.pass_time[q]<<" sec";
+                cout<<endl;
+                results.push_back(result);
+            }
+        }
+    }
+}
+
+static bool write_report(string mesh_path, Mesh &mesh, Sweep_Parameters &params, vector<Sweep_Result> &results)
+{
+    static const double PERCENTILES[] = { 50, 90, 99 };
+    static const int PERCENTILES_NUM = sizeof(PERCENTILES)/sizeof(double);
+
+    ofstream csv((params.report_path+".csv").c_str());
+    if(csv.is_open())
+    {
+        csv<<"division,criterion,vertices_per_leaf,tetrahedra_per_leaf,build_s,reindex_s,nodes,arena_bytes,frozen_bytes";
+        for(int q=0; q<QUERY_TYPES_NUM; q++)
+            csv<<","<<QUERY_NAMES[q]<<"_pass_s,"<<QUERY_NAMES[q]<<"_mean_ns,"<<QUERY_NAMES[q]<<"_p50_ns,"<<QUERY_NAMES[q]<<"_p90_ns,"<<QUERY_NAMES[q]<<"_p99_ns";
+        csv<<endl;
+        for(unsigned r=0; r<results.size(); r++)
+        {
+            Sweep_Result &res = results[r];
+            csv<<res.division<<","<<res.criterion<<","<<res.vertices_per_leaf<<","<<res.tetrahedra_per_leaf<<","
+               <<res.build_time<<","<<res.reindex_time<<","<<res.nodes_num<<","<<res.arena_bytes<<","<<res.frozen_bytes;
+            for(int q=0; q<QUERY_TYPES_NUM; q++)
+            {
+                csv<<","<<res.pass_time[q]<<","<<res.latency[q].get_mean();
+                for(int p=0; p<PERCENTILES_NUM; p++)
+                    csv<<","<<res.latency[q].get_percentile(PERCENTILES[p]);
+            }
+            csv<<endl;
+        }
+        csv.close();
+    }
+    else
+        return false;
+
+    ofstream json((params.report_path+".json").c_str());
+    if(!json.is_open())
+        return false;
+    json<<"{"<<endl;
+    json<<"  \"mesh\": \""<<mesh_path<<"\", \"vertices\": "<<mesh.get_num_vertices()<<", \"tetrahedra\": "<<mesh.get_num_tetrahedra()<<","<<endl;
+    json<<"  \"build\": \""<<params.build_type<<"\", \"threads\": "<<params.threads_num<<", \"queries\": "<<params.queries_num
+        <<", \"ratio\": "<<params.ratio<<", \"warmup\": "<<params.warmup<<", \"repetitions\": "<<params.repetitions<<", \"seed\": "<<params.seed<<","<<endl;
+    json<<"  \"configurations\": ["<<endl;
+    for(unsigned r=0; r<results.size(); r++)
+    {
+        Sweep_Result &res = results[r];
+        json<<"    { \"division\": \""<<res.division<<"\", \"criterion\": \""<<res.criterion<<"\", \"vertices_per_leaf\": "<<res.vertices_per_leaf
+            <<", \"tetrahedra_per_leaf\": "<<res.tetrahedra_per_leaf<<","<<endl;
+        json<<"      \"build_s\": "<<res.build_time<<", \"reindex_s\": "<<res.reindex_time<<", \"nodes\": "<<res.nodes_num
+            <<", \"arena_bytes\": "<<res.arena_bytes<<", \"frozen_bytes\": "<<res.frozen_bytes<<","<<endl;
+        json<<"      \"queries\": {";
+        for(int q=0; q<QUERY_TYPES_NUM; q++)
+        {
+            json<<(q > 0 ? "," : "")<<endl<<"        \""<<QUERY_NAMES[q]<<"\": { \"pass_s\": "<<res.pass_time[q]<<", \"mean_ns\": "<<res.latency[q].get_mean();
+            for(int p=0; p<PERCENTILES_NUM; p++)
+                json<<", \"p"<<PERCENTILES[p]<<"_ns\": "<<res.latency[q].get_percentile(PERCENTILES[p]);
+            json<<" }";
+        }
+        json<<endl<<"      }"<<endl;
+        json<<"    }"<<(r+1 < results.size() ? "," : "")<<endl;
+    }
+    json<<"  ]"<<endl<<"}"<<endl;
+    json.close();
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        cerr<<"usage: "<<argv[0]<<" mesh.ts [-d divisions] [-c criteria] [-v vertices_grid] [-t tetrahedra_grid] [-b build] [-p threads]"<<endl
+            <<"       [-n queries] [-x ratio] [-w warmup] [-r repetitions] [-s seed] [-o report]"<<endl;
+        return EXIT_FAILURE;
+    }
+    Sweep_Parameters params;
+    if(read_parameters(argc,argv,params) == -1)
+        return EXIT_FAILURE;
+
+    Mesh mesh;
+    if(!Reader::read_mesh(mesh, argv[1], params.threads_num))
+    {
+        cerr<<"[ERROR] cannot read the mesh "<<argv[1]<<endl;
+        return EXIT_FAILURE;
+    }
+    Sweep_Queries queries;
+    generate_queries(mesh.get_domain(),params,queries);
+
+    vector<Sweep_Result> results;
+    for(unsigned d=0; d<params.divisions.size(); d++)
+    {
+        if(params.divisions[d] == "ok")
+            run_division<OK_Subdivision>("ok",mesh,queries,params,results);
+        else
+            run_division<KD_Subdivision>("kd",mesh,queries,params,results);
+    }
+
+    if(!write_report(argv[1],mesh,params,results))
+    {
+        cerr<<"[ERROR] cannot write the report "<<params.report_path<<endl;
+        return EXIT_FAILURE;
+    }
+    cout<<"report written in "<<params.report_path<<".csv and "<<params.report_path<<".json"<<endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Benchmark sweeping the tree families, subdivisions and thresholds on a mesh
+# (build, reindexing, size and queries, written in a CSV/JSON report)
+#
+#-------------------------------------------------
+
+include(../tetrahedral_trees.pri)
+
+TEMPLATE = app
+TARGET = sweep_benchmark
+
+# Directories
+DESTDIR = ../dist/
+OBJECTS_DIR = ../build/sweep_benchmark/
+
+# the library sources are not compiled again, but linked from the library (built by the main project)
+LIBS += -L$$OUT_PWD/../dist -ltetrahedral_trees
+# the shared library is searched next to the executable
+QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+
+SOURCES += \
+    sweep_benchmark.cpp
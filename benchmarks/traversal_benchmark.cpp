@@ -0,0 +1,100 @@
+/*
+ * A benchmark of the interleaved point location (Interleaved_Point_Locator) against the recursive one (Spatial_Queries::locate_point).
+ * A T_Tree is built (and reindexed) on the mesh, and a set of random points in the mesh domain is located on the tree and on its frozen copy,
+ * first with the recursive visit, then keeping an increasing number of point locations in flight.
+ * All the executions must return the same tetrahedra.
+ * The gain of the interleaved visit grows with the size of the index, as it hides the latency of the cache misses.
+ *
+ * usage: traversal_benchmark mesh.ts [points_num] [tetrahedra_per_leaf]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "tetrahedral_trees/t_tree.h"
+#include "tetrahedral_trees/kd_subdivision.h"
+#include "tetrahedral_trees/frozen_tree.h"
+#include "tetrahedral_trees/reindexer.h"
+#include "queries/spatial_queries.h"
+#include "queries/interleaved_point_locator.h"
+#include "io/reader.h"
+#include "utilities/timer.h"
+
+using namespace std;
+
+///the group sizes tested by the benchmark
+static const int GROUP_SIZES[] = { 1, 2, 4, 8, 16, 32 };
+
+template<class T> bool run_benchmark(T& tree, vector<Point> &points)
+{
+    Spatial_Queries sq;
+    Timer time;
+
+    vector<int> expected(points.size());
+    time.start();
+    for(unsigned i=0; i<points.size(); i++)
+        expected[i] = sq.locate_point(tree,points[i]);
+    time.stop();
+    double base_time = time.get_elapsed_time();
+    int hits = 0;
+    for(unsigned i=0; i<expected.size(); i++)
+        hits += (expected[i] > 0);
+    cout<<"  recursive        : "<<base_time<<" sec  (located points "<<hits<<")"<<endl;
+
+    bool same = true;
+    vector<int> results;
+    for(unsigned g=0; g<sizeof(GROUP_SIZES)/sizeof(int); g++)
+    {
+        Interleaved_Point_Locator locator(GROUP_SIZES[g]);
+        time.start();
+        locator.locate_points(tree,points,results);
+        time.stop();
+        cout<<"  interleaved ("<<GROUP_SIZES[g]<<(GROUP_SIZES[g] < 10 ? ") " : ")")<<" : "<<time.get_elapsed_time()<<" sec  speedup "<<base_time/time.get_elapsed_time()<<"x"<<endl;
+        same = same && (results == expected);
+    }
+    return same;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        cerr<<"usage: "<<argv[0]<<" mesh.ts [points_num] [tetrahedra_per_leaf]"<<endl;
+        return EXIT_FAILURE;
+    }
+    int points_num = (argc > 2) ? atoi(argv[2]) : 1000000;
+    int tetrahedra_per_leaf = (argc > 3) ? atoi(argv[3]) : 60;
+
+    T_Tree<KD_Subdivision> tree(tetrahedra_per_leaf);
+    if(!Reader::read_mesh(tree.get_mesh(), argv[1], 1))
+    {
+        cerr<<"[ERROR] cannot read the mesh "<<argv[1]<<endl;
+        return EXIT_FAILURE;
+    }
+    tree.build_tree();
+    Reindexer reindexer = Reindexer();
+    reindexer.reindex_tree_and_mesh(tree);
+
+    // uniformly distributed points, thus consecutive locations visit unrelated paths of the tree
+    mt19937 gen(42);
+    Box &dom = tree.get_mesh().get_domain();
+    uniform_real_distribution<double> x_dist(dom.get_min().get_x(), dom.get_max().get_x());
+    uniform_real_distribution<double> y_dist(dom.get_min().get_y(), dom.get_max().get_y());
+    uniform_real_distribution<double> z_dist(dom.get_min().get_z(), dom.get_max().get_z());
+    vector<Point> points(points_num);
+    for(int i=0; i<points_num; i++)
+        points[i] = Point(x_dist(gen), y_dist(gen), z_dist(gen));
+
+    cout<<"tree ("<<points_num<<" points)"<<endl;
+    bool same = run_benchmark(tree,points);
+    Frozen_Tree<KD_Subdivision> frozen(tree);
+    cout<<"frozen tree ("<<points_num<<" points)"<<endl;
+    same = run_benchmark(frozen,points) && same;
+
+    if(!same)
+    {
+        cerr<<"[ERROR] the interleaved point locations returned different results"<<endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Benchmark of the point locations
+# (recursive visit vs. interleaved visit with software prefetching)
+#
+#-------------------------------------------------
+
+include(../tetrahedral_trees.pri)
+
+TEMPLATE = app
+TARGET = traversal_benchmark
+
+# Directories
+DESTDIR = ../dist/
+OBJECTS_DIR = ../build/traversal_benchmark/
+
+# the library sources are not compiled again, but linked from the library (built by the main project)
+LIBS += -L$$OUT_PWD/../dist -ltetrahedral_trees
+# the shared library is searched next to the executable
+QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+
+SOURCES += \
+    traversal_benchmark.cpp
@@ -0,0 +1,218 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * A client of the query server (tetrahedral_trees -u socket).
+ * The queries are read from a file, with the same syntax of the -q option, and sent to the server one at a time.
+ * The results are printed on the standard output as done by tetrahedral_trees -q, while the latencies of the requests
+ * (measured by the server, and as round trips by the client) are summarized on the standard error.
+ * With -a, the identifiers of the tetrahedra or of the vertices found are also printed.
+ *
+ * usage: query_client [-a] socket op-file
+ *        query_client socket shutdown
+ * op can be: point - box - line - wvt - wtt - ltt - wdist
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include "server/protocol.h"
+#include "server/channel.h"
+#include "io/reader.h"
+
+using namespace std;
+
+///the latencies of a series of requests, in nanoseconds
+struct Latencies
+{
+    vector<uint64_t> server;
+    vector<uint64_t> round_trip;
+};
+
+static bool send_request(Channel &channel, uint32_t type, uint32_t id, const double *coords, int coords_num)
+{
+    protocol::Request_Header request;
+    request.magic = protocol::MAGIC;
+    request.type = type;
+    request.id = id;
+    request.payload_bytes = coords_num * sizeof(double);
+    return channel.write_fully(&request,sizeof(request)) && channel.write_fully(coords,request.payload_bytes);
+}
+
+static bool receive_response(Channel &channel, protocol::Response_Header &response, vector<char> &payload)
+{
+    if(!channel.read_fully(&response,sizeof(response)) || response.magic != protocol::MAGIC)
+        return false;
+    payload.resize(response.payload_bytes);
+    return channel.read_fully(payload.data(),payload.size());
+}
+
+static void print_percentiles(string name, vector<uint64_t> &values)
+{
+    if(values.empty())
+        return;
+    sort(values.begin(),values.end());
+    double sum = 0;
+    for(unsigned i=0; i<values.size(); i++)
+        sum += values[i];
+    double percentiles[] = { 0.5, 0.9, 0.99 };
+    cerr<<"[LATENCY] "<<name<<" (usec): mean "<<sum/values.size()*1e-3;
+    for(int p=0; p<3; p++)
+        cerr<<" p"<<percentiles[p]*100<<" "<<values[(size_t)(percentiles[p]*(values.size()-1))]*1e-3;
+    cerr<<" max "<<values.back()*1e-3<<endl;
+}
+
+// prints a result as tetrahedral_trees -q, and, if required, the elements found
+static void print_result(uint32_t type, unsigned j, Box &b, protocol::Response_Header &response, vector<char> &payload, bool all)
+{
+    const int *ids = reinterpret_cast<const int*>(payload.data());
+    if(type == protocol::POINT)
+    {
+        if(response.count > 0)
+            cout<<"found tetra for point "<<j<<endl;
+        else
+            cout<<"nothing found for point "<<j<<endl;
+    }
+    else if(type == protocol::BOX)
+        cout<<response.count<<" intersect box "<<j<<endl;
+    else if(type == protocol::LINE)
+        cout<<response.count<<" intersect line "<<j<<" "<<b<<endl;
+    else if(type == protocol::WINDOWED_VT || type == protocol::WINDOWED_DISTORTION)
+        cout<<"for box "<<j<<" vertices found: "<<response.count<<endl;
+    else
+        cout<<"for box "<<j<<" tetrahedra found: "<<response.count<<endl;
+
+    if(all && response.count > 0)
+    {
+        // the distortion values precede the vertices
+        if(type == protocol::WINDOWED_DISTORTION)
+            ids = reinterpret_cast<const int*>(payload.data() + response.count*sizeof(double));
+        for(uint64_t i=0; i<response.count; i++)
+            cout<<ids[i]<<" ";
+        cout<<endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool all = (argc > 1 && strcmp(argv[1],"-a") == 0);
+    if(argc - all < 3)
+    {
+        cerr<<"usage: "<<argv[0]<<" [-a] socket op-file"<<endl;
+        cerr<<"       "<<argv[0]<<" socket shutdown"<<endl;
+        return EXIT_FAILURE;
+    }
+    string socket_path = argv[1+all];
+    string op = argv[2+all];
+
+    int fd = Channel::connect_to(socket_path);
+    if(fd < 0)
+    {
+        cerr<<"[ERROR] cannot connect to "<<socket_path<<endl;
+        return EXIT_FAILURE;
+    }
+    Channel channel(fd,fd,true);
+    protocol::Response_Header response;
+    vector<char> payload;
+
+    if(op == "shutdown")
+    {
+        if(!send_request(channel,protocol::SHUTDOWN,0,NULL,0) || !receive_response(channel,response,payload))
+        {
+            cerr<<"[ERROR] the server did not answer"<<endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    size_t sep = op.find('-');
+    if(sep == string::npos)
+    {
+        cerr<<"[ERROR] the query must be in the form op-file"<<endl;
+        return EXIT_FAILURE;
+    }
+    string name = op.substr(0,sep), query_path = op.substr(sep+1);
+    uint32_t type;
+    if(name == "point")
+        type = protocol::POINT;
+    else if(name == "box")
+        type = protocol::BOX;
+    else if(name == "line")
+        type = protocol::LINE;
+    else if(name == "wvt")
+        type = protocol::WINDOWED_VT;
+    else if(name == "wtt")
+        type = protocol::WINDOWED_TT;
+    else if(name == "ltt")
+        type = protocol::LINEARIZED_TT;
+    else if(name == "wdist")
+        type = protocol::WINDOWED_DISTORTION;
+    else
+    {
+        cerr<<"[ERROR] unknown query "<<name<<endl;
+        return EXIT_FAILURE;
+    }
+
+    vector<Point> points;
+    vector<Box> boxes;
+    if(type == protocol::POINT)
+    {
+        Reader::read_queries(points,query_path);
+        for(unsigned i=0; i<points.size(); i++)
+            boxes.push_back(Box(points[i],points[i]));
+    }
+    else
+        Reader::read_queries(boxes,query_path);
+
+    Latencies latencies;
+    for(unsigned j=0; j<boxes.size(); j++)
+    {
+        Point &min = boxes[j].get_min(), &max = boxes[j].get_max();
+        double coords[6] = { min.get_x(), min.get_y(), min.get_z(), max.get_x(), max.get_y(), max.get_z() };
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if(!send_request(channel,type,j,coords,(type == protocol::POINT) ? 3 : 6) || !receive_response(channel,response,payload))
+        {
+            cerr<<"[ERROR] the server closed the connection"<<endl;
+            return EXIT_FAILURE;
+        }
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+        if(response.status != protocol::OK)
+        {
+            cerr<<"[ERROR] query "<<j<<" failed with status "<<response.status<<endl;
+            continue;
+        }
+        latencies.server.push_back(response.latency_ns);
+        latencies.round_trip.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        print_result(type,j,boxes[j],response,payload,all);
+    }
+
+    cerr<<"[LATENCY] "<<latencies.server.size()<<" queries answered"<<endl;
+    print_percentiles("server",latencies.server);
+    print_percentiles("round trip",latencies.round_trip);
+    return EXIT_SUCCESS;
+}
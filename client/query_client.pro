@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Client of the query server (tetrahedral_trees -u socket)
+#
+#-------------------------------------------------
+
+include(../tetrahedral_trees.pri)
+
+TEMPLATE = app
+TARGET = query_client
+
+# Directories
+DESTDIR = ../dist/
+OBJECTS_DIR = ../build/query_client/
+
+# the library sources are not compiled again, but linked from the library (built by the main project)
+LIBS += -L$$OUT_PWD/../dist -ltetrahedral_trees
+# the shared library is searched next to the executable
+QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+
+SOURCES += \
+    query_client.cpp
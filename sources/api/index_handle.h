@@ -0,0 +1,241 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INDEX_HANDLE_H
+#define INDEX_HANDLE_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "queries/query_context.h"
+#include "queries/border_checker.h"
+#include "geometry/geometry_wrapper.h"
+#include "tetrahedral_trees/frozen_tree.h"
+#include "io/writer.h"
+
+using namespace std;
+
+/**
+ * @brief A class representing an index opened through the C interface of the library: a tree, of any kind, and its mesh.
+ * The mesh is prepared once, when the index is opened: the faces of the tetrahedra are oriented for the line tests,
+ * and the border faces are computed for the windowed distortion.
+ * The queries only read the tree and the mesh, thus they can be executed concurrently: each query takes a Query_Context
+ * from a pool, which grows up to the number of threads querying the index at the same time.
+ */
+class Index_Handle
+{
+public:
+    /**
+     * @brief A constructor method
+     * @param info a snapshot::Info& argument, containing the parameters of the index
+     * @param threads_num an integer representing the number of threads used by the batched procedures
+     */
+    Index_Handle(snapshot::Info &info, int threads_num) : info(info) { this->threads_num = threads_num; }
+    ///A destructor method
+    virtual ~Index_Handle() {}
+
+    ///A public method that returns the mesh of the index
+    virtual Mesh& get_mesh() = 0;
+    ///A public method that locates a point, returning the tetrahedron containing it (0 if none)
+    virtual int locate_point(Query_Context &context, Point &p) = 0;
+    ///A public method that locates a set of points with a single visit of the tree
+    virtual void locate_points(Query_Context &context, vector<Point> &points, vector<int> &results) = 0;
+    ///A public method that finds the tetrahedra intersecting a box (in context.qS)
+    virtual void box_query(Query_Context &context, Box &b) = 0;
+    ///A public method that finds the tetrahedra intersecting a segment, represented by the box b (in context.qS)
+    virtual void line_query(Query_Context &context, Box &b) = 0;
+    ///A public method that extracts the VT relations of the vertices in a box (in context.vt)
+    virtual void windowed_VT(Query_Context &context, Box &b) = 0;
+    ///A public method that extracts the TT relations of the tetrahedra intersecting a box (in context.tt)
+    virtual void windowed_TT(Query_Context &context, Box &b) = 0;
+    ///A public method that extracts the TT relations of the tetrahedra intersecting a segment, represented by the box b (in context.tt)
+    virtual void linearized_TT(Query_Context &context, Box &b) = 0;
+    ///A public method that computes the distortion of the vertices in a box (in context.dist)
+    virtual void windowed_Distortion(Query_Context &context, Box &b) = 0;
+    ///A public method that extracts the VT relation of the whole mesh
+    virtual void extract_VT(Query_Context &context, VT_Relation &vt) = 0;
+    ///A public method that extracts the TT relation of the whole mesh
+    virtual void extract_TT(Query_Context &context, TT_Relation &tt) = 0;
+    /**
+     * @brief A public method that writes the snapshot of the index (in its frozen form) and of its mesh
+     * @param path a string containing the path of the snapshot file
+     * @return true if the snapshot has been written, false otherwise
+     */
+    virtual bool write_snapshot(string path) = 0;
+
+    ///A public method that returns true if the windowed distortion can be computed on the index
+    inline bool is_distortion_supported() const { return !this->frozen || this->info.reindexed; }
+    ///A public method that returns the parameters of the index
+    inline snapshot::Info& get_info() { return this->info; }
+
+    ///A public method that takes a query context from the pool (creating it if the pool is empty)
+    inline unique_ptr<Query_Context> acquire_context()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->contexts_mutex);
+            if(!this->contexts.empty())
+            {
+                unique_ptr<Query_Context> context = std::move(this->contexts.back());
+                this->contexts.pop_back();
+                return context;
+            }
+        }
+        return unique_ptr<Query_Context>(new Query_Context(this->get_mesh().get_num_tetrahedra()));
+    }
+    ///A public method that returns a query context to the pool
+    inline void release_context(unique_ptr<Query_Context> context)
+    {
+        std::lock_guard<std::mutex> lock(this->contexts_mutex);
+        this->contexts.push_back(std::move(context));
+    }
+
+protected:
+    snapshot::Info info;
+    int threads_num;
+    ///true if the tree is a Frozen_Tree
+    bool frozen;
+
+private:
+    std::mutex contexts_mutex;
+    vector<unique_ptr<Query_Context> > contexts;
+};
+
+/**
+ * @brief A class representing an index on a tree of type T (a Tree or a Frozen_Tree)
+ * A frozen tree references the mesh of another object (the tree it has been frozen from, or the mesh of a snapshot),
+ * which is kept alive by the index.
+ */
+template<class T> class Tree_Index : public Index_Handle
+{
+public:
+    /**
+     * @brief A constructor method, that prepares the mesh of the tree
+     * @param tree a unique_ptr<T> argument, containing the tree (whose ownership is taken)
+     * @param owner a shared_ptr<void> argument, containing the object owning the mesh of the tree (empty if the tree owns its mesh)
+     * @param info a snapshot::Info& argument, containing the parameters of the index
+     * @param frozen a boolean, true if T is a Frozen_Tree
+     * @param threads_num an integer representing the number of threads used by the batched procedures
+     */
+    Tree_Index(unique_ptr<T> tree, shared_ptr<void> owner, snapshot::Info &info, bool frozen, int threads_num);
+    /**
+     * @brief A constructor method, that prepares the mesh of a tree owned by the caller, which must outlive the index
+     * @param tree a T& argument, representing the tree
+     * @param info a snapshot::Info& argument, containing the parameters of the index
+     * @param frozen a boolean, true if T is a Frozen_Tree
+     * @param threads_num an integer representing the number of threads used by the batched procedures
+     */
+    Tree_Index(T &tree, snapshot::Info &info, bool frozen, int threads_num);
+
+    inline Mesh& get_mesh() { return this->tree->get_mesh(); }
+    inline int locate_point(Query_Context &context, Point &p) { return context.sq.locate_point(*this->tree,p); }
+    inline void locate_points(Query_Context &context, vector<Point> &points, vector<int> &results)
+    {
+        context.sq.locate_points(*this->tree,points,results,this->threads_num);
+    }
+    inline void box_query(Query_Context &context, Box &b) { context.sq.box_query(*this->tree,b,context.qS); }
+    inline void line_query(Query_Context &context, Box &b) { context.sq.line_query(*this->tree,b,context.qS); }
+    inline void windowed_VT(Query_Context &context, Box &b)
+    {
+        context.tq.windowed_VT_query(this->tree->get_root(),this->get_mesh().get_domain(),this->get_mesh(),this->tree->get_decomposition(),
+                                     b,this->info.reindexed,context.vt);
+    }
+    inline void windowed_TT(Query_Context &context, Box &b)
+    {
+        context.tq.windowed_TT_query(this->tree->get_root(),this->get_mesh().get_domain(),this->get_mesh(),this->tree->get_decomposition(),
+                                     b,context.tt,context.checkTetra);
+    }
+    inline void linearized_TT(Query_Context &context, Box &b)
+    {
+        context.tq.linearized_TT_query(this->tree->get_root(),this->get_mesh().get_domain(),this->get_mesh(),this->tree->get_decomposition(),
+                                       b,context.tt,context.checkTetra);
+    }
+    inline void windowed_Distortion(Query_Context &context, Box &b)
+    {
+        context.tq.windowed_Distortion_query(this->tree->get_root(),this->get_mesh().get_domain(),this->get_mesh(),this->tree->get_decomposition(),
+                                             b,this->info.reindexed,context.dist);
+    }
+    inline void extract_VT(Query_Context &context, VT_Relation &vt)
+    {
+        context.tq.extract_VT(this->tree->get_root(),this->get_mesh().get_domain(),this->get_mesh(),this->tree->get_decomposition(),
+                              this->info.reindexed,vt,this->threads_num);
+    }
+    inline void extract_TT(Query_Context &context, TT_Relation &tt)
+    {
+        context.tq.extract_TT(this->tree->get_root(),this->get_mesh().get_domain(),this->get_mesh(),this->tree->get_decomposition(),
+                              this->info.reindexed,tt,this->threads_num);
+    }
+    inline bool write_snapshot(string path) { return write_index_snapshot(*this->tree,path,this->info); }
+
+private:
+    // the owner of the mesh is declared before the tree, thus it is destroyed after it
+    shared_ptr<void> owner;
+    ///the tree owned by the index (empty if the tree is owned by the caller)
+    unique_ptr<T> tree_owner;
+    T *tree;
+
+    ///A private method that prepares the mesh of the tree for the queries
+    void prepare_mesh();
+
+    ///A private method that writes the snapshot of a tree, by freezing it temporarily
+    template<class N, class D> static bool write_index_snapshot(Tree<N,D> &tree, string path, snapshot::Info &info)
+    {
+        Frozen_Tree<D> frozen(tree);
+        return Writer::write_snapshot(path,tree.get_mesh(),frozen.get_layout(),info);
+    }
+    ///A private method that writes the snapshot of a frozen tree
+    template<class D> static bool write_index_snapshot(Frozen_Tree<D> &tree, string path, snapshot::Info &info)
+    {
+        return Writer::write_snapshot(path,tree.get_mesh(),tree.get_layout(),info);
+    }
+};
+
+template<class T> Tree_Index<T>::Tree_Index(unique_ptr<T> tree, shared_ptr<void> owner, snapshot::Info &info, bool frozen, int threads_num)
+    : Index_Handle(info,threads_num), owner(owner), tree_owner(std::move(tree))
+{
+    this->tree = this->tree_owner.get();
+    this->frozen = frozen;
+    this->prepare_mesh();
+}
+
+template<class T> Tree_Index<T>::Tree_Index(T &tree, snapshot::Info &info, bool frozen, int threads_num)
+    : Index_Handle(info,threads_num)
+{
+    this->tree = &tree;
+    this->frozen = frozen;
+    this->prepare_mesh();
+}
+
+template<class T> void Tree_Index<T>::prepare_mesh()
+{
+    // the orientation of the faces rewrites the tetrahedra, thus it must precede the computation of the border faces
+    Geometry_Wrapper::set_faces_ordering(this->get_mesh());
+    if(this->is_distortion_supported())
+    {
+        Border_Checker checker = Border_Checker();
+        checker.calc_mesh_borders(this->tree->get_root(),this->get_mesh().get_domain(),0,this->get_mesh(),this->tree->get_decomposition());
+    }
+}
+
+#endif // INDEX_HANDLE_H
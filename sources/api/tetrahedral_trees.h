@@ -0,0 +1,239 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TETRAHEDRAL_TREES_H
+#define TETRAHEDRAL_TREES_H
+
+#include <stdint.h>
+
+/**
+ * The C interface of the Tetrahedral Trees library (libtetrahedral_trees).
+ *
+ * An index (a Tetrahedral tree and its mesh) is built from a mesh file, or loaded from a tree file or a snapshot, and then queried
+ * in-process: the results are written in buffers provided by the caller.
+ * When a buffer is too small, the query returns TT_ERROR_BUFFER and sets the sizes needed, thus the caller can grow the buffer
+ * and repeat the query. A buffer can be NULL only when nothing is written in it (e.g., to get the sizes needed with a zero capacity),
+ * otherwise the query returns TT_ERROR_ARGUMENT.
+ *
+ * As in the mesh files, the vertices and the tetrahedra are identified by their position indices, starting from 1.
+ * These refer to the mesh of the index, that can differ from the input one: with the reindex option the vertices and the tetrahedra
+ * are spatially sorted, and the vertices of each tetrahedron are reordered so that its faces are coherently oriented.
+ * The vertices and the tetrahedra of the index mesh are returned by tt_get_vertex and tt_get_tetrahedron.
+ *
+ * An index can be queried concurrently by several threads. The functions returning a tt_status never throw,
+ * and the description of the last error of the calling thread is returned by tt_last_error (cleared by each successful call).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///an index (opaque)
+typedef struct tt_index tt_index;
+
+///the outcome of a function
+typedef enum
+{
+    TT_OK = 0,
+    TT_ERROR_ARGUMENT = 1,      ///< an argument is not valid
+    TT_ERROR_IO = 2,            ///< a file cannot be read or written
+    TT_ERROR_BUFFER = 3,        ///< an output buffer is too small (the sizes needed are returned)
+    TT_ERROR_UNSUPPORTED = 4,   ///< the query cannot be executed on the index
+    TT_ERROR_INTERNAL = 5       ///< an unexpected error (e.g., out of memory)
+} tt_status;
+
+///the space subdivision of the index
+typedef enum { TT_OCTREE = 0, TT_KDTREE = 1 } tt_division;
+
+///the subdivision criterion of the index
+typedef enum
+{
+    TT_PR = 0,      ///< vertices threshold (P-Ttree)
+    TT_PM = 1,      ///< vertices and tetrahedra thresholds (PT-Ttree)
+    TT_PM2 = 2,     ///< tetrahedra threshold (T-Ttree)
+    TT_PMR = 3      ///< tetrahedra threshold, without splitting the leaves that cannot be separated (RT-Ttree)
+} tt_criterion;
+
+///the construction algorithm of the index (all produce the same index)
+typedef enum
+{
+    TT_BUILD_SEQUENTIAL = 0,    ///< incremental insertion of the entities
+    TT_BUILD_BULK = 1,          ///< parallel top-down construction
+    TT_BUILD_MORTON = 2         ///< construction on the vertices sorted by their locational codes (only for TT_PR, it also reindexes the vertices)
+} tt_build_type;
+
+///the parameters of an index
+typedef struct
+{
+    tt_division division;
+    tt_criterion criterion;
+    ///the vertices threshold per leaf (TT_PR and TT_PM)
+    int32_t vertices_per_leaf;
+    ///the tetrahedra threshold per leaf (TT_PM, TT_PM2 and TT_PMR)
+    int32_t tetrahedra_per_leaf;
+    tt_build_type build_type;
+    ///non-zero to spatially sort the mesh following the index
+    int32_t reindex;
+    ///non-zero to convert the index in the read-only linearized layout
+    int32_t freeze;
+    ///the number of threads used by the parallel procedures (mesh parsing, construction, batched queries)
+    int32_t threads_num;
+} tt_options;
+
+/**
+ * @brief Initializes the options with the default values
+ * (kD-tree, PR criterion with 20 vertices per leaf, sequential construction, no reindexing, no freezing, all the hardware threads)
+ */
+void tt_default_options(tt_options *options);
+
+/**
+ * @brief Builds an index on a mesh
+ * @param mesh_path the path of the mesh file (.ts)
+ * @param options the parameters of the index
+ * @param index set with the new index
+ */
+tt_status tt_build(const char *mesh_path, const tt_options *options, tt_index **index);
+/**
+ * @brief Loads an index from a tree file (as written by the tetrahedral_trees executable)
+ * The build_type option is ignored.
+ * @param mesh_path the path of the mesh file (.ts)
+ * @param tree_path the path of the tree file (.tree)
+ * @param options the parameters of the index, that must be the same used to build the tree
+ * @param index set with the new index
+ */
+tt_status tt_load_tree(const char *mesh_path, const char *tree_path, const tt_options *options, tt_index **index);
+/**
+ * @brief Loads a frozen index from a snapshot
+ * @param snapshot_path the path of the snapshot file
+ * @param threads_num the number of threads used by the batched queries
+ * @param index set with the new index
+ */
+tt_status tt_load_snapshot(const char *snapshot_path, int32_t threads_num, tt_index **index);
+/**
+ * @brief Writes the snapshot of an index (in its frozen form) and of its mesh
+ */
+tt_status tt_write_snapshot(tt_index *index, const char *snapshot_path);
+/**
+ * @brief Releases an index, with all its memory. The index must not be in use by other threads.
+ */
+void tt_free(tt_index *index);
+/**
+ * @brief Returns the description of the last error occurred in the calling thread (an empty string if the last call returning a tt_status succeeded)
+ */
+const char* tt_last_error(void);
+
+///returns the number of vertices of the index mesh
+int64_t tt_get_vertices_num(tt_index *index);
+///returns the number of tetrahedra of the index mesh
+int64_t tt_get_tetrahedra_num(tt_index *index);
+///sets the coordinates of a vertex of the index mesh
+tt_status tt_get_vertex(tt_index *index, int32_t vertex, double coords[3]);
+///sets the vertices of a tetrahedron of the index mesh
+tt_status tt_get_tetrahedron(tt_index *index, int32_t tetrahedron, int32_t vertices[4]);
+
+/**
+ * @brief Locates a point
+ * @param point the coordinates of the point
+ * @param tetrahedron set with the tetrahedron containing the point (0 if the point is outside the mesh)
+ */
+tt_status tt_locate_point(tt_index *index, const double point[3], int32_t *tetrahedron);
+/**
+ * @brief Locates a set of points with a single visit of the index
+ * @param points the coordinates of the points (three for each point)
+ * @param points_num the number of points
+ * @param tetrahedra set, for each point, with the tetrahedron containing it (0 if the point is outside the mesh)
+ */
+tt_status tt_locate_points(tt_index *index, const double *points, int64_t points_num, int32_t *tetrahedra);
+/**
+ * @brief Finds the tetrahedra intersecting a box
+ * @param min the minimum point of the box
+ * @param max the maximum point of the box
+ * @param tetrahedra set with the tetrahedra found
+ * @param capacity the number of entries of the tetrahedra buffer
+ * @param count set with the number of tetrahedra found
+ */
+tt_status tt_box_query(tt_index *index, const double min[3], const double max[3], int32_t *tetrahedra, int64_t capacity, int64_t *count);
+/**
+ * @brief Finds the tetrahedra intersecting a segment (sorted by index)
+ * @param p1 the first endpoint of the segment
+ * @param p2 the second endpoint of the segment
+ * @param tetrahedra set with the tetrahedra found
+ * @param capacity the number of entries of the tetrahedra buffer
+ * @param count set with the number of tetrahedra found
+ */
+tt_status tt_line_query(tt_index *index, const double p1[3], const double p2[3], int32_t *tetrahedra, int64_t capacity, int64_t *count);
+/**
+ * @brief Extracts the VT relations of the vertices in a box, in compressed sparse row form
+ * The tetrahedra incident in vertices[i] are tetrahedra[offsets[i]] ... tetrahedra[offsets[i+1]-1].
+ * @param vertices set with the vertices found
+ * @param offsets set with the offsets of the vertices (vertices_num+1 entries, thus never NULL)
+ * @param vertices_capacity the number of entries of the vertices buffer (the offsets buffer must have one more entry)
+ * @param tetrahedra set with the incident tetrahedra
+ * @param tetrahedra_capacity the number of entries of the tetrahedra buffer
+ * @param vertices_num set with the number of vertices found
+ * @param tetrahedra_num set with the total number of incident tetrahedra
+ */
+tt_status tt_windowed_vt(tt_index *index, const double min[3], const double max[3],
+                         int32_t *vertices, int32_t *offsets, int64_t vertices_capacity,
+                         int32_t *tetrahedra, int64_t tetrahedra_capacity, int64_t *vertices_num, int64_t *tetrahedra_num);
+/**
+ * @brief Extracts the TT relations of the tetrahedra intersecting a box
+ * Only the adjacencies between tetrahedra found by the query are set, the others are -1.
+ * @param tetrahedra set with the tetrahedra found
+ * @param adjacents set with the four adjacent tetrahedra of each tetrahedron found (the one opposite to each vertex)
+ * @param capacity the number of entries of the tetrahedra buffer (the adjacents buffer must have four times as many entries)
+ * @param count set with the number of tetrahedra found
+ */
+tt_status tt_windowed_tt(tt_index *index, const double min[3], const double max[3], int32_t *tetrahedra, int32_t *adjacents, int64_t capacity, int64_t *count);
+/**
+ * @brief Extracts the TT relations of the tetrahedra intersecting a segment (see tt_windowed_tt)
+ */
+tt_status tt_linearized_tt(tt_index *index, const double p1[3], const double p2[3], int32_t *tetrahedra, int32_t *adjacents, int64_t capacity, int64_t *count);
+/**
+ * @brief Computes the distortion (a discrete curvature) of the vertices in a box
+ * Not supported by a frozen index without reindexing.
+ * @param vertices set with the vertices found
+ * @param values set with the distortion of each vertex found
+ * @param capacity the number of entries of the buffers
+ * @param count set with the number of vertices found
+ */
+tt_status tt_windowed_distortion(tt_index *index, const double min[3], const double max[3], int32_t *vertices, double *values, int64_t capacity, int64_t *count);
+/**
+ * @brief Extracts the VT relation of the whole mesh, in compressed sparse row form
+ * The tetrahedra incident in the vertex v are tetrahedra[offsets[v-1]] ... tetrahedra[offsets[v]-1].
+ * @param offsets set with the offsets of the vertices (vertices_num+1 entries)
+ * @param tetrahedra set with the incident tetrahedra (4*tetrahedra_num entries)
+ */
+tt_status tt_extract_vt(tt_index *index, int32_t *offsets, int32_t *tetrahedra);
+/**
+ * @brief Extracts the TT relation of the whole mesh
+ * @param adjacents set with the four adjacent tetrahedra of each tetrahedron (-1 on the border faces), 4*tetrahedra_num entries
+ */
+tt_status tt_extract_tt(tt_index *index, int32_t *adjacents);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TETRAHEDRAL_TREES_H
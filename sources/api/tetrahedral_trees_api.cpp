@@ -0,0 +1,518 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tetrahedral_trees.h"
+#include "index_handle.h"
+#include "io/reader.h"
+#include "tetrahedral_trees/ok_subdivision.h"
+#include "tetrahedral_trees/kd_subdivision.h"
+#include "tetrahedral_trees/p_tree.h"
+#include "tetrahedral_trees/pt_tree.h"
+#include "tetrahedral_trees/t_tree.h"
+#include "tetrahedral_trees/rt_tree.h"
+#include "tetrahedral_trees/reindexer.h"
+#include "utilities/thread_pool.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+struct tt_index
+{
+    unique_ptr<Index_Handle> handle;
+};
+
+namespace
+{
+    thread_local string last_error;
+
+    const char* DIVISION_NAMES[] = { "ok", "kd" };
+    const char* CRITERION_NAMES[] = { "pr", "pm", "pm2", "pmr" };
+
+    ///sets the error of the calling thread
+    tt_status fail(tt_status status, string message)
+    {
+        last_error = message;
+        return status;
+    }
+
+    ///executes a function of the interface, converting the exceptions in error statuses
+    template<class F> tt_status guarded(F f)
+    {
+        try
+        {
+            tt_status status = f();
+            if(status == TT_OK)
+                last_error.clear();
+            return status;
+        }
+        catch(std::bad_alloc&)
+        {
+            return fail(TT_ERROR_INTERNAL,"out of memory");
+        }
+        catch(std::exception &e)
+        {
+            return fail(TT_ERROR_INTERNAL,e.what());
+        }
+        catch(...)
+        {
+            return fail(TT_ERROR_INTERNAL,"unknown error");
+        }
+    }
+
+    ///executes a query with a context of the index, returned to the pool at the end
+    template<class F> tt_status with_context(tt_index *index, F f)
+    {
+        if(index == NULL)
+            return fail(TT_ERROR_ARGUMENT,"null index");
+        return guarded([&]()
+        {
+            Index_Handle &handle = *index->handle;
+            unique_ptr<Query_Context> context = handle.acquire_context();
+            tt_status status = f(handle,*context);
+            handle.release_context(std::move(context));
+            return status;
+        });
+    }
+
+    ///checks that a result of count entries fits in a buffer of capacity entries, that can be null only if nothing is written in it
+    tt_status check_buffer(const void *buffer, int64_t count, int64_t capacity, const char *name)
+    {
+        if(count > capacity)
+            return fail(TT_ERROR_BUFFER,string("the ")+name+" buffer is too small");
+        if(count > 0 && buffer == NULL)
+            return fail(TT_ERROR_ARGUMENT,string("null ")+name+" buffer");
+        return TT_OK;
+    }
+
+    ///returns the box with the given corners (or representing the segment with the given endpoints)
+    Box make_box(const double min[3], const double max[3])
+    {
+        Point p1(min[0],min[1],min[2]), p2(max[0],max[1],max[2]);
+        return Box(p1,p2);
+    }
+
+    ///wraps a tree in an index, after the reindexing and the freezing required by the options
+    template<class T, class D> tt_status open_tree(unique_ptr<T> tree, const tt_options &options, snapshot::Info &info, tt_index **index)
+    {
+        if(options.reindex)
+        {
+            Reindexer reindexer = Reindexer();
+            reindexer.reindex_tree_and_mesh(*tree);
+        }
+
+        unique_ptr<tt_index> result(new tt_index());
+        if(options.freeze)
+        {
+            // the frozen tree references the mesh of the source tree, which is kept by the index
+            shared_ptr<T> source(std::move(tree));
+            unique_ptr<Frozen_Tree<D> > frozen(new Frozen_Tree<D>(*source));
+            result->handle.reset(new Tree_Index<Frozen_Tree<D> >(std::move(frozen),source,info,true,options.threads_num));
+        }
+        else
+            result->handle.reset(new Tree_Index<T>(std::move(tree),shared_ptr<void>(),info,false,options.threads_num));
+        *index = result.release();
+        return TT_OK;
+    }
+
+    ///reads the mesh and builds (or loads) a tree on it
+    template<class T, class D> tt_status build_tree(unique_ptr<T> tree, const char *mesh_path, const char *tree_path,
+                                                    const tt_options &options, snapshot::Info &info, tt_index **index)
+    {
+        if(!Reader::read_mesh(tree->get_mesh(),mesh_path,options.threads_num))
+            return fail(TT_ERROR_IO,string("cannot read the mesh file ")+mesh_path);
+
+        if(tree_path != NULL)
+        {
+            if(!Reader::read_tree(*tree,tree->get_root(),tree_path))
+                return fail(TT_ERROR_IO,string("cannot read the tree file ")+tree_path);
+        }
+        else if(options.build_type == TT_BUILD_BULK)
+            tree->build_tree_bulk(options.threads_num);
+        else if(options.build_type == TT_BUILD_MORTON)
+            build_tree_morton(*tree,options.threads_num);
+        else
+            tree->build_tree();
+
+        return open_tree<T,D>(std::move(tree),options,info,index);
+    }
+
+    ///instantiates the tree defined by the criterion on the subdivision D
+    template<class D> tt_status build_index(const char *mesh_path, const char *tree_path, const tt_options &options,
+                                            snapshot::Info &info, tt_index **index)
+    {
+        if(options.criterion == TT_PR)
+            return build_tree<P_Tree<D>,D>(unique_ptr<P_Tree<D> >(new P_Tree<D>(options.vertices_per_leaf)),
+                                           mesh_path,tree_path,options,info,index);
+        else if(options.criterion == TT_PM)
+            return build_tree<PT_Tree<D>,D>(unique_ptr<PT_Tree<D> >(new PT_Tree<D>(options.vertices_per_leaf,options.tetrahedra_per_leaf)),
+                                            mesh_path,tree_path,options,info,index);
+        else if(options.criterion == TT_PM2)
+            return build_tree<T_Tree<D>,D>(unique_ptr<T_Tree<D> >(new T_Tree<D>(options.tetrahedra_per_leaf)),
+                                           mesh_path,tree_path,options,info,index);
+        else
+            return build_tree<RT_Tree<D>,D>(unique_ptr<RT_Tree<D> >(new RT_Tree<D>(options.tetrahedra_per_leaf)),
+                                            mesh_path,tree_path,options,info,index);
+    }
+
+    ///checks the options and opens an index on a mesh
+    tt_status open_index(const char *mesh_path, const char *tree_path, const tt_options *options, tt_index **index)
+    {
+        if(mesh_path == NULL || options == NULL || index == NULL)
+            return fail(TT_ERROR_ARGUMENT,"null argument");
+        *index = NULL;
+        if(options->division != TT_OCTREE && options->division != TT_KDTREE)
+            return fail(TT_ERROR_ARGUMENT,"not a valid division");
+        if(options->criterion < TT_PR || options->criterion > TT_PMR)
+            return fail(TT_ERROR_ARGUMENT,"not a valid criterion");
+        if((options->criterion == TT_PR || options->criterion == TT_PM) && options->vertices_per_leaf <= 0)
+            return fail(TT_ERROR_ARGUMENT,"the vertices threshold must be positive");
+        if(options->criterion != TT_PR && options->tetrahedra_per_leaf <= 0)
+            return fail(TT_ERROR_ARGUMENT,"the tetrahedra threshold must be positive");
+        if(options->build_type < TT_BUILD_SEQUENTIAL || options->build_type > TT_BUILD_MORTON)
+            return fail(TT_ERROR_ARGUMENT,"not a valid build type");
+        if(options->build_type == TT_BUILD_MORTON && options->criterion != TT_PR)
+            return fail(TT_ERROR_ARGUMENT,"the morton construction is available only for the PR criterion");
+        if(options->threads_num < 1)
+            return fail(TT_ERROR_ARGUMENT,"the number of threads must be positive");
+
+        snapshot::Info info;
+        info.division_type = DIVISION_NAMES[options->division];
+        info.crit_type = CRITERION_NAMES[options->criterion];
+        info.vertices_per_leaf = (options->criterion == TT_PR || options->criterion == TT_PM) ? options->vertices_per_leaf : -1;
+        info.tetrahedra_per_leaf = (options->criterion != TT_PR) ? options->tetrahedra_per_leaf : -1;
+        info.reindexed = options->reindex;
+
+        return guarded([&]()
+        {
+            if(options->division == TT_OCTREE)
+                return build_index<OK_Subdivision>(mesh_path,tree_path,*options,info,index);
+            else
+                return build_index<KD_Subdivision>(mesh_path,tree_path,*options,info,index);
+        });
+    }
+
+    ///wraps the frozen tree of a snapshot in an index
+    template<class D> tt_status open_snapshot(shared_ptr<Mesh> mesh, Frozen_Layout &layout, snapshot::Info &info, int threads_num, tt_index **index)
+    {
+        unique_ptr<Frozen_Tree<D> > frozen(new Frozen_Tree<D>(*mesh,layout));
+        unique_ptr<tt_index> result(new tt_index());
+        result->handle.reset(new Tree_Index<Frozen_Tree<D> >(std::move(frozen),mesh,info,true,threads_num));
+        *index = result.release();
+        return TT_OK;
+    }
+
+    ///copies the TT relations found by a windowed or linearized TT query
+    tt_status copy_TT(TT_Result &tt, int32_t *tetrahedra, int32_t *adjacents, int64_t capacity, int64_t *count)
+    {
+        *count = tt.size();
+        tt_status status = check_buffer(tetrahedra,*count,capacity,"tetrahedra");
+        if(status == TT_OK)
+            status = check_buffer(adjacents,*count,capacity,"adjacents");
+        if(status != TT_OK)
+            return status;
+        for(int i=0; i<tt.size(); i++)
+        {
+            tetrahedra[i] = tt.get_tetrahedron(i);
+            memcpy(adjacents+4*(size_t)i,tt.get_adjacents(i),4*sizeof(int));
+        }
+        return TT_OK;
+    }
+}
+
+void tt_default_options(tt_options *options)
+{
+    if(options == NULL)
+        return;
+    options->division = TT_KDTREE;
+    options->criterion = TT_PR;
+    options->vertices_per_leaf = 20;
+    options->tetrahedra_per_leaf = -1;
+    options->build_type = TT_BUILD_SEQUENTIAL;
+    options->reindex = 0;
+    options->freeze = 0;
+    options->threads_num = Thread_Pool::get_hardware_threads_num();
+}
+
+tt_status tt_build(const char *mesh_path, const tt_options *options, tt_index **index)
+{
+    return open_index(mesh_path,NULL,options,index);
+}
+
+tt_status tt_load_tree(const char *mesh_path, const char *tree_path, const tt_options *options, tt_index **index)
+{
+    if(tree_path == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null tree path");
+    return open_index(mesh_path,tree_path,options,index);
+}
+
+tt_status tt_load_snapshot(const char *snapshot_path, int32_t threads_num, tt_index **index)
+{
+    if(snapshot_path == NULL || index == NULL || threads_num < 1)
+        return fail(TT_ERROR_ARGUMENT,"not a valid argument");
+    *index = NULL;
+    return guarded([&]()
+    {
+        shared_ptr<Mesh> mesh(new Mesh());
+        Frozen_Layout layout;
+        snapshot::Info info;
+        if(!Reader::read_snapshot(snapshot_path,*mesh,layout,info))
+            return fail(TT_ERROR_IO,string("cannot read the snapshot file ")+snapshot_path);
+        if(info.division_type == "ok")
+            return open_snapshot<OK_Subdivision>(mesh,layout,info,threads_num,index);
+        else
+            return open_snapshot<KD_Subdivision>(mesh,layout,info,threads_num,index);
+    });
+}
+
+tt_status tt_write_snapshot(tt_index *index, const char *snapshot_path)
+{
+    if(index == NULL || snapshot_path == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return guarded([&]()
+    {
+        if(!index->handle->write_snapshot(snapshot_path))
+            return fail(TT_ERROR_IO,string("cannot write the snapshot file ")+snapshot_path);
+        return TT_OK;
+    });
+}
+
+void tt_free(tt_index *index)
+{
+    delete index;
+}
+
+const char* tt_last_error(void)
+{
+    return last_error.c_str();
+}
+
+int64_t tt_get_vertices_num(tt_index *index)
+{
+    return (index == NULL) ? 0 : index->handle->get_mesh().get_num_vertices();
+}
+
+int64_t tt_get_tetrahedra_num(tt_index *index)
+{
+    return (index == NULL) ? 0 : index->handle->get_mesh().get_num_tetrahedra();
+}
+
+tt_status tt_get_vertex(tt_index *index, int32_t vertex, double coords[3])
+{
+    if(index == NULL || coords == NULL || vertex < 1 || vertex > tt_get_vertices_num(index))
+        return fail(TT_ERROR_ARGUMENT,"not a valid vertex");
+    Vertex v = index->handle->get_mesh().get_vertex(vertex);
+    coords[0] = v.get_x();
+    coords[1] = v.get_y();
+    coords[2] = v.get_z();
+    last_error.clear();
+    return TT_OK;
+}
+
+tt_status tt_get_tetrahedron(tt_index *index, int32_t tetrahedron, int32_t vertices[4])
+{
+    if(index == NULL || vertices == NULL || tetrahedron < 1 || tetrahedron > tt_get_tetrahedra_num(index))
+        return fail(TT_ERROR_ARGUMENT,"not a valid tetrahedron");
+    Tetrahedron &t = index->handle->get_mesh().get_tetrahedron(tetrahedron);
+    for(int i=0; i<4; i++)
+        vertices[i] = t.TV(i);
+    last_error.clear();
+    return TT_OK;
+}
+
+tt_status tt_locate_point(tt_index *index, const double point[3], int32_t *tetrahedron)
+{
+    if(point == NULL || tetrahedron == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        Point p(point[0],point[1],point[2]);
+        *tetrahedron = handle.locate_point(context,p);
+        return TT_OK;
+    });
+}
+
+tt_status tt_locate_points(tt_index *index, const double *points, int64_t points_num, int32_t *tetrahedra)
+{
+    if(points_num < 0 || (points_num > 0 && (points == NULL || tetrahedra == NULL)))
+        return fail(TT_ERROR_ARGUMENT,"not a valid argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        vector<Point> query_points;
+        query_points.reserve(points_num);
+        for(int64_t i=0; i<points_num; i++)
+            query_points.push_back(Point(points[3*i],points[3*i+1],points[3*i+2]));
+        vector<int> results;
+        handle.locate_points(context,query_points,results);
+        std::copy(results.begin(),results.end(),tetrahedra);
+        return TT_OK;
+    });
+}
+
+tt_status tt_box_query(tt_index *index, const double min[3], const double max[3], int32_t *tetrahedra, int64_t capacity, int64_t *count)
+{
+    if(min == NULL || max == NULL || count == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        Box b = make_box(min,max);
+        handle.box_query(context,b);
+        *count = context.qS.tetrahedra.size();
+        tt_status status = check_buffer(tetrahedra,*count,capacity,"tetrahedra");
+        if(status != TT_OK)
+            return status;
+        std::copy(context.qS.tetrahedra.begin(),context.qS.tetrahedra.end(),tetrahedra);
+        return TT_OK;
+    });
+}
+
+tt_status tt_line_query(tt_index *index, const double p1[3], const double p2[3], int32_t *tetrahedra, int64_t capacity, int64_t *count)
+{
+    if(p1 == NULL || p2 == NULL || count == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        Box b = make_box(p1,p2);
+        handle.line_query(context,b);
+        *count = context.qS.tetrahedra.size();
+        tt_status status = check_buffer(tetrahedra,*count,capacity,"tetrahedra");
+        if(status != TT_OK)
+            return status;
+        std::copy(context.qS.tetrahedra.begin(),context.qS.tetrahedra.end(),tetrahedra);
+        return TT_OK;
+    });
+}
+
+tt_status tt_windowed_vt(tt_index *index, const double min[3], const double max[3],
+                         int32_t *vertices, int32_t *offsets, int64_t vertices_capacity,
+                         int32_t *tetrahedra, int64_t tetrahedra_capacity, int64_t *vertices_num, int64_t *tetrahedra_num)
+{
+    if(min == NULL || max == NULL || vertices_num == NULL || tetrahedra_num == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        Box b = make_box(min,max);
+        handle.windowed_VT(context,b);
+        VT_Result &vt = context.vt;
+        *vertices_num = vt.size();
+        *tetrahedra_num = 0;
+        for(int i=0; i<vt.size(); i++)
+            *tetrahedra_num += vt.end(i) - vt.begin(i);
+        // the offsets buffer always receives the final offset, even if no vertex is found
+        tt_status status = check_buffer(vertices,*vertices_num,vertices_capacity,"vertices");
+        if(status == TT_OK)
+            status = check_buffer(tetrahedra,*tetrahedra_num,tetrahedra_capacity,"tetrahedra");
+        if(status == TT_OK)
+            status = check_buffer(offsets,*vertices_num+1,vertices_capacity+1,"offsets");
+        if(status != TT_OK)
+            return status;
+
+        int offset = 0;
+        for(int i=0; i<vt.size(); i++)
+        {
+            vertices[i] = vt.get_vertex(i);
+            offsets[i] = offset;
+            offset = std::copy(vt.begin(i),vt.end(i),tetrahedra+offset) - tetrahedra;
+        }
+        offsets[vt.size()] = offset;
+        return TT_OK;
+    });
+}
+
+tt_status tt_windowed_tt(tt_index *index, const double min[3], const double max[3], int32_t *tetrahedra, int32_t *adjacents, int64_t capacity, int64_t *count)
+{
+    if(min == NULL || max == NULL || count == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        Box b = make_box(min,max);
+        handle.windowed_TT(context,b);
+        return copy_TT(context.tt,tetrahedra,adjacents,capacity,count);
+    });
+}
+
+tt_status tt_linearized_tt(tt_index *index, const double p1[3], const double p2[3], int32_t *tetrahedra, int32_t *adjacents, int64_t capacity, int64_t *count)
+{
+    if(p1 == NULL || p2 == NULL || count == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        Box b = make_box(p1,p2);
+        handle.linearized_TT(context,b);
+        return copy_TT(context.tt,tetrahedra,adjacents,capacity,count);
+    });
+}
+
+tt_status tt_windowed_distortion(tt_index *index, const double min[3], const double max[3], int32_t *vertices, double *values, int64_t capacity, int64_t *count)
+{
+    if(min == NULL || max == NULL || count == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        if(!handle.is_distortion_supported())
+            return fail(TT_ERROR_UNSUPPORTED,"the distortion requires a reindexed mesh on a frozen index");
+        Box b = make_box(min,max);
+        handle.windowed_Distortion(context,b);
+        Distortion_Result &dist = context.dist;
+        *count = dist.size();
+        tt_status status = check_buffer(vertices,*count,capacity,"vertices");
+        if(status == TT_OK)
+            status = check_buffer(values,*count,capacity,"values");
+        if(status != TT_OK)
+            return status;
+        for(int i=0; i<dist.size(); i++)
+        {
+            vertices[i] = dist.get_vertex(i);
+            values[i] = dist.get_value(i);
+        }
+        return TT_OK;
+    });
+}
+
+tt_status tt_extract_vt(tt_index *index, int32_t *offsets, int32_t *tetrahedra)
+{
+    if(offsets == NULL || tetrahedra == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        VT_Relation vt;
+        handle.extract_VT(context,vt);
+        std::copy(vt.get_offsets().begin(),vt.get_offsets().end(),offsets);
+        std::copy(vt.get_tetrahedra().begin(),vt.get_tetrahedra().end(),tetrahedra);
+        return TT_OK;
+    });
+}
+
+tt_status tt_extract_tt(tt_index *index, int32_t *adjacents)
+{
+    if(adjacents == NULL)
+        return fail(TT_ERROR_ARGUMENT,"null argument");
+    return with_context(index,[&](Index_Handle &handle, Query_Context &context)
+    {
+        TT_Relation tt;
+        handle.extract_TT(context,tt);
+        std::copy(tt.get_adjacents().begin(),tt.get_adjacents().end(),adjacents);
+        return TT_OK;
+    });
+}
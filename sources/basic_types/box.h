@@ -38,20 +38,12 @@ public:
         min = Point();
         max = Point();
     }
-    ///A copy-constructor method
-    Box(const Box& orig)
-    {
-        min = orig.min;
-        max = orig.max;
-    }
     ///A constructor method
     Box(Point& min, Point& max)
     {
         this->min = min;
         this->max = max;
     }
-    ///A destructor method
-    virtual ~Box() {}
 
     ///Public method that returns the minimum point of the box.
     /*!
@@ -142,7 +134,7 @@ public:
      * \param p a Point& argument, represents the point to check
      * \return a boolean value, true if the point is inside domain, false otherwise
      */
-    inline bool contains_with_all_closed_faces(Point& p)
+    inline bool contains_with_all_closed_faces(const Point& p)
     {
         for(int i=0; i<p.get_dimension(); i++)
         {
@@ -25,13 +25,36 @@
 #define	_MESH_H
 
 #include <vector>
+#include <type_traits>
 
 #include "vertex.h"
 #include "tetrahedron.h"
 #include "box.h"
 
+#ifdef MESH_COORDS_FLOAT
+///the type of the stored coordinates of the mesh vertices
+typedef float mesh_coord;
+#else
+///the type of the stored coordinates of the mesh vertices
+typedef double mesh_coord;
+#endif
+
+// the tetrahedra array is a plain array of indices (no virtual tables or padding)
+static_assert(sizeof(Tetrahedron) == 4*sizeof(int), "a Tetrahedron must be stored as four int32");
+static_assert(std::is_trivially_copyable<Tetrahedron>::value, "the tetrahedra array must be copied in bulk");
+
 using namespace std;
-///A class representing a tetrahedral mesh
+/**
+ * @brief A class representing a tetrahedral mesh.
+ * The vertices are stored as a structure of arrays (one array for each coordinate and one for the field values),
+ * while the tetrahedra are stored in a packed array of four int32 per tetrahedron (Tetrahedron has no virtual table).
+ * The vertices are accessed through lightweight views (get_vertex returns a Vertex by value) and updated with set_vertex.
+ *
+ * By default the coordinates are stored in double precision. If the MESH_COORDS_FLOAT flag is defined at compile time, they are stored
+ * in single precision: the coordinates are rounded once, when set, and all the geometric predicates are then evaluated in double
+ * precision on the stored values (the conversion from float to double is exact). Thus, the domain, the tree and the queries all
+ * refer to the same (rounded) geometry, and no vertex or tetrahedron is lost by the spatial tests.
+ */
 class Mesh
 {
 public:
@@ -39,28 +62,35 @@ public:
     Mesh()
     {
         domain = Box();
-        vertices = vector<Vertex>();
-        tetrahedra = vector<Tetrahedron>();
-    }
-    ///A copy-constructor method
-    Mesh(const Mesh& orig)
-    {
-        this->tetrahedra = orig.tetrahedra;
-        this->vertices = orig.vertices;
-        this->domain = orig.domain;
-    }
-    ///A destructor method
-    virtual ~Mesh()
-    {
-        vertices.clear();
-        tetrahedra.clear();
     }
-    ///A public method that returns the vertex at the i-th position in the mesh list
+    ///A public method that returns a view of the vertex at the i-th position in the mesh list
+    /*!
+     * \param id an integer argument, representing the position in the list
+     * \return a Vertex, a copy of the vertex at the id-th position in the list (use set_vertex to update it)
+     */
+    inline Vertex get_vertex(int id) const { return Vertex(this->coords[0][id-1],this->coords[1][id-1],this->coords[2][id-1],this->fields[id-1]); }
+    ///A public method that returns a coordinate of the vertex at the i-th position in the mesh list
     /*!
      * \param id an integer argument, representing the position in the list
-     * \return a Vertex&, the vertex at the id-th position in the list
+     * \param pos an integer argument, representing the coordinate (0, 1 or 2)
+     * \return a double, the stored coordinate
      */
-    inline Vertex& get_vertex(int id) { return this->vertices[id-1]; }
+    inline double get_vertex_c(int id, int pos) const { return this->coords[pos][id-1]; }
+    ///A public method that returns the field value of the vertex at the i-th position in the mesh list
+    /*!
+     * \param id an integer argument, representing the position in the list
+     * \return a double, the field value
+     */
+    inline double get_vertex_field(int id) const { return this->fields[id-1]; }
+    ///A public method that prefetches the coordinates of the vertex at the i-th position in the mesh list (one cache line per axis)
+    /*!
+     * \param id an integer argument, representing the position in the list
+     */
+    inline void prefetch_vertex(int id) const
+    {
+        for(int c=0; c<3; c++)
+            __builtin_prefetch(&this->coords[c][id-1]);
+    }
     ///A public method that returns the tetrahedron at the i-th position in the mesh list
     /*!
      * \param id an integer argument, representing the position in the list
@@ -76,27 +106,74 @@ public:
     /*!
      * \return an integer, representing the number of vertices
      */
-    inline int get_num_vertices() { return this->vertices.size(); }
+    inline int get_num_vertices() const { return this->fields.size(); }
     ///A public method that returns the number of mesh tetrahedra
     /*!
      * \return an integer, representing the number of tetrahedra
      */
-    inline int get_num_tetrahedra() { return this->tetrahedra.size(); }
+    inline int get_num_tetrahedra() const { return this->tetrahedra.size(); }
+    ///A public method that returns the array of a coordinate of the vertices (used by the bulk loaders, after resize)
+    /*!
+     * \param pos an integer argument, representing the coordinate (0, 1 or 2)
+     * \return a mesh_coord*, the first entry of the array
+     */
+    inline mesh_coord* get_coords_data(int pos) { return this->coords[pos].data(); }
+    ///A public method that returns the array of the field values of the vertices (used by the bulk loaders, after resize)
+    inline double* get_fields_data() { return this->fields.data(); }
+    ///A public method that returns the tetrahedra array (used by the bulk loaders, after resize)
+    inline Tetrahedron* get_tetrahedra_data() { return this->tetrahedra.data(); }
+    ///A public method that returns the bytes allocated by the vertices arrays
+    inline size_t get_vertices_bytes() const
+    {
+        return (this->coords[0].capacity() + this->coords[1].capacity() + this->coords[2].capacity()) * sizeof(mesh_coord)
+                + this->fields.capacity() * sizeof(double);
+    }
+    ///A public method that returns the bytes allocated by the tetrahedra array
+    inline size_t get_tetrahedra_bytes() const { return this->tetrahedra.capacity() * sizeof(Tetrahedron); }
     ///A public method that sets the mesh domain
     /*!
      * \param d a Box& argument, representing the domain to set
      */
     inline void set_domain(Box& d) { this->domain = d; }
+    ///A public method that sets the vertex at the i-th position in the mesh list
+    /*!
+     * \param id an integer argument, representing the position in the list
+     * \param v a Vertex& argument, representing the coordinates and the field value to set
+     */
+    inline void set_vertex(int id, const Vertex& v)
+    {
+        for(int c=0; c<3; c++)
+            this->coords[c][id-1] = v.get_c(c);
+        this->fields[id-1] = v.get_field();
+    }
+    ///A public method that sets a coordinate of the vertex at the i-th position in the mesh list
+    /*!
+     * \param id an integer argument, representing the position in the list
+     * \param pos an integer argument, representing the coordinate (0, 1 or 2)
+     * \param c a double argument, representing the coordinate value (rounded to mesh_coord)
+     */
+    inline void set_vertex_c(int id, int pos, double c) { this->coords[pos][id-1] = c; }
+    ///A public method that sets the field value of the vertex at the i-th position in the mesh list
+    /*!
+     * \param id an integer argument, representing the position in the list
+     * \param field a double argument, representing the field value
+     */
+    inline void set_vertex_field(int id, double field) { this->fields[id-1] = field; }
     ///A public method that adds a vertex to the vertices list
     /*!
      * \param v a Vertex& argument, representing the vertex to add
      */
-    inline void add_vertex(Vertex& v) { this->vertices.push_back(v); }
+    inline void add_vertex(const Vertex& v)
+    {
+        for(int c=0; c<3; c++)
+            this->coords[c].push_back(v.get_c(c));
+        this->fields.push_back(v.get_field());
+    }
     ///A public method that adds a tetrahedron to the tetrahedra list
     /*!
      * \param t a Tetrahedron& argument, representing the tetrahedron to add
      */
-    inline void add_tetrahedron(Tetrahedron& t) { this->tetrahedra.push_back(t); }
+    inline void add_tetrahedron(const Tetrahedron& t) { this->tetrahedra.push_back(t); }
     ///A public method that initializes the space needed by the vertices and tetrahedra arrays
     /*!
      * \param numV an integer, represents the number of mesh vertices
@@ -104,16 +181,38 @@ public:
      */
     inline void reserve(int numV, int numT)
     {
-        this->vertices.reserve(numV);
+        this->reserve_vertices_space(numV);
         this->tetrahedra.reserve(numT);
     }
+    ///A public method that sets the number of vertices and tetrahedra, default-initializing the new entries
+    /*!
+     * \param numV an integer, represents the number of mesh vertices
+     * \param numT an integer, represents the number of mesh tetrahedra
+     */
+    inline void resize(int numV, int numT)
+    {
+        for(int c=0; c<3; c++)
+            this->coords[c].resize(numV);
+        this->fields.resize(numV);
+        this->tetrahedra.resize(numT);
+    }
     ///A public method that initializes the space needed by the vertices array
     /*!
      * \param numV an integer, represents the number of mesh vertices
      */
-    inline void reserve_vertices_space(int numV) { this->vertices.reserve(numV); }
+    inline void reserve_vertices_space(int numV)
+    {
+        for(int c=0; c<3; c++)
+            this->coords[c].reserve(numV);
+        this->fields.reserve(numV);
+    }
     ///A public method that resets the vertices array
-    inline void reset_vertices() { this->vertices.clear(); }
+    inline void reset_vertices()
+    {
+        for(int c=0; c<3; c++)
+            this->coords[c].clear();
+        this->fields.clear();
+    }
     ///A public method that initializes the space needed by the tetrahedra array
     /*!
      * \param numT an integer, represents the number of mesh tetrahedra
@@ -125,11 +224,12 @@ public:
 private:
     ///A private varible representing the mesh domain
     Box domain;
-    ///A private varible representing the vertices array of the mesh
-    vector<Vertex> vertices;
-    ///A private varible representing the tetrahedra array of the mesh
+    ///A private varible representing the coordinates of the mesh vertices, one array for each axis
+    vector<mesh_coord> coords[3];
+    ///A private varible representing the field values of the mesh vertices
+    vector<double> fields;
+    ///A private varible representing the tetrahedra array of the mesh (four int32 per tetrahedron)
     vector<Tetrahedron> tetrahedra;
 };
 
 #endif	/* _MESH_H */
-
@@ -38,13 +38,6 @@ public:
         this->coords[1]=0;
         this->coords[2]=0;
     }
-    ///A copy-constructor method
-    Point(const Point& orig)
-    {
-        this->coords[0] = orig.coords[0];
-        this->coords[1] = orig.coords[1];
-        this->coords[2] = orig.coords[2];
-    }
     ///A constructor method
     /*!
      * \param x a double argument, representing the x coordinate
@@ -57,8 +50,6 @@ public:
         this->coords[1]=y;
         this->coords[2]=z;
     }
-    ///A destructor method
-    virtual ~Point() {}
     /**
      * @brief operator ==
      * @param p
@@ -37,17 +37,6 @@ class Tetrahedron {
 public:
     ///A constructor method
     Tetrahedron() {}
-    /**
-     * @brief A copy-constructor method
-     * @param orig
-     */
-    Tetrahedron(const Tetrahedron& orig)
-    {
-        for (int i = 0; i < orig.vertices_num(); i++)
-        {
-            this->vertices[i] = orig.vertices[i];
-        }
-    }
     ///A constructor method
     /*!
      * \param v1 a int argument, represents the first tetrahedron vertex
@@ -56,8 +45,6 @@ public:
      * \param v4 a int argument, represents the fourth tetrahedron vertex
      */
     Tetrahedron(int v1, int v2, int v3, int v4) { this->set(v1,v2,v3,v4); }
-    ///A destructor method
-    virtual ~Tetrahedron() {}
     /**
      * @brief A public method that sets the current tetrahedron
      *
@@ -33,8 +33,6 @@ class Vertex : public Point
 public:
     ///A constructor method
     Vertex() : Point() { this->field_value = 0; }
-    ///A copy-constructor method
-    Vertex(const Vertex& orig) : Point(orig) { this->field_value=orig.field_value; }
     ///A constructor method
     /*!
      * \param x a double argument, representing the x coordinate
@@ -46,13 +44,16 @@ public:
     {
        this->field_value = field;
     }
-    ///A destructor method
-    virtual ~Vertex() { }
     ///A public method that returns the vertex field value
     /*!
      * \return an integer, representing the field value
      */
-    inline double get_field() { return field_value; }
+    inline double get_field() const { return field_value; }
+    ///A public method that sets the vertex field value
+    /*!
+     * \param field a double argument, representing the field value
+     */
+    inline void set_field(double field) { this->field_value = field; }
     /**
      * @brief operator <<
      * @param out
@@ -818,9 +818,9 @@ int Geometry::tetra_in_box_strict(double * minF, double * maxF, double **c)
     }
 
     /* check if one triangular facet intersects box */
-    double* x = new double[3];
-    double* y = new double[3];
-    double* z = new double[3];
+    double x[3];
+    double y[3];
+    double z[3];
 
     for (i = 0; i < 4; i++)
     {
@@ -833,26 +833,15 @@ int Geometry::tetra_in_box_strict(double * minF, double * maxF, double **c)
         if (ClipTriangle3D_strict(minF[0], minF[1], minF[2],
                                   maxF[0], maxF[1], maxF[2], x, y, z))
         {
-            //DEALLOCAZIONE
-            delete x;
-            delete y;
-            delete z;
-            //DEALLOCAZIONE
             return 1;
         }
     }
 
-    //DEALLOCAZIONE
-    delete x;
-    delete y;
-    delete z;
-    //DEALLOCAZIONE
-
     /* check if some triangular face of the tetrahedron is coplanar to a
      squared face of the box and the rest of tetrahedron lies on the interior
      side of the box defined by such squared face. */
-    double* xt = new double[3];
-    double* yt = new double[3];
+    double xt[3];
+    double yt[3];
     for (i = 0; i < 4; i++)
     {
         for (j = 0; j < 3; j++)
@@ -874,10 +863,6 @@ int Geometry::tetra_in_box_strict(double * minF, double * maxF, double **c)
                 { /* if fourth vertex has larger j-coordinate, then they intersect */
                     if (c[(i + 3) % 4][j] > minF[j])
                     {
-                        //DEALLOCAZIONE
-                        delete xt;
-                        delete yt;
-                        //DEALLOCAZIONE
                         return 1;
                     }
                 }
@@ -900,10 +885,6 @@ int Geometry::tetra_in_box_strict(double * minF, double * maxF, double **c)
                 { /* if fourth vertex has smaller j-coordinate, then they intersect */
                     if (c[(i + 3) % 4][j] < maxF[j])
                     {
-                        //DEALLOCAZIONE
-                        delete xt;
-                        delete yt;
-                        //DEALLOCAZIONE
                         return 1;
                     }
                 }
@@ -911,10 +892,6 @@ int Geometry::tetra_in_box_strict(double * minF, double * maxF, double **c)
             }
         }
     }
-    //DEALLOCAZIONE
-    delete xt;
-    delete yt;
-    //DEALLOCAZIONE
     /* box and tetrahedron do not intersect each other */
     return 0;
 }
@@ -957,9 +934,9 @@ int Geometry::tetra_in_box(double * minF, double * maxF, double **c) {
     }
 
     /* check if one triangular facet intersects box */
-    double* x = new double[3]; /* vertex coordinates */
-    double* y = new double[3];
-    double* z = new double[3];
+    double x[3]; /* vertex coordinates */
+    double y[3];
+    double z[3];
 
     for (i = 0; i < 4; i++)
     {
@@ -972,21 +949,10 @@ int Geometry::tetra_in_box(double * minF, double * maxF, double **c) {
         if (ClipTriangle3D(minF[0], minF[1], minF[2],
                            maxF[0], maxF[1], maxF[2], x, y, z))
         {
-            //DEALLOCAZIONE
-            delete x;
-            delete y;
-            delete z;
-            //DEALLOCAZIONE
             return 1;
         }
     }
 
-    //DEALLOCAZIONE
-    delete x;
-    delete y;
-    delete z;
-    //DEALLOCAZIONE
-
     /* box and tetrahedron do not intersect each other */
     return 0;
 }
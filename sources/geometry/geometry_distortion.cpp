@@ -43,10 +43,10 @@ double Geometry_Distortion::get_trihedral_angle(Tetrahedron &t, int v, Mesh& mes
     }
 
     //vertices coordinates
-    Vertex& v0 = mesh.get_vertex(v);
-    Vertex& v1 = mesh.get_vertex(other_vert[1]);
-    Vertex& v2 = mesh.get_vertex(other_vert[2]);
-    Vertex& v3 = mesh.get_vertex(other_vert[0]);
+    Vertex v0 = mesh.get_vertex(v);
+    Vertex v1 = mesh.get_vertex(other_vert[1]);
+    Vertex v2 = mesh.get_vertex(other_vert[2]);
+    Vertex v3 = mesh.get_vertex(other_vert[0]);
 
     //computing all the scalar product
     prodscalv1vv2 = v0.scalar_product(v1,v2);
@@ -78,10 +78,10 @@ double Geometry_Distortion::get_trihedral_angle_3D(Tetrahedron &t, int v, Mesh &
     }
 
     //vertices coordinates
-    Vertex& v0 = mesh.get_vertex(v);
-    Vertex& v1 = mesh.get_vertex(other_vert[1]);
-    Vertex& v2 = mesh.get_vertex(other_vert[2]);
-    Vertex& v3 = mesh.get_vertex(other_vert[0]);
+    Vertex v0 = mesh.get_vertex(v);
+    Vertex v1 = mesh.get_vertex(other_vert[1]);
+    Vertex v2 = mesh.get_vertex(other_vert[2]);
+    Vertex v3 = mesh.get_vertex(other_vert[0]);
 
     //computing all the scalar product
     prodscalv1vv2 = v0.cross_3D(v1,v2);
@@ -23,15 +23,16 @@
 
 #include "geometry_wrapper.h"
 #include <boost/dynamic_bitset.hpp>
+#include <limits>
 
 void Geometry_Wrapper::get_tetrahedron_centroid(int t_id, Point& p, Mesh &mesh)
 {
     Tetrahedron &tet = mesh.get_tetrahedron(t_id);
 
-    Vertex& v0 = mesh.get_vertex(tet.TV(0));
-    Vertex& v1 = mesh.get_vertex(tet.TV(1));
-    Vertex& v2 = mesh.get_vertex(tet.TV(2));
-    Vertex& v3 = mesh.get_vertex(tet.TV(3));
+    Vertex v0 = mesh.get_vertex(tet.TV(0));
+    Vertex v1 = mesh.get_vertex(tet.TV(1));
+    Vertex v2 = mesh.get_vertex(tet.TV(2));
+    Vertex v3 = mesh.get_vertex(tet.TV(3));
 
     for(int i=0; i<3; i++)
         p.set_c(i,(v0.get_c(i) + v1.get_c(i) + v2.get_c(i) + v3.get_c(i)) / 4.0);
@@ -40,27 +41,130 @@ void Geometry_Wrapper::get_tetrahedron_centroid(int t_id, Point& p, Mesh &mesh)
 bool Geometry_Wrapper::point_in_tetra(int t_id, Point& point, Mesh &mesh)
 {
     Tetrahedron &tet = mesh.get_tetrahedron(t_id);
-    double **c;
-    c = new double* [4];
+    double c[4][3];
     for (int i = 0; i < tet.vertices_num(); i++)
     {
-        c[i] = new double[3];
-        Vertex &v = mesh.get_vertex(tet.TV(i));
+        Vertex v = mesh.get_vertex(tet.TV(i));
         c[i][0] = v.get_x();
         c[i][1] = v.get_y();
         c[i][2] = v.get_z();
     }
 
-    bool ret = false;
+    return PointInTetra(point.get_x(),point.get_y(),point.get_z(),c[0],c[1],c[2],c[3]);
+}
 
-    if(PointInTetra(point.get_x(),point.get_y(),point.get_z(),c[0],c[1],c[2],c[3]))
-        ret = true;
+int Geometry_Wrapper::point_in_tetra_batch(const int *t_ids, int num, Point& point, Mesh &mesh)
+{
+    double c[4][3][BATCH_SIZE];
+    Geometry_Wrapper::gather_batch(t_ids,num,mesh,c);
 
+    Lanes4 x[4], y[4], z[4];
+    for(int v=0; v<4; v++)
+    {
+        x[v] = Lanes4::load(c[v][0]);
+        y[v] = Lanes4::load(c[v][1]);
+        z[v] = Lanes4::load(c[v][2]);
+    }
+    Lanes4 px = Lanes4::set1(point.get_x());
+    Lanes4 py = Lanes4::set1(point.get_y());
+    Lanes4 pz = Lanes4::set1(point.get_z());
+    Lanes4 one = Lanes4::set1(1.0);
+    Lanes4 zero = Lanes4::set1(0.0);
+
+    // the point coincides with a vertex of the tetrahedron
+    Lanes4 coincide = Lanes4::cmp_eq(px,x[0]) & Lanes4::cmp_eq(py,y[0]) & Lanes4::cmp_eq(pz,z[0]);
+    for(int v=1; v<4; v++)
+        coincide = coincide | (Lanes4::cmp_eq(px,x[v]) & Lanes4::cmp_eq(py,y[v]) & Lanes4::cmp_eq(pz,z[v]));
+
+    // same determinants, and same evaluation order, of PointInTetra
+    Lanes4 orientation = det_sign(Det4D(x[0], y[0], z[0], one,
+                                        x[1], y[1], z[1], one,
+                                        x[2], y[2], z[2], one,
+                                        x[3], y[3], z[3], one));
+    Lanes4 d1 = det_sign(Det4D(px, py, pz, one,
+                               x[1], y[1], z[1], one,
+                               x[2], y[2], z[2], one,
+                               x[3], y[3], z[3], one));
+    Lanes4 d2 = det_sign(Det4D(x[0], y[0], z[0], one,
+                               px, py, pz, one,
+                               x[2], y[2], z[2], one,
+                               x[3], y[3], z[3], one));
+    Lanes4 d3 = det_sign(Det4D(x[0], y[0], z[0], one,
+                               x[1], y[1], z[1], one,
+                               px, py, pz, one,
+                               x[3], y[3], z[3], one));
+    Lanes4 d4 = det_sign(Det4D(x[0], y[0], z[0], one,
+                               x[1], y[1], z[1], one,
+                               x[2], y[2], z[2], one,
+                               px, py, pz, one));
+
+    Lanes4 inside = (Lanes4::cmp_eq(d1,orientation) | Lanes4::cmp_eq(d1,zero)) &
+                    (Lanes4::cmp_eq(d2,orientation) | Lanes4::cmp_eq(d2,zero)) &
+                    (Lanes4::cmp_eq(d3,orientation) | Lanes4::cmp_eq(d3,zero)) &
+                    (Lanes4::cmp_eq(d4,orientation) | Lanes4::cmp_eq(d4,zero));
+
+    return Lanes4::movemask(coincide | inside) & ((1 << num) - 1);
+}
+
+int Geometry_Wrapper::points_in_tetra_batch(int t_id, const double *x, const double *y, const double *z, int num, Mesh &mesh)
+{
+    Tetrahedron &tet = mesh.get_tetrahedron(t_id);
+    double c[4][3];
     for (int i = 0; i < 4; i++)
-        delete c[i];
-    delete c;
+    {
+        Vertex v = mesh.get_vertex(tet.TV(i));
+        c[i][0] = v.get_x();
+        c[i][1] = v.get_y();
+        c[i][2] = v.get_z();
+    }
 
-    return ret;
+    // the orientation depends only on the tetrahedron
+    int orientation = DetSign4D(c[0][0], c[0][1], c[0][2], 1,
+                                c[1][0], c[1][1], c[1][2], 1,
+                                c[2][0], c[2][1], c[2][2], 1,
+                                c[3][0], c[3][1], c[3][2], 1);
+
+    Lanes4 vx[4], vy[4], vz[4];
+    for(int v=0; v<4; v++)
+    {
+        vx[v] = Lanes4::set1(c[v][0]);
+        vy[v] = Lanes4::set1(c[v][1]);
+        vz[v] = Lanes4::set1(c[v][2]);
+    }
+    Lanes4 px = Lanes4::load(x);
+    Lanes4 py = Lanes4::load(y);
+    Lanes4 pz = Lanes4::load(z);
+    Lanes4 one = Lanes4::set1(1.0);
+    Lanes4 zero = Lanes4::set1(0.0);
+    Lanes4 orient = Lanes4::set1(orientation);
+
+    Lanes4 coincide = Lanes4::cmp_eq(px,vx[0]) & Lanes4::cmp_eq(py,vy[0]) & Lanes4::cmp_eq(pz,vz[0]);
+    for(int v=1; v<4; v++)
+        coincide = coincide | (Lanes4::cmp_eq(px,vx[v]) & Lanes4::cmp_eq(py,vy[v]) & Lanes4::cmp_eq(pz,vz[v]));
+
+    Lanes4 d1 = det_sign(Det4D(px, py, pz, one,
+                               vx[1], vy[1], vz[1], one,
+                               vx[2], vy[2], vz[2], one,
+                               vx[3], vy[3], vz[3], one));
+    Lanes4 d2 = det_sign(Det4D(vx[0], vy[0], vz[0], one,
+                               px, py, pz, one,
+                               vx[2], vy[2], vz[2], one,
+                               vx[3], vy[3], vz[3], one));
+    Lanes4 d3 = det_sign(Det4D(vx[0], vy[0], vz[0], one,
+                               vx[1], vy[1], vz[1], one,
+                               px, py, pz, one,
+                               vx[3], vy[3], vz[3], one));
+    Lanes4 d4 = det_sign(Det4D(vx[0], vy[0], vz[0], one,
+                               vx[1], vy[1], vz[1], one,
+                               vx[2], vy[2], vz[2], one,
+                               px, py, pz, one));
+
+    Lanes4 inside = (Lanes4::cmp_eq(d1,orient) | Lanes4::cmp_eq(d1,zero)) &
+                    (Lanes4::cmp_eq(d2,orient) | Lanes4::cmp_eq(d2,zero)) &
+                    (Lanes4::cmp_eq(d3,orient) | Lanes4::cmp_eq(d3,zero)) &
+                    (Lanes4::cmp_eq(d4,orient) | Lanes4::cmp_eq(d4,zero));
+
+    return Lanes4::movemask(coincide | inside) & ((1 << num) - 1);
 }
 
 bool Geometry_Wrapper::tetra_in_box_build(int t_id, Box& box, Mesh& mesh)
@@ -81,39 +185,72 @@ bool Geometry_Wrapper::tetra_in_box(int t_id, Box& box, Mesh& mesh)
 {
     Tetrahedron &t = mesh.get_tetrahedron(t_id);
 
-    // The library used only supports doubles, not doubles
-    double* minf = new double[3];
-    minf[0] = box.get_min().get_x(); minf[1] = box.get_min().get_y(); minf[2] = box.get_min().get_z();
-    double* maxf = new double[3];
-    maxf[0] = box.get_max().get_x(); maxf[1] = box.get_max().get_y(); maxf[2] = box.get_max().get_z();
+    double minf[3] = { box.get_min().get_x(), box.get_min().get_y(), box.get_min().get_z() };
+    double maxf[3] = { box.get_max().get_x(), box.get_max().get_y(), box.get_max().get_z() };
 
-    double **c;
-    c = new double* [4];
+    double c[4][3];
+    double *cp[4] = { c[0], c[1], c[2], c[3] };
     for (int i = 0; i < t.vertices_num(); i++)
     {
-        c[i] = new double[3];
-        Vertex& v = mesh.get_vertex(t.TV(i));
+        Vertex v = mesh.get_vertex(t.TV(i));
 
         c[i][0] = v.get_x();
         c[i][1] = v.get_y();
         c[i][2] = v.get_z();
     }
 
-    bool ret = false;
+    return tetra_in_box_strict(minf, maxf, cp);
+}
+
+int Geometry_Wrapper::tetra_in_box_batch(const int *t_ids, int num, Box& box, Mesh& mesh)
+{
+    double c[4][3][BATCH_SIZE];
+    Geometry_Wrapper::gather_batch(t_ids,num,mesh,c);
 
-    if(tetra_in_box_strict(minf, maxf, c))
-        ret = true;
+    double minf[3] = { box.get_min().get_x(), box.get_min().get_y(), box.get_min().get_z() };
+    double maxf[3] = { box.get_max().get_x(), box.get_max().get_y(), box.get_max().get_z() };
 
-    //DEALLOCAZIONE
-    delete minf;
-    delete maxf;
-    for (int i = 0; i < t.vertices_num(); i++) {
-        delete c[i];
+    // a lane with all the bits unset is a false mask
+    Lanes4 outside = Lanes4::set1(0.0);
+    Lanes4 vertex_inside[4];
+    for(int j=0; j<3; j++)
+    {
+        Lanes4 min_j = Lanes4::set1(minf[j]);
+        Lanes4 max_j = Lanes4::set1(maxf[j]);
+        Lanes4 all_below = Lanes4::cmp_eq(min_j,min_j);
+        Lanes4 all_above = all_below;
+        for(int v=0; v<4; v++)
+        {
+            Lanes4 cvj = Lanes4::load(c[v][j]);
+            all_below = all_below & Lanes4::cmp_le(cvj,min_j);
+            all_above = all_above & Lanes4::cmp_ge(cvj,max_j);
+            Lanes4 in_slab = Lanes4::cmp_lt(min_j,cvj) & Lanes4::cmp_lt(cvj,max_j);
+            vertex_inside[v] = (j == 0) ? in_slab : (vertex_inside[v] & in_slab);
+        }
+        // all the vertices are on the same side of the box
+        outside = outside | all_below | all_above;
     }
-    delete c;
-    //DEALLOCAZIONE
 
-    return ret;
+    int valid = (1 << num) - 1;
+    int rejected = Lanes4::movemask(outside);
+    int accepted = Lanes4::movemask(vertex_inside[0] | vertex_inside[1] | vertex_inside[2] | vertex_inside[3]) & ~rejected & valid;
+    int undecided = ~(rejected | accepted) & valid;
+
+    // the remaining tetrahedra are checked with the complete test
+    for(int l=0; l<num; l++)
+    {
+        if(undecided & (1 << l))
+        {
+            double cl[4][3];
+            double *cp[4] = { cl[0], cl[1], cl[2], cl[3] };
+            for(int v=0; v<4; v++)
+                for(int j=0; j<3; j++)
+                    cl[v][j] = c[v][j][l];
+            if(tetra_in_box_strict(minf, maxf, cp))
+                accepted |= (1 << l);
+        }
+    }
+    return accepted;
 }
 
 bool Geometry_Wrapper::line_in_box(const Point& v1, const Point& v2, Box& box)
@@ -260,7 +397,67 @@ void Geometry_Wrapper::set_face_orientation(Tetrahedron &tet, Mesh &mesh)
     cout<<Geometry_Wrapper::four_point_turn_wrapper(mesh.get_vertex(tet.TV(2)), mesh.get_vertex(tet.TV(1)), mesh.get_vertex(tet.TV(0)), mesh.get_vertex(tet.TV(3)))<<endl;
 }
 
+void Geometry_Wrapper::gather_batch(const int *t_ids, int num, Mesh &mesh, double c[4][3][BATCH_SIZE])
+{
+    // the lanes exceeding the batch replicate its last tetrahedron
+    for(int l=0; l<BATCH_SIZE; l++)
+    {
+        Tetrahedron &t = mesh.get_tetrahedron(t_ids[(l < num) ? l : num-1]);
+        for(int v=0; v<4; v++)
+        {
+            Vertex vert = mesh.get_vertex(t.TV(v));
+            c[v][0][l] = vert.get_x();
+            c[v][1][l] = vert.get_y();
+            c[v][2][l] = vert.get_z();
+        }
+    }
+}
+
+Lanes4 Geometry_Wrapper::det_sign(const Lanes4 &d)
+{
+    // same classification of DetSign4D
+    Lanes4 sign = Lanes4::blend(Lanes4::set1(-1.0),Lanes4::set1(1.0),Lanes4::cmp_gt(d,Lanes4::set1(0.0)));
+    return Lanes4::blend(sign,Lanes4::set1(0.0),Lanes4::cmp_le(Lanes4::abs(d),Lanes4::set1(ZERO)));
+}
+
 int Geometry_Wrapper::four_point_turn_wrapper(const Point &v0, const Point &v1, const Point &v2, const Point &op)
 {
     return FourPointTurn(op.get_x(), op.get_y(), op.get_z(), v0.get_x(), v0.get_y(), v0.get_z(), v1.get_x(), v1.get_y(), v1.get_z(), v2.get_x(), v2.get_y(), v2.get_z());
 }
+
+bool Geometry_Wrapper::get_run_bounding_box(vector<int>::iterator &id, Box& bb, Mesh &mesh, pair<int,int> &run)
+{
+    if(*id<0) //I have a run
+    {
+        run.first = abs(*id);
+        ++id;
+        run.second = run.first + *id;
+
+        double min_p[3]={std::numeric_limits<double>::max(),std::numeric_limits<double>::max(),std::numeric_limits<double>::max()};
+        double max_p[3]={-std::numeric_limits<double>::max(),-std::numeric_limits<double>::max(),-std::numeric_limits<double>::max()};
+
+        for(int t_id=run.first; t_id<=run.second; t_id++)
+        {
+            Tetrahedron &tet = mesh.get_tetrahedron(t_id);
+            for(int i=0; i<tet.vertices_num(); i++)
+            {
+                Vertex v = mesh.get_vertex(tet.TV(i));
+                for(int j=0;j<v.get_dimension();j++)
+                {
+                    if(v.get_c(j) < min_p[j])
+                        min_p[j] = v.get_c(j);
+                    if(v.get_c(j) > max_p[j])
+                        max_p[j] = v.get_c(j);
+                }
+            }
+        }
+        //save the computed bounding box
+        bb.set_min(min_p[0],min_p[1],min_p[2]);
+        bb.set_max(max_p[0],max_p[1],max_p[2]);
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
@@ -26,12 +26,16 @@
 
 #include "basic_types/mesh.h"
 #include "geometry.h"
+#include "simd_lanes.h"
 /**
  * @brief The Geometry_Wrapper class provides an interface for executing geometric tests for generating trees and answering queries
  */
 class Geometry_Wrapper : public Geometry
 {
 public:
+    ///the maximum number of tetrahedra tested together by the batched geometric tests
+    static const int BATCH_SIZE = Lanes4::SIZE;
+
     /**
      * @brief A public static method that computes the centroid of a tetrahedron
      *
@@ -49,6 +53,30 @@ public:
      * @return true if the point is contained in the tetrahedron, false otherwise
      */
     static bool point_in_tetra(int t_id, Point& point, Mesh &mesh);
+    /**
+     * @brief A public static method that computes the point-in-tetrahedron geometric test on a batch of tetrahedra
+     * The tests are executed together on the SIMD lanes (AVX2 or SSE2), and return the same results of point_in_tetra
+     *
+     * @param t_ids an array containing the position indexes of the tetrahedra
+     * @param num an integer representing the number of tetrahedra in the batch (from 1 to BATCH_SIZE)
+     * @param p a Point& representing the point to test
+     * @param mesh a Mesh&, the tetrahedral mesh
+     * @return an integer whose i-th bit is set if the point is contained in the i-th tetrahedron of the batch
+     */
+    static int point_in_tetra_batch(const int *t_ids, int num, Point& point, Mesh &mesh);
+    /**
+     * @brief A public static method that computes the point-in-tetrahedron geometric test for a batch of points
+     * The tests are executed together on the SIMD lanes (AVX2 or SSE2), and return the same results of point_in_tetra
+     *
+     * @param t_id an integer representing the position index of the tetrahedron
+     * @param x an array of BATCH_SIZE entries containing the x coordinates of the points
+     * @param y an array of BATCH_SIZE entries containing the y coordinates of the points
+     * @param z an array of BATCH_SIZE entries containing the z coordinates of the points
+     * @param num an integer representing the number of points in the batch (from 1 to BATCH_SIZE)
+     * @param mesh a Mesh&, the tetrahedral mesh
+     * @return an integer whose i-th bit is set if the i-th point of the batch is contained in the tetrahedron
+     */
+    static int points_in_tetra_batch(int t_id, const double *x, const double *y, const double *z, int num, Mesh &mesh);
     /**
      * @brief A public static method that computes the tetrahedron-in-box geometric test
      * NOTA: this procedure is used during the generation process of a tree.
@@ -72,6 +100,18 @@ public:
      * @return true if exists a real intersection between t_id and box, false otherwise
      */
     static bool tetra_in_box(int t_id, Box& box, Mesh& mesh);
+    /**
+     * @brief A public static method that computes the tetrahedron-in-box geometric test (as tetra_in_box) on a batch of tetrahedra
+     * The separating-axis rejection and the vertex-in-box acceptance are executed together on the SIMD lanes,
+     * while the tetrahedra not classified by these tests are checked one at a time
+     *
+     * @param t_ids an array containing the position indexes of the tetrahedra
+     * @param num an integer representing the number of tetrahedra in the batch (from 1 to BATCH_SIZE)
+     * @param box a Box& representing the box
+     * @param mesh a Mesh&, the tetrahedral mesh
+     * @return an integer whose i-th bit is set if the i-th tetrahedron of the batch has a real intersection with the box
+     */
+    static int tetra_in_box_batch(const int *t_ids, int num, Box& box, Mesh& mesh);
     /**
      * @brief A public static method that computes the line-in-box geometric tests
      * NOTA: the procedure is used to check if a line intersects the domain of a box node in the hierarchy
@@ -102,6 +142,17 @@ public:
      * @return true if the line intersects the tetrahedron, false otherwise
      */
     static bool line_in_tetra(const Point& v1, const Point& v2, int t_id, Mesh &mesh); // same algorithm without distance computation
+    /**
+     * @brief A public static method that computes the bounding box of a run of tetrahedra
+     * NOTA: a run is encoded in a tetrahedra array as a negative index followed by the number of the remaining tetrahedra in the run
+     *
+     * @param id an iterator to the current array entry (if a run is found, it is moved to the second entry of the run)
+     * @param bb a Box& argument, that is set with the run bounding box (if a run is found)
+     * @param mesh a Mesh&, the tetrahedral mesh
+     * @param run a pair that will contains the first and the last tetrahedron of the run, if any
+     * @return true if a run has been encounter, false otherwise
+     */
+    static bool get_run_bounding_box(vector<int>::iterator &id, Box& bb, Mesh &mesh, pair<int,int> &run);
     /**
      * @brief A public static method that reorder the triangular faces of the mesh tetrahedra
      *
@@ -115,6 +166,9 @@ private:
     //used in set_faces_ordering
     static void set_face_orientation(Tetrahedron &tet, Mesh &mesh);
     static int four_point_turn_wrapper(const Point &v0, const Point &v1, const Point &v2, const Point &op);
+    //used in the batched tests
+    static void gather_batch(const int *t_ids, int num, Mesh &mesh, double c[4][3][BATCH_SIZE]);
+    static Lanes4 det_sign(const Lanes4 &d);
 };
 
 #endif // GEOMETRY_WRAPPER_H
@@ -0,0 +1,205 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SIMD_LANES_H
+#define SIMD_LANES_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief A class representing four double-precision values processed together.
+ * The lanes are stored in a single AVX2 register, in two SSE2 registers or, if neither is available, in a plain array.
+ * Each operation is executed lane-wise, as the corresponding scalar operation, thus the results are bit-identical to the scalar code
+ * (as long as the compiler does not contract the multiplications and additions, see the -ffp-contract flag in the project file).
+ *
+ * The comparisons return a mask, encoded as a Lanes4 with all the bits of a lane set if the comparison holds for that lane.
+ */
+class Lanes4
+{
+public:
+    ///the number of lanes
+    static const int SIZE = 4;
+
+    ///A constructor method (the lanes are not initialized)
+    Lanes4() {}
+    /**
+     * @brief A public static method that loads four consecutive values
+     * @param p a pointer to the first value (no alignment is required)
+     * @return a Lanes4
+     */
+    static inline Lanes4 load(const double *p)
+    {
+        Lanes4 l;
+#if defined(__AVX2__)
+        l.v = _mm256_loadu_pd(p);
+#elif defined(__SSE2__)
+        l.lo = _mm_loadu_pd(p); l.hi = _mm_loadu_pd(p+2);
+#else
+        for(int i=0; i<SIZE; i++) l.v[i] = p[i];
+#endif
+        return l;
+    }
+    /**
+     * @brief A public static method that sets all the lanes to the same value
+     * @param d the value
+     * @return a Lanes4
+     */
+    static inline Lanes4 set1(double d)
+    {
+        Lanes4 l;
+#if defined(__AVX2__)
+        l.v = _mm256_set1_pd(d);
+#elif defined(__SSE2__)
+        l.lo = l.hi = _mm_set1_pd(d);
+#else
+        for(int i=0; i<SIZE; i++) l.v[i] = d;
+#endif
+        return l;
+    }
+
+    inline friend Lanes4 operator+(const Lanes4 &a, const Lanes4 &b) { return binary<ADD>(a,b); }
+    inline friend Lanes4 operator-(const Lanes4 &a, const Lanes4 &b) { return binary<SUB>(a,b); }
+    inline friend Lanes4 operator*(const Lanes4 &a, const Lanes4 &b) { return binary<MUL>(a,b); }
+    ///lane-wise bitwise and of two masks
+    inline friend Lanes4 operator&(const Lanes4 &a, const Lanes4 &b) { return binary<AND>(a,b); }
+    ///lane-wise bitwise or of two masks
+    inline friend Lanes4 operator|(const Lanes4 &a, const Lanes4 &b) { return binary<OR>(a,b); }
+
+    ///lane-wise absolute value
+    static inline Lanes4 abs(const Lanes4 &a) { return binary<ANDNOT>(set1(-0.0),a); }
+
+    static inline Lanes4 cmp_eq(const Lanes4 &a, const Lanes4 &b) { return binary<EQ>(a,b); }
+    static inline Lanes4 cmp_lt(const Lanes4 &a, const Lanes4 &b) { return binary<LT>(a,b); }
+    static inline Lanes4 cmp_le(const Lanes4 &a, const Lanes4 &b) { return binary<LE>(a,b); }
+    static inline Lanes4 cmp_gt(const Lanes4 &a, const Lanes4 &b) { return binary<LT>(b,a); }
+    static inline Lanes4 cmp_ge(const Lanes4 &a, const Lanes4 &b) { return binary<LE>(b,a); }
+
+    /**
+     * @brief A public static method that selects, lane by lane, between two values
+     * @param a the value returned where the mask is not set
+     * @param b the value returned where the mask is set
+     * @param mask the selection mask
+     * @return a Lanes4
+     */
+    static inline Lanes4 blend(const Lanes4 &a, const Lanes4 &b, const Lanes4 &mask)
+    {
+        return (binary<ANDNOT>(mask,a) | (mask & b));
+    }
+    /**
+     * @brief A public static method that compresses a mask into an integer
+     * @param mask the mask
+     * @return an integer whose i-th bit is set if the i-th lane of the mask is set
+     */
+    static inline int movemask(const Lanes4 &mask)
+    {
+#if defined(__AVX2__)
+        return _mm256_movemask_pd(mask.v);
+#elif defined(__SSE2__)
+        return _mm_movemask_pd(mask.lo) | (_mm_movemask_pd(mask.hi) << 2);
+#else
+        int m = 0;
+        for(int i=0; i<SIZE; i++)
+        {
+            uint64_t bits;
+            memcpy(&bits,&mask.v[i],sizeof(bits));
+            if(bits >> 63)
+                m |= (1 << i);
+        }
+        return m;
+#endif
+    }
+
+private:
+#if defined(__AVX2__)
+    __m256d v;
+#elif defined(__SSE2__)
+    __m128d lo, hi;
+#else
+    double v[SIZE];
+#endif
+
+    enum Operation { ADD, SUB, MUL, AND, OR, ANDNOT, EQ, LT, LE };
+
+    template<Operation O> static inline Lanes4 binary(const Lanes4 &a, const Lanes4 &b)
+    {
+        Lanes4 l;
+#if defined(__AVX2__)
+        switch(O)
+        {
+        case ADD:    l.v = _mm256_add_pd(a.v,b.v); break;
+        case SUB:    l.v = _mm256_sub_pd(a.v,b.v); break;
+        case MUL:    l.v = _mm256_mul_pd(a.v,b.v); break;
+        case AND:    l.v = _mm256_and_pd(a.v,b.v); break;
+        case OR:     l.v = _mm256_or_pd(a.v,b.v); break;
+        case ANDNOT: l.v = _mm256_andnot_pd(a.v,b.v); break;
+        case EQ:     l.v = _mm256_cmp_pd(a.v,b.v,_CMP_EQ_OQ); break;
+        case LT:     l.v = _mm256_cmp_pd(a.v,b.v,_CMP_LT_OQ); break;
+        case LE:     l.v = _mm256_cmp_pd(a.v,b.v,_CMP_LE_OQ); break;
+        }
+#elif defined(__SSE2__)
+        switch(O)
+        {
+        case ADD:    l.lo = _mm_add_pd(a.lo,b.lo);    l.hi = _mm_add_pd(a.hi,b.hi); break;
+        case SUB:    l.lo = _mm_sub_pd(a.lo,b.lo);    l.hi = _mm_sub_pd(a.hi,b.hi); break;
+        case MUL:    l.lo = _mm_mul_pd(a.lo,b.lo);    l.hi = _mm_mul_pd(a.hi,b.hi); break;
+        case AND:    l.lo = _mm_and_pd(a.lo,b.lo);    l.hi = _mm_and_pd(a.hi,b.hi); break;
+        case OR:     l.lo = _mm_or_pd(a.lo,b.lo);     l.hi = _mm_or_pd(a.hi,b.hi); break;
+        case ANDNOT: l.lo = _mm_andnot_pd(a.lo,b.lo); l.hi = _mm_andnot_pd(a.hi,b.hi); break;
+        case EQ:     l.lo = _mm_cmpeq_pd(a.lo,b.lo);  l.hi = _mm_cmpeq_pd(a.hi,b.hi); break;
+        case LT:     l.lo = _mm_cmplt_pd(a.lo,b.lo);  l.hi = _mm_cmplt_pd(a.hi,b.hi); break;
+        case LE:     l.lo = _mm_cmple_pd(a.lo,b.lo);  l.hi = _mm_cmple_pd(a.hi,b.hi); break;
+        }
+#else
+        for(int i=0; i<SIZE; i++)
+        {
+            uint64_t x, y, r = 0;
+            memcpy(&x,&a.v[i],sizeof(x));
+            memcpy(&y,&b.v[i],sizeof(y));
+            switch(O)
+            {
+            case ADD:    l.v[i] = a.v[i] + b.v[i]; continue;
+            case SUB:    l.v[i] = a.v[i] - b.v[i]; continue;
+            case MUL:    l.v[i] = a.v[i] * b.v[i]; continue;
+            case AND:    r = x & y; break;
+            case OR:     r = x | y; break;
+            case ANDNOT: r = ~x & y; break;
+            case EQ:     r = (a.v[i] == b.v[i]) ? ~uint64_t(0) : 0; break;
+            case LT:     r = (a.v[i] <  b.v[i]) ? ~uint64_t(0) : 0; break;
+            case LE:     r = (a.v[i] <= b.v[i]) ? ~uint64_t(0) : 0; break;
+            }
+            memcpy(&l.v[i],&r,sizeof(r));
+        }
+#endif
+        return l;
+    }
+};
+
+#endif // SIMD_LANES_H
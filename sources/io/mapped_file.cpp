@@ -21,22 +21,48 @@
     along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "kd_subdivision.h"
 
-Box KD_Subdivision::compute_domain(Box& parent_dom, int level, int child_ind)
-{
-    int coord_to_change = level % 3; // 3D
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-    Box sonDom = parent_dom;
+bool Mapped_File::open(string path)
+{
+    this->close();
 
-    if(child_ind == 1)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
     {
-        sonDom.get_min().set_c(coord_to_change,parent_dom.get_min().get_c(coord_to_change)+(parent_dom.get_max().get_c(coord_to_change)-parent_dom.get_min().get_c(coord_to_change))/2.0);
+        ::close(fd);
+        return false;
     }
-    else if(child_ind == 0)
+    if (file_stat.st_size > 0)
     {
-        sonDom.get_max().set_c(coord_to_change,parent_dom.get_min().get_c(coord_to_change)+(parent_dom.get_max().get_c(coord_to_change)-parent_dom.get_min().get_c(coord_to_change))/2.0);
+        void *mapped = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+        // the file is read sequentially
+        madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+        this->data = static_cast<const char*>(mapped);
+        this->size = file_stat.st_size;
     }
+    ::close(fd);
+    return true;
+}
 
-    return sonDom;
+void Mapped_File::close()
+{
+    if (this->data != NULL)
+        munmap(const_cast<char*>(this->data), this->size);
+    this->data = NULL;
+    this->size = 0;
 }
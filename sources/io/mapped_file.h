@@ -0,0 +1,69 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief A class representing a read-only file mapped in memory.
+ * The file is unmapped when the object is destroyed.
+ */
+class Mapped_File
+{
+public:
+    ///A constructor method
+    Mapped_File() { this->data = NULL; this->size = 0; }
+    ///A destructor method
+    ~Mapped_File() { this->close(); }
+    /**
+     * @brief A public method that maps a file in memory
+     * An empty file is opened without mapping it (and get_data returns NULL).
+     *
+     * @param path a string argument, representing the path to the file
+     * @return true if the file has been mapped, false otherwise
+     */
+    bool open(string path);
+    /**
+     * @brief A public method that unmaps the file
+     */
+    void close();
+    ///A public method that returns the beginning of the mapped file
+    inline const char* get_data() const { return this->data; }
+    ///A public method that returns the size of the mapped file in bytes
+    inline size_t get_size() const { return this->size; }
+
+private:
+    const char* data;
+    size_t size;
+
+    Mapped_File(const Mapped_File&);
+    Mapped_File& operator=(const Mapped_File&);
+};
+
+#endif // MAPPED_FILE_H
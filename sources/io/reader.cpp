@@ -26,62 +26,203 @@
 #include <algorithm>
 #include "geometry/geometry_wrapper.h"
 
-bool Reader::read_mesh(Mesh& mesh, string path)
+#include <cstring>
+#include <climits>
+#include <charconv>
+#include "mapped_file.h"
+#include "utilities/thread_pool.h"
+#include "tetrahedral_trees/ok_subdivision.h"
+#include "tetrahedral_trees/kd_subdivision.h"
+
+// the characters skipped by the extraction operator of the streams
+static inline bool is_blank(char c) { return (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'); }
+
+// parses a whole token, accepting a leading '+' as the extraction operator of the streams does
+template<class T> static inline bool parse_token(const char *begin, const char *end, T &value)
+{
+    if (begin != end && *begin == '+')
+        ++begin;
+    std::from_chars_result res = std::from_chars(begin, end, value);
+    return (res.ec == std::errc() && res.ptr == end);
+}
+
+// returns the number of tokens in a chunk (that starts with a blank character or at the beginning of the body)
+static long count_tokens(const char *begin, const char *end)
+{
+    long count = 0;
+    bool prev_blank = true;
+    for (const char *c = begin; c != end; ++c)
+    {
+        bool blank = is_blank(*c);
+        if (!blank && prev_blank)
+            count++;
+        prev_blank = blank;
+    }
+    return count;
+}
+
+// the bounds of the coordinates parsed by a chunk
+struct Chunk_Bounds
+{
+    double min[3], max[3];
+    bool set[3];
+
+    Chunk_Bounds()
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            min[c] = max[c] = 0;
+            set[c] = false;
+        }
+    }
+    inline void update(int c, double value)
+    {
+        if (!set[c])
+        {
+            min[c] = max[c] = value;
+            set[c] = true;
+        }
+        else if (value < min[c])
+            min[c] = value;
+        else if (value > max[c])
+            max[c] = value;
+    }
+};
+
+// parses the tokens of a chunk, the first one being the first_token-th of the body
+static bool parse_mesh_chunk(const char *begin, const char *end, long first_token, Mesh &mesh, Chunk_Bounds &bounds)
 {
-    ifstream input(path.c_str());
+    long vertices_tokens = 4L * mesh.get_num_vertices();
+    long all_tokens = vertices_tokens + 4L * mesh.get_num_tetrahedra();
+    long token = first_token;
+    const char *c = begin;
+    while (token < all_tokens)
+    {
+        while (c != end && is_blank(*c))
+            ++c;
+        if (c == end)
+            break;
+        const char *token_end = c;
+        while (token_end != end && !is_blank(*token_end))
+            ++token_end;
 
-    if (input.is_open() == false) {
+        if (token < vertices_tokens)
+        {
+            double value;
+            if (!parse_token(c, token_end, value))
+                return false;
+            int v = token / 4 + 1;
+            int pos = token % 4;
+            if (pos < 3)
+            {
+                // the domain bounds the stored coordinates (that may be rounded, see mesh_coord)
+                mesh.set_vertex_c(v, pos, value);
+                bounds.update(pos, mesh.get_vertex_c(v, pos));
+            }
+            else
+                mesh.set_vertex_field(v, value);
+        }
+        else
+        {
+            int index;
+            if (!parse_token(c, token_end, index))
+                return false;
+            mesh.get_tetrahedron((token - vertices_tokens) / 4 + 1).setTV((token - vertices_tokens) % 4, index + 1);
+        }
+        token++;
+        c = token_end;
+    }
+    return true;
+}
+
+bool Reader::read_mesh(Mesh& mesh, string path, int threads_num)
+{
+    Mapped_File file;
+    if (!file.open(path)) {
         cerr << "Error in file " << path << "\nThe file could not exist, be unreadable or incorrect." << endl;
         return false;
     }
+    const char *begin = file.get_data();
+    const char *end = begin + file.get_size();
 
-    string line;
-    getline(input, line);
-    int tpos = line.find_first_of(' ');
+    const char *body = std::find(begin, end, '\n');
+    string line(begin, body);
+    size_t tpos = line.find_first_of(' ');
 
     int num_vertices = atoi(line.substr(0, tpos).c_str());
-    int num_tetrahedra = atoi(line.substr(tpos).c_str());
+    int num_tetrahedra = (tpos == string::npos) ? 0 : atoi(line.substr(tpos).c_str());
 
-    if (num_vertices == 0 || num_tetrahedra == 0)
+    if (num_vertices <= 0 || num_tetrahedra <= 0)
     {
         cerr << "This is not a valid .ts file: " << path << endl;
         return false;
     }
 
-    mesh.reserve(num_vertices, num_tetrahedra);
-
-    double x, y, z, field;
-    //legge i vertici aggiustando il dominio..
-    for (int i = 0; i < num_vertices; i++)
+    // the body is splitted in chunks, whose boundaries are moved forward to a blank character, so that no token is splitted
+    const long min_chunk_size = 1 << 20;
+    long chunks_num = std::min<long>(4L * threads_num, std::max<long>(1, (end - body) / min_chunk_size));
+    vector<const char*> chunks(chunks_num + 1);
+    chunks[0] = body;
+    chunks[chunks_num] = end;
+    for (long k = 1; k < chunks_num; k++)
     {
-        input >> x;
-        input >> y;
-        input >> z;
-        input >> field;
-        if (input.eof())
-            break;
+        const char *c = std::max(body + (end - body) / chunks_num * k, chunks[k-1]);
+        while (c != end && !is_blank(*c))
+            ++c;
+        chunks[k] = c;
+    }
 
-        Vertex v = Vertex(x, y, z, field);
-        mesh.add_vertex(v);
-        if (i == 0) {
-            Box b = Box(v, v);
-            mesh.set_domain(b);
-        } else {
-            mesh.get_domain().resize(v);
-        }
+    Thread_Pool pool(threads_num);
+
+    // first, we count the tokens of each chunk to find the entry they refer to
+    vector<long> first_tokens(chunks_num + 1, 0);
+    for (long k = 0; k < chunks_num; k++)
+        pool.submit([&, k]() { first_tokens[k+1] = count_tokens(chunks[k], chunks[k+1]); });
+    pool.wait();
+    for (long k = 0; k < chunks_num; k++)
+        first_tokens[k+1] += first_tokens[k];
+
+    if (first_tokens[chunks_num] < 4L * num_vertices + 4L * num_tetrahedra)
+    {
+        cerr << "This is not a valid .ts file: " << path << endl;
+        return false;
     }
 
-    int v[4];
-    for (int i = 0; i < num_tetrahedra; i++)
+    // then, each chunk is parsed directly into the mesh arrays
+    mesh.resize(num_vertices, num_tetrahedra);
+    vector<Chunk_Bounds> bounds(chunks_num);
+    vector<char> parsed(chunks_num, 0);
+    for (long k = 0; k < chunks_num; k++)
+        pool.submit([&, k]() { parsed[k] = parse_mesh_chunk(chunks[k], chunks[k+1], first_tokens[k], mesh, bounds[k]); });
+    pool.wait();
+
+    Chunk_Bounds domain;
+    for (long k = 0; k < chunks_num; k++)
     {
-        for (int j = 0; j < 4; j++) {
-            int index;
-            input >> index;
-            v[j] = index+1;
+        if (!parsed[k])
+        {
+            cerr << "This is not a valid .ts file: " << path << endl;
+            return false;
         }
-        Tetrahedron t = Tetrahedron(v[0], v[1], v[2], v[3]);
-        mesh.add_tetrahedron(t);
+        for (int c = 0; c < 3; c++)
+        {
+            if (bounds[k].set[c])
+            {
+                domain.update(c, bounds[k].min[c]);
+                domain.update(c, bounds[k].max[c]);
+            }
+        }
+    }
+    // the domain is set by the coordinates of the vertices, thus it is undefined without them
+    if (!domain.set[0] || !domain.set[1] || !domain.set[2])
+    {
+        cerr << "This is not a valid .ts file: " << path << endl;
+        return false;
     }
+    Point min = Point(domain.min[0], domain.min[1], domain.min[2]);
+    Point max = Point(domain.max[0], domain.max[1], domain.max[2]);
+    Box b = Box(min, max);
+    mesh.set_domain(b);
 
     return true;
 }
@@ -174,3 +315,180 @@ void Reader::read_leaf(Node_V *n, ifstream &input, vector<string>& tokens)
             n->add_tetrahedron(atoi(tokens3.at(i).c_str()));
     }
 }
+
+// checks that the vertices of the tetrahedra (negative for the border faces) are in [1, vertices_num]
+static bool valid_snapshot_tetrahedra(const int *t_vertices, uint64_t tetrahedra_num, uint64_t vertices_num)
+{
+    for (uint64_t i = 0; i < 4 * tetrahedra_num; i++)
+    {
+        int64_t v = std::abs(static_cast<int64_t>(t_vertices[i]));
+        if (v < 1 || static_cast<uint64_t>(v) > vertices_num)
+            return false;
+    }
+    return true;
+}
+
+// checks, in a single pass on each array, that all the positions, ranks, offsets and indices of a frozen layout are in range
+static bool valid_snapshot_layout(Frozen_Layout &layout, int son_number, uint64_t vertices_num, uint64_t tetrahedra_num)
+{
+    int nodes_num = layout.get_nodes_num(), leaves_num = layout.get_leaves_num();
+    int_vect &sons = layout.get_sons(), &leaf_begins = layout.get_leaf_begins(), &leaf_ends = layout.get_leaf_ends();
+    for (int i = 0; i < nodes_num; i++)
+    {
+        // the sons block follows its father, and it is entirely stored
+        if (sons[i] != -1 && (sons[i] <= i || sons[i] > nodes_num - son_number))
+            return false;
+        if (leaf_begins[i] < 0 || leaf_begins[i] > leaf_ends[i] || leaf_ends[i] > leaves_num)
+            return false;
+    }
+
+    int_vect &leaves = layout.get_leaves(), &v_starts = layout.get_v_starts(), &v_ends = layout.get_v_ends();
+    // a leaf has its own rank, whose entries are read from the arrays indexed by the leaves
+    for (int i = 0; i < nodes_num; i++)
+    {
+        if (sons[i] == -1 && (leaf_begins[i] == leaves_num || leaves[leaf_begins[i]] != i))
+            return false;
+    }
+    for (int k = 0; k < leaves_num; k++)
+    {
+        if (leaves[k] < 0 || leaves[k] >= nodes_num)
+            return false;
+        if (v_starts[k] < 0 || v_starts[k] > v_ends[k] || static_cast<uint64_t>(v_ends[k]) > vertices_num + 1)
+            return false;
+    }
+
+    int_vect &t_offsets = layout.get_t_offsets(), &r_offsets = layout.get_r_offsets(), &tetrahedra = layout.get_tetrahedra();
+    if (t_offsets[0] != 0 || r_offsets[0] != 0 || t_offsets[leaves_num] != (int)tetrahedra.size() || r_offsets[leaves_num] != (int)layout.get_run_bboxes().size())
+        return false;
+    for (int k = 0; k < leaves_num; k++)
+    {
+        if (t_offsets[k] > t_offsets[k+1] || r_offsets[k] > r_offsets[k+1])
+            return false;
+        // the tetrahedra are in [1, tetrahedra_num], and a run (-start, count) is entirely contained in the leaf array and in the mesh
+        int runs_num = 0;
+        for (int i = t_offsets[k]; i < t_offsets[k+1]; i++)
+        {
+            int64_t t = tetrahedra[i];
+            if (t < 0)
+            {
+                if (i + 1 == t_offsets[k+1] || tetrahedra[i+1] < 0 || static_cast<uint64_t>(-t + tetrahedra[i+1]) > tetrahedra_num)
+                    return false;
+                runs_num++;
+                i++;
+            }
+            else if (t == 0 || static_cast<uint64_t>(t) > tetrahedra_num)
+                return false;
+        }
+        // the stored run bounding boxes, if any, are one for each run
+        if (r_offsets[k] != r_offsets[k+1] && r_offsets[k+1] - r_offsets[k] != runs_num)
+            return false;
+    }
+    return true;
+}
+
+bool Reader::read_snapshot(string path, Mesh &mesh, Frozen_Layout &layout, snapshot::Info &info)
+{
+    Mapped_File file;
+    if (!file.open(path))
+    {
+        cerr << "Error in file " << path << "\nThe file could not exist, be unreadable or incorrect." << endl;
+        return false;
+    }
+    uint64_t file_size = file.get_size();
+    if (file_size < sizeof(snapshot::Header))
+    {
+        cerr << "This is not a valid snapshot file: " << path << endl;
+        return false;
+    }
+    const char *base = file.get_data();
+
+    snapshot::Header header;
+    memcpy(&header, base, sizeof(header));
+    string error;
+    if (memcmp(header.magic, snapshot::MAGIC, sizeof(header.magic)) != 0)
+        error = "This is not a valid snapshot file";
+    else if (header.version != snapshot::VERSION)
+        error = "Unsupported snapshot version";
+    else if (header.byte_order != snapshot::BYTE_ORDER_MARK)
+        error = "The snapshot has been written with a different byte order";
+    else if (header.run_coord_size != sizeof(run_coord))
+        error = "The snapshot has been written with a different precision of the run bounding boxes";
+    else if (header.mesh_coord_size != sizeof(mesh_coord))
+        error = "The snapshot has been written with a different precision of the mesh coordinates";
+    else
+    {
+        const uint64_t entry_sizes[snapshot::SECTIONS_NUM] = { 4*sizeof(double), 4*sizeof(int), sizeof(int), sizeof(int), sizeof(int), sizeof(int), sizeof(int),
+                                                               sizeof(int), sizeof(int), sizeof(Run_Bounding_Box), sizeof(int), sizeof(int) };
+        for(int s=0; s<snapshot::SECTIONS_NUM; s++)
+        {
+            const snapshot::Section_Entry &entry = header.sections[s];
+            if (entry.offset % snapshot::ALIGNMENT != 0 || entry.offset > file_size || entry.count > (file_size - entry.offset) / entry_sizes[s])
+                error = "The snapshot file is truncated or corrupted";
+        }
+    }
+    if (error.empty())
+    {
+        //the sizes of the layout arrays must be coherent (see Frozen_Layout)
+        const snapshot::Section_Entry *sec = header.sections;
+        uint64_t nodes_num = sec[snapshot::SONS].count, leaves_num = sec[snapshot::LEAVES].count;
+        if (nodes_num == 0 || sec[snapshot::LEAF_BEGINS].count != nodes_num || sec[snapshot::LEAF_ENDS].count != nodes_num ||
+            sec[snapshot::T_OFFSETS].count != leaves_num+1 || sec[snapshot::R_OFFSETS].count != leaves_num+1 ||
+            sec[snapshot::V_STARTS].count != leaves_num || sec[snapshot::V_ENDS].count != leaves_num)
+            error = "The snapshot file is corrupted";
+    }
+    if (!error.empty())
+    {
+        cerr << error << ": " << path << endl;
+        return false;
+    }
+
+    info.division_type = string(header.division, strnlen(header.division, sizeof(header.division)));
+    info.crit_type = string(header.criterion, strnlen(header.criterion, sizeof(header.criterion)));
+    info.vertices_per_leaf = header.vertices_per_leaf;
+    info.tetrahedra_per_leaf = header.tetrahedra_per_leaf;
+    info.reindexed = (header.reindexed != 0);
+
+    read_section(base, header.sections[snapshot::SONS], layout.get_sons());
+    read_section(base, header.sections[snapshot::LEAF_BEGINS], layout.get_leaf_begins());
+    read_section(base, header.sections[snapshot::LEAF_ENDS], layout.get_leaf_ends());
+    read_section(base, header.sections[snapshot::LEAVES], layout.get_leaves());
+    read_section(base, header.sections[snapshot::T_OFFSETS], layout.get_t_offsets());
+    read_section(base, header.sections[snapshot::LEAF_TETRAHEDRA], layout.get_tetrahedra());
+    read_section(base, header.sections[snapshot::R_OFFSETS], layout.get_r_offsets());
+    read_section(base, header.sections[snapshot::RUN_BBOXES], layout.get_run_bboxes());
+    read_section(base, header.sections[snapshot::V_STARTS], layout.get_v_starts());
+    read_section(base, header.sections[snapshot::V_ENDS], layout.get_v_ends());
+
+    // the frozen nodes follow the stored positions without any check, thus a corrupted entry is rejected here
+    const snapshot::Section_Entry &vertices = header.sections[snapshot::VERTICES];
+    const snapshot::Section_Entry &tetrahedra = header.sections[snapshot::TETRAHEDRA];
+    const int *t_vertices = reinterpret_cast<const int*>(base + tetrahedra.offset);
+    int son_number = (info.division_type == "ok") ? OK_Subdivision::SON_NUMBER : (info.division_type == "kd") ? KD_Subdivision::SON_NUMBER : 0;
+    if (son_number == 0 || vertices.count > INT_MAX || tetrahedra.count > INT_MAX ||
+        !valid_snapshot_tetrahedra(t_vertices, tetrahedra.count, vertices.count) ||
+        !valid_snapshot_layout(layout, son_number, vertices.count, tetrahedra.count))
+    {
+        Frozen_Layout().swap(layout);
+        cerr << "The snapshot file is corrupted: " << path << endl;
+        return false;
+    }
+
+    // the tetrahedra section has the layout of the tetrahedra array, while the interleaved vertices are split in the coordinates arrays
+    mesh.resize(vertices.count, tetrahedra.count);
+    memcpy(mesh.get_tetrahedra_data(), t_vertices, tetrahedra.count * sizeof(Tetrahedron));
+    const double *coords = reinterpret_cast<const double*>(base + vertices.offset);
+    mesh_coord *xs = mesh.get_coords_data(0), *ys = mesh.get_coords_data(1), *zs = mesh.get_coords_data(2);
+    double *fields = mesh.get_fields_data();
+    for (uint64_t i = 0; i < vertices.count; i++, coords += 4)
+    {
+        xs[i] = coords[0];
+        ys[i] = coords[1];
+        zs[i] = coords[2];
+        fields[i] = coords[3];
+    }
+    Point min = Point(header.domain[0], header.domain[1], header.domain[2]);
+    Point max = Point(header.domain[3], header.domain[4], header.domain[5]);
+    Box domain = Box(min, max);
+    mesh.set_domain(domain);
+    return true;
+}
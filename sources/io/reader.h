@@ -38,6 +38,8 @@
 #include "basic_types/mesh.h"
 #include "tetrahedral_trees/node_v.h"
 #include "tetrahedral_trees/node_t.h"
+#include "tetrahedral_trees/frozen_node.h"
+#include "snapshot.h"
 
 using namespace std;
 ///A class that provides an interface for reading input-file and initializite the library structures
@@ -45,11 +47,26 @@ class Reader {
 public:
     ///A public method that reads a file containing a tetrahedral mesh
     /*!
+     * The file is mapped in memory and splitted in chunks, that are parsed in parallel directly into the mesh arrays.
+     * The mesh obtained is the same obtained by reading the file sequentially with the extraction operator.
+     *
      * \param mesh a Mesh& argument, representing the mesh to initialize
      * \param path a string argument, representing the path to the mesh file
+     * \param threads_num an integer argument, representing the number of threads used
      * \return a boolean value, true if the file is correctly readed, false otherwise
      */
-    static bool read_mesh(Mesh& mesh, string path);
+    static bool read_mesh(Mesh& mesh, string path, int threads_num);
+    ///A public method that loads a binary snapshot of a frozen tree and of its mesh
+    /*!
+     * The file is mapped in memory, validated and its arrays are copied in the mesh and in the layout, without parsing (see snapshot.h).
+     *
+     * \param path a string argument, representing the path to the snapshot file
+     * \param mesh a Mesh& argument, representing the (empty) mesh to initialize
+     * \param layout a Frozen_Layout& argument, representing the (empty) layout to initialize
+     * \param info a snapshot::Info& argument, that is set with the parameters of the tree
+     * \return a boolean value, true if the file is correctly loaded, false otherwise
+     */
+    static bool read_snapshot(string path, Mesh& mesh, Frozen_Layout& layout, snapshot::Info& info);
     ///A public method that reads a file containing a list of points coordinate used into a point location
     /*!
      * \param points a vector<Point>& argument, representing the point list to initialize
@@ -79,12 +96,11 @@ private:
     virtual ~Reader() {}
     ///A private method that reads a node into the file and saves the information readed (Generic Version)
     /*!
+     * \param tree a T& argument, representing the tree (allocating the sons of an internal node)
      * \param n a N* argument, representing the empty node to be set
      * \param input an ifstream& argument, representing the stream to read
-     * \param son_number an integer argument, representing the number of son every internal node has
-     * \param mesh a Mesh& argument, representing the tetrahedral mesh
      */
-    template<class N> static void read_node(N* n, ifstream& input, int son_number, Mesh& mesh);
+    template<class T, class N> static void read_node(T& tree, N* n, ifstream& input);
     ///A protected method that reads a leaf into the file and saves the information readed
     /*!
      * \param n a Node_T* argument, representing the empty node to be set
@@ -99,6 +115,17 @@ private:
      * \param tokens a vector<string>& argument, representing the a row of the file
      */
     static void read_leaf(Node_V* n, ifstream& input, vector<string>& tokens);
+    ///A private method that copies a section of a mapped snapshot into an array
+    /*!
+     * \param base a const char* argument, pointing to the mapped file
+     * \param entry a const snapshot::Section_Entry& argument, representing the section
+     * \param array a vector<T>& argument, that is set with the section entries
+     */
+    template<class T> static void read_section(const char* base, const snapshot::Section_Entry& entry, vector<T>& array)
+    {
+        const T* data = reinterpret_cast<const T*>(base + entry.offset);
+        array.assign(data, data + entry.count);
+    }
 };
 
 template<class T, class N> bool Reader::read_tree(T& tree, N& root, string fileName)
@@ -121,16 +148,12 @@ template<class T, class N> bool Reader::read_tree(T& tree, N& root, string fileN
         current = coda.front();
         coda.pop();
 
-        Reader::read_node(current,input,tree.get_decomposition().son_number(), tree.get_mesh());
+        Reader::read_node(tree,current,input);
 
         if (!current->is_leaf())
         {
             for (int i = 0; i < tree.get_decomposition().son_number(); i++)
-            {
-                N* s = new N();
-                current->set_son(s, i);
                 coda.push(current->get_son(i));
-            }
         }
 
         if (input.eof() || coda.empty())
@@ -139,7 +162,7 @@ template<class T, class N> bool Reader::read_tree(T& tree, N& root, string fileN
     return true;
 }
 
-template<class N> void Reader::read_node(N* n, ifstream &input, int son_number, Mesh&)
+template<class T, class N> void Reader::read_node(T& tree, N* n, ifstream &input)
 {
     string line;
     vector<string> tokens;
@@ -149,7 +172,7 @@ template<class N> void Reader::read_node(N* n, ifstream &input, int son_number,
 
     if (tokens.at(0) == "N")
     {
-        n->init_sons(son_number);
+        tree.init_sons(*n);
     }
     else if (tokens.at(0) == "L")
     {
@@ -0,0 +1,69 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RELATIONS_H
+#define RELATIONS_H
+
+#include <cstdint>
+#include "snapshot.h"
+
+/**
+ * @brief The binary format of the topological relations (VT_Relation and TT_Relation) extracted from a mesh.
+ * As a snapshot, a relation file starts with a fixed-size header, followed by the sections containing the plain int32 arrays
+ * of the relation, aligned at snapshot::ALIGNMENT bytes and stored in native byte order.
+ * Thus, a solver can map the file in memory and use the arrays as they are.
+ * The position indices of the vertices and of the tetrahedra start from 1, as in the mesh.
+ */
+namespace relations
+{
+    ///the magic string at the beginning of a relation file
+    const char MAGIC[8] = {'T','T','R','E','L','\0','\0','\0'};
+    ///the current version of the format
+    const uint32_t VERSION = 1;
+
+    ///the encoded relations
+    enum Relation { VT = 1,     ///< sections: the CSR offsets (vertices_num+1 entries) and the incident tetrahedra
+                    TT = 2 };   ///< sections: four adjacent tetrahedra per tetrahedron (-1 on the boundary faces)
+
+    ///the sections of a relation file, in the order in which they are written
+    enum Section { OFFSETS, ENTRIES, SECTIONS_NUM };
+
+    ///the header of a relation file
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        ///the byte order mark (snapshot::BYTE_ORDER_MARK), as written by the current machine
+        uint32_t byte_order;
+        uint32_t relation;
+        ///the number of entries per element in the ENTRIES section (4 for TT, 0 for the variable-length VT)
+        uint32_t entries_per_element;
+        ///the number of encoded elements (vertices for VT, tetrahedra for TT)
+        uint64_t elements_num;
+        ///the sections of the relation (the OFFSETS section is empty for TT)
+        snapshot::Section_Entry sections[SECTIONS_NUM];
+    };
+}
+
+#endif // RELATIONS_H
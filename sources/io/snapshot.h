@@ -0,0 +1,112 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief The binary snapshot format of a frozen Tetrahedral tree and of its mesh.
+ * A snapshot starts with a fixed-size header, followed by a series of sections, each one containing a plain array.
+ * The sections start at offsets multiple of ALIGNMENT, and are described in the header by their offset and their number of entries.
+ * The arrays are stored with the same binary representation used in memory (native byte order), thus loading a snapshot
+ * only requires to map the file in memory and to copy the arrays, without any parsing.
+ * The header contains a format version and a byte order mark: a snapshot written with a different version, byte order
+ * or precision of the mesh coordinates (see MESH_COORDS_FLOAT) and of the run bounding boxes (see RUN_BBOX_FLOAT) is rejected.
+ */
+namespace snapshot
+{
+    ///the magic string at the beginning of a snapshot file
+    const char MAGIC[8] = {'T','T','S','N','A','P','\0','\0'};
+    ///the current version of the format
+    const uint32_t VERSION = 2;
+    ///the byte order mark, as written by the current machine
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    ///the alignment of the sections
+    const uint64_t ALIGNMENT = 64;
+
+    ///the sections of a snapshot, in the order in which they are written
+    enum Section { VERTICES,        ///< four doubles per vertex (coordinates and field value)
+                   TETRAHEDRA,      ///< four int32 per tetrahedron (the vertices, negative for the border faces)
+                   SONS,            ///< the Frozen_Layout arrays indexed by node position (int32)
+                   LEAF_BEGINS,
+                   LEAF_ENDS,
+                   LEAVES,          ///< the Frozen_Layout arrays indexed by leaf rank (int32)
+                   T_OFFSETS,
+                   LEAF_TETRAHEDRA,
+                   R_OFFSETS,
+                   RUN_BBOXES,      ///< the stored run bounding boxes (Run_Bounding_Box)
+                   V_STARTS,
+                   V_ENDS,
+                   SECTIONS_NUM };
+
+    ///the position and the number of entries of a section
+    struct Section_Entry
+    {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    ///the header of a snapshot file
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        ///the division type (ok or kd) and the criterion type (pr, pm, pm2 or pmr), null-terminated
+        char division[4];
+        char criterion[4];
+        int32_t vertices_per_leaf;
+        int32_t tetrahedra_per_leaf;
+        ///1 if the tree and the mesh have been reindexed
+        uint32_t reindexed;
+        ///the size of a coordinate of the stored run bounding boxes
+        uint32_t run_coord_size;
+        ///the size of a stored coordinate of the mesh vertices (the VERTICES section always contains doubles)
+        uint32_t mesh_coord_size;
+        ///the mesh domain (minimum and maximum)
+        double domain[6];
+        Section_Entry sections[SECTIONS_NUM];
+    };
+
+    /**
+     * @brief The parameters of the tree encoded in a snapshot
+     */
+    struct Info
+    {
+        string division_type;
+        string crit_type;
+        int vertices_per_leaf;
+        int tetrahedra_per_leaf;
+        bool reindexed;
+
+        Info() { vertices_per_leaf = -1; tetrahedra_per_leaf = -1; reindexed = false; }
+    };
+}
+
+#endif // SNAPSHOT_H
@@ -24,6 +24,7 @@
 #include "tetrahedral_trees/node.h"
 #include "basic_types/mesh.h"
 #include "writer.h"
+#include <cstring>
 
 void Writer::write_node(ofstream& output, Node_T *n)
 {
@@ -92,6 +93,17 @@ void Writer::write_tree_stats(IndexStatistics& indexStats)
     cout << "chi_star " << indexStats.avg_weighted_leaves_for_tetra << endl;
     cout << "t_list_length " << indexStats.t_list_length << endl;
     cout << "real_t_list_length " << indexStats.real_t_list_length << endl;
+    // memory footprint, in bytes
+    size_t index_bytes = indexStats.nodes_bytes + indexStats.t_arrays_bytes + indexStats.v_arrays_bytes + indexStats.run_bboxes_bytes;
+    cout << "bytes_nodes " << indexStats.nodes_bytes << " (arena reserved " << indexStats.arena_bytes << ")" << endl;
+    cout << "bytes_t_arrays " << indexStats.t_arrays_bytes << " (compressed " << indexStats.t_list_length * sizeof(int)
+         << ", expanded " << indexStats.real_t_list_length * sizeof(int) << ")" << endl;
+    cout << "bytes_v_arrays " << indexStats.v_arrays_bytes << endl;
+    cout << "bytes_run_bboxes " << indexStats.run_bboxes_bytes << endl;
+    cout << "bytes_index " << index_bytes << endl;
+    cout << "bytes_mesh " << indexStats.mesh_vertices_bytes + indexStats.mesh_tetrahedra_bytes << " (vertices " << indexStats.mesh_vertices_bytes
+         << ", tetrahedra " << indexStats.mesh_tetrahedra_bytes << ")" << endl;
+    cout << "bytes_query_structures " << indexStats.query_bytes << " (per thread)" << endl;
     return;
 }
 
@@ -190,6 +202,65 @@ void Writer::write_queries_stats(int size, FullQueryStatistics& fullQueryStats,
 
 }
 
+bool Writer::write_latency_stats(string query_name, Latency_Histogram& histogram, string fileName)
+{
+    const int PERCENTILES_NUM = 5;
+    const double percentiles[PERCENTILES_NUM] = { 50, 90, 99, 99.9, 100 };
+    const char* names[PERCENTILES_NUM] = { "p50", "p90", "p99", "p99.9", "max" };
+
+    uint64_t latencies[PERCENTILES_NUM], queries_nums[PERCENTILES_NUM];
+    double avg_nodes[PERCENTILES_NUM], avg_tests[PERCENTILES_NUM];
+    for(int i=0; i<PERCENTILES_NUM; i++)
+    {
+        latencies[i] = (percentiles[i] < 100) ? histogram.get_percentile(percentiles[i]) : histogram.get_max();
+        histogram.get_percentile_costs(percentiles[i],queries_nums[i],avg_nodes[i],avg_tests[i]);
+    }
+
+    cerr << "==latency_stats==" << endl;
+    cerr << "latency_ns(min mean p50 p90 p99 p99.9 max): " << histogram.get_min() << " " << histogram.get_mean();
+    for(int i=0; i<PERCENTILES_NUM; i++)
+        cerr << " " << latencies[i];
+    cerr << endl;
+    cerr << "nodes_visited(p50 p90 p99 p99.9 max):";
+    for(int i=0; i<PERCENTILES_NUM; i++)
+        cerr << " " << avg_nodes[i];
+    cerr << endl;
+    cerr << "geometric_tests(p50 p90 p99 p99.9 max):";
+    for(int i=0; i<PERCENTILES_NUM; i++)
+        cerr << " " << avg_tests[i];
+    cerr << endl;
+
+    if(fileName.empty())
+        return true;
+
+    ofstream json((fileName+".json").c_str());
+    json << "{" << endl;
+    json << "  \"query\": \"" << query_name << "\"," << endl;
+    json << "  \"queries_num\": " << histogram.get_count() << "," << endl;
+    json << "  \"min_ns\": " << histogram.get_min() << "," << endl;
+    json << "  \"mean_ns\": " << histogram.get_mean() << "," << endl;
+    json << "  \"max_ns\": " << histogram.get_max() << "," << endl;
+    json << "  \"percentiles\": [" << endl;
+    for(int i=0; i<PERCENTILES_NUM; i++)
+    {
+        json << "    { \"percentile\": " << percentiles[i] << ", \"latency_ns\": " << latencies[i]
+             << ", \"queries_num\": " << queries_nums[i] << ", \"avg_nodes_visited\": " << avg_nodes[i]
+             << ", \"avg_geometric_tests\": " << avg_tests[i] << " }" << ((i+1 < PERCENTILES_NUM) ? "," : "") << endl;
+    }
+    json << "  ]" << endl;
+    json << "}" << endl;
+    json.close();
+
+    ofstream csv((fileName+".csv").c_str());
+    csv << "query,percentile,latency_ns,queries_num,avg_nodes_visited,avg_geometric_tests" << endl;
+    csv << query_name << ",min," << histogram.get_min() << ",,," << endl;
+    for(int i=0; i<PERCENTILES_NUM; i++)
+        csv << query_name << "," << names[i] << "," << latencies[i] << "," << queries_nums[i] << "," << avg_nodes[i] << "," << avg_tests[i] << endl;
+    csv.close();
+
+    return !json.fail() && !csv.fail();
+}
+
 void Writer::write_point_queries(set<Point>& points, string fileName)
 {
     ofstream output(fileName.c_str());
@@ -213,3 +284,126 @@ void Writer::write_box_queries(set<Box> &boxes, string fileName)
     output.close();
 }
 
+
+bool Writer::write_snapshot(string fileName, Mesh &mesh, Frozen_Layout &layout, snapshot::Info &info)
+{
+    ofstream output(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!output.is_open())
+    {
+        cerr << "Error in file " << fileName << "\nThe file could not be written." << endl;
+        return false;
+    }
+
+    snapshot::Header header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,snapshot::MAGIC,sizeof(header.magic));
+    header.version = snapshot::VERSION;
+    header.byte_order = snapshot::BYTE_ORDER_MARK;
+    strncpy(header.division,info.division_type.c_str(),sizeof(header.division)-1);
+    strncpy(header.criterion,info.crit_type.c_str(),sizeof(header.criterion)-1);
+    header.vertices_per_leaf = info.vertices_per_leaf;
+    header.tetrahedra_per_leaf = info.tetrahedra_per_leaf;
+    header.reindexed = info.reindexed;
+    header.run_coord_size = sizeof(run_coord);
+    header.mesh_coord_size = sizeof(mesh_coord);
+    for(int j=0; j<3; j++)
+    {
+        header.domain[j] = mesh.get_domain().get_min().get_c(j);
+        header.domain[j+3] = mesh.get_domain().get_max().get_c(j);
+    }
+    // the header is completed, and written again, once the sections have been placed
+    output.write(reinterpret_cast<const char*>(&header),sizeof(header));
+
+    vector<double> vertices;
+    vertices.reserve(4*(size_t)mesh.get_num_vertices());
+    for(int v=1; v<=mesh.get_num_vertices(); v++)
+    {
+        Vertex vert = mesh.get_vertex(v);
+        vertices.push_back(vert.get_x());
+        vertices.push_back(vert.get_y());
+        vertices.push_back(vert.get_z());
+        vertices.push_back(vert.get_field());
+    }
+    write_section(output,header.sections[snapshot::VERTICES],vertices.data(),mesh.get_num_vertices(),4*sizeof(double));
+    vector<double>().swap(vertices);
+
+    int_vect tetrahedra;
+    tetrahedra.reserve(4*(size_t)mesh.get_num_tetrahedra());
+    for(int t=1; t<=mesh.get_num_tetrahedra(); t++)
+    {
+        Tetrahedron &tet = mesh.get_tetrahedron(t);
+        for(int i=0; i<tet.vertices_num(); i++)
+            tetrahedra.push_back(tet.is_border_face(i) ? -tet.TV(i) : tet.TV(i));
+    }
+    write_section(output,header.sections[snapshot::TETRAHEDRA],tetrahedra.data(),mesh.get_num_tetrahedra(),4*sizeof(int));
+    int_vect().swap(tetrahedra);
+
+    int_vect* arrays[] = { &layout.get_sons(), &layout.get_leaf_begins(), &layout.get_leaf_ends(), &layout.get_leaves(), &layout.get_t_offsets(),
+                           &layout.get_tetrahedra(), &layout.get_r_offsets() };
+    for(int s=snapshot::SONS; s<=snapshot::R_OFFSETS; s++)
+        write_section(output,header.sections[s],arrays[s-snapshot::SONS]->data(),arrays[s-snapshot::SONS]->size(),sizeof(int));
+    write_section(output,header.sections[snapshot::RUN_BBOXES],layout.get_run_bboxes().data(),layout.get_run_bboxes().size(),sizeof(Run_Bounding_Box));
+    write_section(output,header.sections[snapshot::V_STARTS],layout.get_v_starts().data(),layout.get_v_starts().size(),sizeof(int));
+    write_section(output,header.sections[snapshot::V_ENDS],layout.get_v_ends().data(),layout.get_v_ends().size(),sizeof(int));
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    output.close();
+    return !output.fail();
+}
+
+bool Writer::write_VT(string fileName, VT_Relation &vt)
+{
+    relations::Header header;
+    memset(&header,0,sizeof(header));
+    header.relation = relations::VT;
+    header.entries_per_element = 0;
+    header.elements_num = vt.get_vertices_num();
+    return write_relation(fileName,header,vt.get_offsets(),vt.get_tetrahedra());
+}
+
+bool Writer::write_TT(string fileName, TT_Relation &tt)
+{
+    relations::Header header;
+    memset(&header,0,sizeof(header));
+    header.relation = relations::TT;
+    header.entries_per_element = 4;
+    header.elements_num = tt.get_tetrahedra_num();
+    vector<int> no_offsets;
+    return write_relation(fileName,header,no_offsets,tt.get_adjacents());
+}
+
+bool Writer::write_relation(string fileName, relations::Header &header, vector<int> &offsets, vector<int> &entries)
+{
+    ofstream output(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!output.is_open())
+    {
+        cerr << "Error in file " << fileName << "\nThe file could not be written." << endl;
+        return false;
+    }
+
+    memcpy(header.magic,relations::MAGIC,sizeof(header.magic));
+    header.version = relations::VERSION;
+    header.byte_order = snapshot::BYTE_ORDER_MARK;
+    // the header is completed, and written again, once the sections have been placed
+    output.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    write_section(output,header.sections[relations::OFFSETS],offsets.data(),offsets.size(),sizeof(int));
+    write_section(output,header.sections[relations::ENTRIES],entries.data(),entries.size(),sizeof(int));
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    output.close();
+    return !output.fail();
+}
+
+void Writer::write_section(ofstream &output, snapshot::Section_Entry &entry, const void *data, size_t count, size_t entry_size)
+{
+    static const char padding[snapshot::ALIGNMENT] = {0};
+    uint64_t pos = output.tellp();
+    uint64_t offset = (pos + snapshot::ALIGNMENT - 1) / snapshot::ALIGNMENT * snapshot::ALIGNMENT;
+    output.write(padding,offset-pos);
+    if(count > 0)
+        output.write(static_cast<const char*>(data),count*entry_size);
+    entry.offset = offset;
+    entry.count = count;
+}
@@ -34,10 +34,15 @@
 #include "tetrahedral_trees/tree.h"
 #include "statistics/index_statistics.h"
 #include "statistics/full_query_statistics.h"
+#include "statistics/latency_histogram.h"
 #include "basic_types/box.h"
 
 #include "tetrahedral_trees/node_v.h"
 #include "tetrahedral_trees/node_t.h"
+#include "tetrahedral_trees/frozen_node.h"
+#include "snapshot.h"
+#include "relations.h"
+#include "queries/topological_relations.h"
 
 using namespace std;
 ///A class that provides an interface for writing to file or standard output some data structures or statistics
@@ -50,6 +55,31 @@ public:
      * \param division a D& argument, representing the space subdivision type used for the spatial index
      */
     template<class N, class D> static void write_tree(string fileName, N& root, D& division);
+    ///A public method that writes a binary snapshot of a frozen tree and of its mesh
+    /*!
+     * The snapshot preserves the compressed encoding of the tetrahedra arrays and the stored run bounding boxes (see snapshot.h).
+     *
+     * \param fileName a string argument, representing the output path
+     * \param mesh a Mesh& argument, representing the tetrahedral mesh
+     * \param layout a Frozen_Layout& argument, representing the frozen tree
+     * \param info a snapshot::Info& argument, containing the parameters of the tree
+     * \return a boolean value, true if the file is correctly written, false otherwise
+     */
+    static bool write_snapshot(string fileName, Mesh& mesh, Frozen_Layout& layout, snapshot::Info& info);
+    ///A public method that writes the VT relation in binary form (see relations.h)
+    /*!
+     * \param fileName a string argument, representing the output path
+     * \param vt a VT_Relation& argument, representing the relation
+     * \return a boolean value, true if the file is correctly written, false otherwise
+     */
+    static bool write_VT(string fileName, VT_Relation& vt);
+    ///A public method that writes the TT relation in binary form (see relations.h)
+    /*!
+     * \param fileName a string argument, representing the output path
+     * \param tt a TT_Relation& argument, representing the relation
+     * \return a boolean value, true if the file is correctly written, false otherwise
+     */
+    static bool write_TT(string fileName, TT_Relation& tt);
     ///A public method that writes to standard output the spatial index statistics
     /*!
      * \param indexStats an IndexStatistics& argument, representing the statistics to save
@@ -62,6 +92,18 @@ public:
      * \param hit_ratio an integer representing the number of successfully answered queries
      */
     static void write_queries_stats(int size, FullQueryStatistics& fullQueryStats, int hit_ratio);
+    ///A public method that writes to standard output the percentiles of the query latencies and, optionally, writes them to file
+    /*!
+     * For each percentile (50, 90, 99, 99.9 and 100), the latency and the average costs (nodes visited and geometric tests)
+     * of the queries in the histogram bucket containing the percentile are reported (for the maximum, the costs of the slowest query).
+     * The files fileName.json and fileName.csv contain the same data in machine-readable form.
+     *
+     * \param query_name a string argument, representing the query type
+     * \param histogram a Latency_Histogram& argument, containing the latencies of the queries
+     * \param fileName a string argument, representing the output path without extension (empty to write only on standard output)
+     * \return a boolean value, true if the files are correctly written (or not requested), false otherwise
+     */
+    static bool write_latency_stats(string query_name, Latency_Histogram& histogram, string fileName);
     ///A public method that writes to file a series of points that will be used as point location input
     /*!
      * \param points a set<Point>& argument, representing the points list to save
@@ -95,6 +137,24 @@ private:
      * \param n a P_Node* argument, represents the node to save
      */
     static void write_node(ofstream& output, Node_V *n);
+    ///A private method that writes a section of a snapshot, aligned as required by the format
+    /*!
+     * \param output an ofstream& argument, represents the stream
+     * \param entry a snapshot::Section_Entry& argument, that is set with the position and the size of the section
+     * \param data a const void* argument, pointing to the array to write
+     * \param count a size_t argument, representing the number of entries of the array
+     * \param entry_size a size_t argument, representing the size of an entry
+     */
+    static void write_section(ofstream& output, snapshot::Section_Entry& entry, const void* data, size_t count, size_t entry_size);
+    ///A private method that writes a relation file
+    /*!
+     * \param fileName a string argument, representing the output path
+     * \param header a relations::Header& argument, with the relation type and the number of elements already set
+     * \param offsets a vector<int>& argument, containing the offsets array (empty if the relation has a fixed number of entries per element)
+     * \param entries a vector<int>& argument, containing the entries array
+     * \return a boolean value, true if the file is correctly written, false otherwise
+     */
+    static bool write_relation(string fileName, relations::Header& header, vector<int>& offsets, vector<int>& entries);
 };
 
 template<class N, class D> void Writer::write_tree(string fileName, N& root, D& division)
@@ -1,6 +1,30 @@
 #include "main_utility_functions.h"
 template<class T> int main_template(T& tree, global_variables &variables);
+template<class T> void exec_queries(T& tree, global_variables &variables, Statistics &stats);
+template<class T> void exec_server(T& tree, global_variables &variables);
+template<class T> void exec_server(T& tree, global_variables &variables)
+{
+    snapshot::Info info;
+    info.division_type = variables.division_type;
+    info.crit_type = variables.crit_type;
+    info.vertices_per_leaf = variables.vertices_per_leaf;
+    info.tetrahedra_per_leaf = variables.tetrahedra_per_leaf;
+    info.reindexed = variables.reindex;
+    // the index prepares the mesh, and (as for the queries read from file) supports the windowed distortion on a frozen tree only if reindexed
+    Tree_Index<T> index(tree,info,variables.freeze,variables.threads_num);
+    Query_Server server(index);
+    if(variables.server_path == "-")
+        server.serve_stream(STDIN_FILENO,STDOUT_FILENO);
+    else
+        server.serve_socket(variables.server_path);
+}
+
+template<class N, class D> void exec_queries_on_frozen_tree(Tree<N,D>& tree, global_variables &variables, Statistics &stats);
+template<class N, class D> void write_snapshot(Tree<N,D>& tree, global_variables &variables);
+template<class D> int exec_queries_on_snapshot(Mesh& mesh, Frozen_Layout& layout, global_variables &variables);
+int main_snapshot(global_variables &variables);
 int main_input_query_generation(global_variables &variables);
+int main_mesh_generation(global_variables &variables);
 
 int main(int argc, char** argv)
 {
@@ -17,6 +41,13 @@ int main(int argc, char** argv)
         print_usage();
         return (EXIT_FAILURE);
     }
+    Perf_Counters::set_enabled(variables.perf_counters);
+
+    if (!variables.mesh_generation.empty())
+        return main_mesh_generation(variables);
+
+    if (!variables.snapshot_in_path.empty())
+        return main_snapshot(variables);
 
     if (variables.isTreeFile)
     {
@@ -105,15 +136,18 @@ template<class T> int main_template(T& tree, global_variables &variables)
     Timer time;
 
     //Legge l'input
-    if (!Reader::read_mesh(tree.get_mesh(), variables.mesh_path))
+    Memory_Usage::start_phase();
+    if (!Reader::read_mesh(tree.get_mesh(), variables.mesh_path, variables.threads_num))
     {
         cout << "Error Loading .ts file. Execution Stopped." << endl;
         return -1;
     }
+    Memory_Usage::print_phase("reading the mesh");
 
     stringstream base_info;
     base_info << variables.vertices_per_leaf << " " << variables.tetrahedra_per_leaf << " " << variables.crit_type << " ";
 
+    Memory_Usage::start_phase();
     if (variables.isTreeFile)
     {
         if (!Reader::read_tree(tree, tree.get_root(), variables.tree_path))
@@ -127,10 +161,19 @@ template<class T> int main_template(T& tree, global_variables &variables)
         //costruisco l'albero da zero
         stringstream tree_info;
         tree_info << base_info.str() << "Building ";
+        Perf_Counters counters(true);
+        counters.start();
         time.start();
-        tree.build_tree();
+        if(variables.build_type == "bulk")
+            tree.build_tree_bulk(variables.threads_num);
+        else if(variables.build_type == "morton")
+            build_tree_morton(tree,variables.threads_num);
+        else
+            tree.build_tree();
         time.stop();
+        counters.stop();
         time.print_elapsed_time(tree_info.str());
+        counters.print_counters("building ("+variables.build_type+")");
 
         stringstream out;
         if (variables.crit_type == "pr")
@@ -141,65 +184,186 @@ template<class T> int main_template(T& tree, global_variables &variables)
             out << get_file_name(variables.mesh_path) << "_" << variables.division_type << "_" << variables.crit_type << "_t_" << variables.tetrahedra_per_leaf << "_.tree";
         Writer::write_tree(out.str(), tree.get_root(), tree.get_decomposition());
     }
+    Memory_Usage::print_phase(variables.isTreeFile ? "reading the tree" : "building");
 
 
     if(variables.reindex)
     {
+        Memory_Usage::start_phase();
+        Perf_Counters counters(true);
+        counters.start();
         time.start();
         Reindexer reindexer = Reindexer();
         reindexer.reindex_tree_and_mesh(tree);
         time.stop();
+        counters.stop();
         time.print_elapsed_time("Index and Mesh Reindexing ");
+        counters.print_counters("reindexing");
+        Memory_Usage::print_phase("reindexing");
+    }
+
+    if (!variables.snapshot_out_path.empty())
+    {
+        Memory_Usage::start_phase();
+        write_snapshot(tree,variables);
+        Memory_Usage::print_phase("writing the snapshot");
     }
 
     Statistics stats;
 
     if (variables.is_index)
+    {
+        Memory_Usage::start_phase();
         stats.get_index_statistics(tree,variables.reindex);
+        Memory_Usage::print_phase("index statistics");
+    }
 
-    if (variables.query_type != NOTHING)
+    if (variables.query_type != NOTHING || !variables.server_path.empty())
     {
-        Spatial_Queries sq;
-        Topological_Queries tq;
-
         cerr<<base_info.str()<<endl;
-        if (variables.query_type == POINT)
-            sq.exec_point_locations(tree,variables.query_path,stats);
-        else if(variables.query_type == BOX)
-            sq.exec_box_queries(tree,variables.query_path,stats);
-        else if(variables.query_type == LINE)
-        {
-            //the face ordering is needed only by the line in tetra test
-            Geometry_Wrapper::set_faces_ordering(tree.get_mesh());
-            sq.exec_line_queries(tree,variables.query_path,stats);
-        }
-        else if(variables.query_type == WINDVT)
-            tq.windowed_VT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path,variables.reindex);
-        else if(variables.query_type == WINDDIST)
-            tq.windowed_Distortion(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path,variables.reindex);
-        else if(variables.query_type == WINDTT)
-            tq.windowed_TT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path);
-        else if(variables.query_type == LINETT)
-        {
-            //the face ordering is needed only by the line in tetra test
-            Geometry_Wrapper::set_faces_ordering(tree.get_mesh());
-            tq.linearized_TT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path);
-        }
-        else if(variables.query_type == BATCH)
-        {
-            tq.batched_VT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.reindex);
-            tq.batched_TT(tree.get_root(),tree.get_mesh(),tree.get_decomposition());
-        }
+        Memory_Usage::start_phase();
+        if(variables.freeze)
+            exec_queries_on_frozen_tree(tree,variables,stats);
+        else
+            exec_queries(tree,variables,stats);
+        Memory_Usage::print_phase("queries");
     }
 
     return (EXIT_SUCCESS);
 }
 
+template<class T> void exec_queries(T& tree, global_variables &variables, Statistics &stats)
+{
+    if (!variables.server_path.empty())
+    {
+        exec_server(tree,variables);
+        return;
+    }
+
+    Spatial_Queries sq;
+    Topological_Queries tq;
+    sq.set_latency_path(variables.latency_path);
+    tq.set_latency_path(variables.latency_path);
+
+    if (variables.query_type == POINT)
+        sq.exec_point_locations(tree,variables.query_path,stats,variables.threads_num);
+    else if(variables.query_type == BPOINT)
+        sq.exec_batched_point_locations(tree,variables.query_path,variables.threads_num);
+    else if(variables.query_type == BOX)
+        sq.exec_box_queries(tree,variables.query_path,stats,variables.threads_num);
+    else if(variables.query_type == LINE)
+    {
+        //the face ordering is needed only by the line in tetra test
+        Geometry_Wrapper::set_faces_ordering(tree.get_mesh());
+        sq.exec_line_queries(tree,variables.query_path,stats,variables.threads_num);
+    }
+    else if(variables.query_type == WINDVT)
+        tq.windowed_VT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path,variables.reindex);
+    else if(variables.query_type == WINDDIST)
+        tq.windowed_Distortion(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path,variables.reindex);
+    else if(variables.query_type == WINDTT)
+        tq.windowed_TT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path);
+    else if(variables.query_type == LINETT)
+    {
+        //the face ordering is needed only by the line in tetra test
+        Geometry_Wrapper::set_faces_ordering(tree.get_mesh());
+        tq.linearized_TT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.query_path);
+    }
+    else if(variables.query_type == BATCH)
+    {
+        VT_Relation vt;
+        tq.batched_VT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.reindex,vt,variables.threads_num);
+        if(!variables.query_path.empty() && !Writer::write_VT(variables.query_path+".vt",vt))
+            cerr << "Error writing the VT relation file." << endl;
+        vt = VT_Relation();
+
+        TT_Relation tt;
+        tq.batched_TT(tree.get_root(),tree.get_mesh().get_domain(),tree.get_mesh(),tree.get_decomposition(),variables.reindex,tt,variables.threads_num);
+        if(!variables.query_path.empty() && !Writer::write_TT(variables.query_path+".tt",tt))
+            cerr << "Error writing the TT relation file." << endl;
+    }
+}
+
+template<class N, class D> void exec_queries_on_frozen_tree(Tree<N,D>& tree, global_variables &variables, Statistics &stats)
+{
+    Timer time;
+    time.start();
+    Frozen_Tree<D> frozen(tree);
+    time.stop();
+    time.print_elapsed_time("Freezing the index ");
+    cerr<<"[MEMORY] frozen layout: "<<frozen.get_layout().get_bytes()<<" bytes"<<endl;
+
+    exec_queries(frozen,variables,stats);
+}
+
+template<class N, class D> void write_snapshot(Tree<N,D>& tree, global_variables &variables)
+{
+    Timer time;
+    time.start();
+    Frozen_Tree<D> frozen(tree);
+    snapshot::Info info;
+    info.division_type = variables.division_type;
+    info.crit_type = variables.crit_type;
+    info.vertices_per_leaf = variables.vertices_per_leaf;
+    info.tetrahedra_per_leaf = variables.tetrahedra_per_leaf;
+    info.reindexed = variables.reindex;
+    if(!Writer::write_snapshot(variables.snapshot_out_path,tree.get_mesh(),frozen.get_layout(),info))
+        cerr << "Error writing the snapshot file." << endl;
+    time.stop();
+    time.print_elapsed_time("Writing the snapshot ");
+}
+
+int main_snapshot(global_variables &variables)
+{
+    Timer time;
+    Mesh mesh;
+    Frozen_Layout layout;
+    snapshot::Info info;
+
+    time.start();
+    if (!Reader::read_snapshot(variables.snapshot_in_path, mesh, layout, info))
+    {
+        cerr << "Error Loading the snapshot file. Execution Stopped." << endl;
+        return -1;
+    }
+    time.stop();
+    time.print_elapsed_time("Loading the snapshot ");
+
+    //the parameters of the index are recovered from the snapshot
+    variables.division_type = info.division_type;
+    variables.crit_type = info.crit_type;
+    variables.vertices_per_leaf = info.vertices_per_leaf;
+    variables.tetrahedra_per_leaf = info.tetrahedra_per_leaf;
+    variables.reindex = info.reindexed;
+    variables.freeze = true;
+    if (!checkParameters(variables))
+        return (EXIT_FAILURE);
+
+    if(variables.division_type == "ok")
+        return exec_queries_on_snapshot<OK_Subdivision>(mesh,layout,variables);
+    else
+        return exec_queries_on_snapshot<KD_Subdivision>(mesh,layout,variables);
+}
+
+template<class D> int exec_queries_on_snapshot(Mesh& mesh, Frozen_Layout& layout, global_variables &variables)
+{
+    Frozen_Tree<D> frozen(mesh,layout);
+    cerr<<"[MEMORY] frozen layout: "<<frozen.get_layout().get_bytes()<<" bytes"<<endl;
+
+    if (variables.query_type != NOTHING || !variables.server_path.empty())
+    {
+        Statistics stats;
+        cerr<<variables.vertices_per_leaf << " " << variables.tetrahedra_per_leaf << " " << variables.crit_type << " "<<endl;
+        exec_queries(frozen,variables,stats);
+    }
+    return (EXIT_SUCCESS);
+}
+
 int main_input_query_generation(global_variables &variables)
 {
     Mesh mesh;
     //Legge l'input
-    if (!Reader::read_mesh(mesh, variables.mesh_path))
+    if (!Reader::read_mesh(mesh, variables.mesh_path, variables.threads_num))
     {
         cout << "Error Loading .ts file. Execution Stopped." << endl;
         return -1;
@@ -229,3 +393,56 @@ int main_input_query_generation(global_variables &variables)
 
     return EXIT_SUCCESS;
 }
+
+int main_mesh_generation(global_variables &variables)
+{
+    vector<string> tok;
+    tokenize(variables.mesh_generation,tok,"-");
+    vector<string> cells;
+    if(tok.size() >= 2)
+        tokenize(tok[0],cells,"x");
+    if(tok.size() < 2 || (cells.size() != 1 && cells.size() != 3) || variables.mesh_path.empty())
+    {
+        cerr << "[-m argument] error when reading arguments" << endl;
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    int nx = atoi(cells[0].c_str());
+    int ny = (cells.size() == 3) ? atoi(cells[1].c_str()) : nx;
+    int nz = (cells.size() == 3) ? atoi(cells[2].c_str()) : nx;
+    if(nx < 1 || ny < 1 || nz < 1)
+    {
+        cerr << "Error: the number of cells must be greater than 0" << endl;
+        return EXIT_FAILURE;
+    }
+
+    Mesh_Generator generator(nx,ny,nz,strtoull(tok[1].c_str(),NULL,10));
+    for(unsigned i=2; i<tok.size(); i++)
+    {
+        if(tok[i] == "notch")
+            generator.set_notch(true);
+        else if(tok[i][0] == 'j')
+            generator.set_jitter(atof(tok[i].c_str()+1));
+        else if(tok[i][0] == 'g')
+            generator.set_grading(atof(tok[i].c_str()+1));
+        else if(tok[i][0] == 'h')
+            generator.set_holes(atoi(tok[i].c_str()+1));
+        else
+        {
+            cerr << "[-m argument] unknown option " << tok[i] << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Timer time;
+    time.start();
+    if(!generator.write_ts(variables.mesh_path))
+    {
+        cerr << "Error writing the mesh file " << variables.mesh_path << endl;
+        return EXIT_FAILURE;
+    }
+    time.stop();
+    cerr << "vertices: " << generator.get_vertices_num() << " tetrahedra: " << generator.get_tetrahedra_num() << endl;
+    time.print_elapsed_time("[TIME] generating the mesh ");
+    return EXIT_SUCCESS;
+}
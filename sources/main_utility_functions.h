@@ -22,16 +22,22 @@
 #include "tetrahedral_trees/t_tree.h"
 #include "tetrahedral_trees/rt_tree.h"
 #include "tetrahedral_trees/reindexer.h"
+#include "tetrahedral_trees/frozen_tree.h"
 #include "utilities/input_generator.h"
+#include "utilities/mesh_generator.h"
 #include "utilities/string_management.h"
 #include "utilities/timer.h"
+#include "utilities/perf_counters.h"
+#include "utilities/memory_usage.h"
+#include "utilities/thread_pool.h"
+#include "server/query_server.h"
 
 using namespace std;
 using namespace string_management;
 
 #define DEFAULT_X_PER_LEAF -1
 #define DEFAULT "null"
-enum TopoQueryType { POINT, LINE, BOX, WINDVT, WINDDIST, WINDTT, LINETT, BATCH, NOTHING };
+enum TopoQueryType { POINT, BPOINT, LINE, BOX, WINDVT, WINDDIST, WINDTT, LINETT, BATCH, NOTHING };
 #define BOLD  "\033[1m\033[33m" //for dark background shell
 //#define BOLD "\033[1m\033[31m"  //for white background shell
 #define RESET   "\033[0m"
@@ -42,7 +48,7 @@ struct global_variables
     string mesh_path, query_path, exe_name, tree_path;
     string division_type;
     string crit_type;
-    bool is_index, is_getInput, isTreeFile, reindex;
+    bool is_index, is_getInput, isTreeFile, reindex, freeze, perf_counters;
     int vertices_per_leaf;
     int tetrahedra_per_leaf;
 
@@ -51,6 +57,14 @@ struct global_variables
     TopoQueryType query_type;
     string input_gen_type;
 
+    string build_type;
+    int threads_num;
+
+    string snapshot_out_path, snapshot_in_path;
+    string server_path;
+    string latency_path;
+    string mesh_generation;
+
     global_variables()
     {
         division_type = DEFAULT;
@@ -62,9 +76,14 @@ struct global_variables
         is_getInput = false;
         isTreeFile = false;
         reindex = false;
+        freeze = false;
+        perf_counters = false;
 
         num_input_entries = 0;
         input_gen_type = DEFAULT;
+
+        build_type = "seq";
+        threads_num = Thread_Pool::get_hardware_threads_num();
     }
 };
 ///
@@ -121,6 +140,23 @@ bool checkParameters(global_variables &variables)
         print_usage();
         return false;
     }
+    if (variables.freeze && variables.query_type == WINDDIST && !variables.reindex)
+    {
+        cout << "Error: the windowed distortion on a frozen index requires the -r option. Execution Stopped." << endl;
+        print_usage();
+        return false;
+    }
+    if (variables.division_type != "ok" && variables.division_type != "kd" && !variables.snapshot_in_path.empty())
+    {
+        cout << "Error: the snapshot contains an unknown division type. Execution Stopped." << endl;
+        return false;
+    }
+    if (variables.build_type == "morton" && variables.crit_type != "pr")
+    {
+        cout << "Error: the morton construction is available only for the P-Ttree (pr). Execution Stopped." << endl;
+        print_usage();
+        return false;
+    }
     return true;
 }
 
@@ -180,13 +216,63 @@ int read_arguments(int argc, char** argv, global_variables &variables)
         {
             variables.reindex = true;
         }
+        else if(strcmp(tag, "-e") == 0)
+        {
+            variables.perf_counters = true;
+        }
+        else if(strcmp(tag, "-z") == 0)
+        {
+            variables.freeze = true;
+        }
+        else if(strcmp(tag, "-w") == 0)
+        {
+            variables.snapshot_out_path = argv[i+1];
+            i++;
+        }
+        else if(strcmp(tag, "-l") == 0)
+        {
+            variables.snapshot_in_path = argv[i+1];
+            i++;
+        }
+        else if(strcmp(tag, "-u") == 0)
+        {
+            variables.server_path = argv[i+1];
+            i++;
+        }
+        else if(strcmp(tag, "-o") == 0)
+        {
+            variables.latency_path = argv[i+1];
+            i++;
+        }
+        else if(strcmp(tag, "-b") == 0)
+        {
+            variables.build_type = argv[i+1];
+            if (variables.build_type != "seq" && variables.build_type != "bulk" && variables.build_type != "morton") {
+                cerr << "Error: the construction type must be seq, bulk or morton" << endl;
+                return -1;
+            }
+            i++;
+        }
+        else if(strcmp(tag, "-p") == 0)
+        {
+            variables.threads_num = atoi(argv[i+1]);
+            if (variables.threads_num < 1) {
+                cerr << "Error: the number of threads must be greater than 0" << endl;
+                return -1;
+            }
+            i++;
+        }
         else if(strcmp(tag, "-q") == 0)
         {
             trash = argv[i+1];
             vector<string> tok;
             tokenize(trash,tok,"-");
-            if(tok.size()==1 && tok[0]=="batch")
+            if(!tok.empty() && tok[0]=="batch")
+            {
                 variables.query_type = BATCH;
+                if(tok.size() > 1)
+                    variables.query_path = tok[1];
+            }
             else if(tok.size()<2)
                 cerr<<"[-q argument] error when reading arguments"<<endl;
             else
@@ -201,6 +287,8 @@ int read_arguments(int argc, char** argv, global_variables &variables)
                     variables.query_type = LINETT;
                 else if(tok[0] == "point")
                     variables.query_type = POINT;
+                else if(tok[0] == "bpoint")
+                    variables.query_type = BPOINT;
                 else if(tok[0] == "box")
                     variables.query_type = BOX;
                 else if(tok[0] == "line")
@@ -210,6 +298,11 @@ int read_arguments(int argc, char** argv, global_variables &variables)
             }
             i++;
         }
+        else if(strcmp(tag, "-m") == 0)
+        {
+            variables.mesh_generation = argv[i+1];
+            i++;
+        }
         else if(strcmp(tag, "-g") == 0)
         {
             trash = argv[i+1];
@@ -265,8 +358,10 @@ void print_help()
 
     printf(BOLD "  USAGE: \n\n" RESET);
     printf(BOLD "    ./tetrahedraltrees {<-v [kv] -t [kt] -c [crit] -d [div] | -f [tree_file]>\n" RESET);
-    printf(BOLD "                       -q [op-file] -s -r} | {-g [query-ratio-quantity-type]}\n" RESET);
+    printf(BOLD "                       -b [build] -p [threads] -q [op-file] -o [latency_file] -u [socket] -s -r -e -z -w [snapshot_file]} | {-g [query-ratio-quantity-type]}\n" RESET);
     printf(BOLD "                       -i [mesh_file]\n" RESET);
+    printf(BOLD "    ./tetrahedraltrees -l [snapshot_file] {-q [op-file] -o [latency_file] -e | -u [socket]}\n" RESET);
+    printf(BOLD "    ./tetrahedraltrees -m [cells-seed{-option}] -i [mesh_file]\n" RESET);
 
     printf(BOLD "    -v [kv]\n" RESET);
     print_paragraph("kv is the vertices threshold per leaf. This parameter is needed by P-Ttrees and PT-Ttrees.", cols);
@@ -280,6 +375,17 @@ void print_help()
     print_paragraph("NOTA: these arguments must be used in conjunction to create an index. "
                     "This operation generate as output a file containing the tetrahedral index.", cols);
 
+    printf(BOLD "    -b [build]\n" RESET);
+    print_paragraph("build is the construction algorithm of the index. This can be the incremental insertion of the entities (seq), "
+                    "that is the default one, the parallel top-down construction (bulk), or, only for the P-Ttrees, the construction "
+                    "on the vertices sorted by their locational codes (morton). All produce the same index. "
+                    "The morton construction also sorts the mesh vertices following the index, as done by the -r option, "
+                    "thus, the vertices indices in the output tree_file refer to the sorted mesh.", cols);
+    printf(BOLD "    -p [threads]\n" RESET);
+    print_paragraph("threads is the number of threads used by the parallel procedures (i.e., the mesh parsing, the bulk and morton constructions, "
+                    "the point, box and line queries, that are distributed among the threads, and the batched extraction of the VT and TT relations, "
+                    "where the leaves are distributed among the threads). By default, all the hardware threads are used.", cols);
+
     printf(BOLD "    -f [tree_file]\n" RESET);
     print_paragraph("reads an spatial index from an input file", cols);
     print_paragraph("tree_file contains a Tetrahedral tree index. This file has a fixed syntax of the name "
@@ -289,11 +395,28 @@ void print_help()
 
     printf(BOLD "    -q [op-file]\n" RESET);
     print_paragraph("executes a query op, picking the inputs from file", cols);
-    print_paragraph("'op' can be: point - box - line - wvt - wdist - wtt - ltt \n"
-                    "'point' stands for point location, 'box' for box query, 'line' for line query, "
+    print_paragraph("'op' can be: point - bpoint - box - line - wvt - wdist - wtt - ltt \n"
+                    "'point' stands for point location, 'bpoint' for batched point location (all the points are located with a single visit of the index), "
+                    "'box' for box query, 'line' for line query, "
                     "'wvt' for windowed VT query, 'wdist' windowed Distortion computation, "
                     "'wtt' for windowed TT query and 'ltt' for linearized TT query."
                     "'file' represent the path of the file that contains the inputs for the queries.", cols);
+    print_paragraph("'batch' (without file) extracts the VT and TT relations of the whole mesh. "
+                    "With 'batch-prefix' the relations are also written in binary form in the files prefix.vt and prefix.tt.", cols);
+
+    printf(BOLD "    -o [latency_file]\n" RESET);
+    print_paragraph("writes the latency percentiles (p50, p90, p99, p99.9 and max) of the point, box, line, wvt, wdist, wtt and ltt queries "
+                    "in the files latency_file.json and latency_file.csv. For each percentile, the average number of nodes visited and of geometric tests "
+                    "executed by the queries in the histogram bucket containing the percentile (by the slowest query, for the max) is also reported. "
+                    "The latencies are measured with a monotonic clock, with nanosecond resolution. "
+                    "Without this option, the percentiles are printed only on the standard error.", cols);
+    printf(BOLD "    -u [socket]\n" RESET);
+    print_paragraph("keeps the index in memory and answers the point, box, line, windowed VT, windowed TT, linearized TT and windowed distortion "
+                    "queries received on the Unix domain socket 'socket', until a shutdown request is received. "
+                    "With '-' as socket, a single client is served on the standard input and output. "
+                    "The requests and the responses are encoded in binary form (see sources/server/protocol.h), "
+                    "and each response reports the time spent executing the query. "
+                    "The client in the 'client' folder sends the queries read from a file.", cols);
 
     printf(BOLD "    -g [query-ratio-quantity-type]\n" RESET);
     print_paragraph("generates a given number of input data for a specific query", cols);
@@ -304,10 +427,39 @@ void print_help()
                     "while 'rand' stands for a point (picked randomly) that is inside the domain.", cols);
     print_paragraph("If 'query' is equal to point 'ratio' must be equal to 0, otherwise 'ratio' must be greater than 0.", cols);
 
+    printf(BOLD "    -m [cells-seed{-option}]\n" RESET);
+    print_paragraph("generates a synthetic mesh in the file given by -i, i.e., the Kuhn tetrahedralization of a grid of cells (six tetrahedra per cell). "
+                    "'cells' is the number of cells per axis, either N or NxMxK, and 'seed' initializes the random values, "
+                    "thus the same arguments always generate the same mesh. The options are: "
+                    "'jJ' moves each vertex by a random jitter of at most J times the side of the cells (J at most 0.07), "
+                    "'gG' clusters the vertices around the center of the domain with strength G (graded density), "
+                    "'hH' removes the cells inside H random spherical holes and "
+                    "'notch' removes the cells in a corner of the domain (non-convex boundary). "
+                    "The mesh is written one layer of cells at a time, thus meshes larger than the memory can be generated "
+                    "(even if the meshes with more than 2^31-1 tetrahedra cannot be read by the library). "
+                    "E.g., -m 100-42-j0.05-g3-h4-notch -i mesh.ts", cols);
+
     printf(BOLD "    -s\n" RESET);
     print_paragraph("computes the tetrahedral tree statistics.", cols);
     printf(BOLD "    -r\n" RESET);
     print_paragraph("activate the procedures to exploit the spatial coherence of the index and the mesh.", cols);
+    printf(BOLD "    -e\n" RESET);
+    print_paragraph("reads the hardware performance counters (cycles, instructions, last-level cache misses and branch misses) "
+                    "during the construction, the reindexing and the execution of the queries, and prints them on the standard error "
+                    "(lines starting with [PERF]). For the queries, the average and maximum counters per query are also reported. "
+                    "Only the events in user space are counted (Linux only, through perf_event_open): the events that cannot be read, "
+                    "e.g. with a restrictive /proc/sys/kernel/perf_event_paranoid or on a virtual machine, are reported as n/a.", cols);
+    printf(BOLD "    -z\n" RESET);
+    print_paragraph("freezes the index before executing the queries. The index is converted in a read-only linearized layout, "
+                    "where the nodes are stored contiguously and refer to their sons by position, "
+                    "and all the tetrahedra arrays are concatenated. The queries are then executed on this layout. "
+                    "The windowed distortion requires also the -r option.", cols);
+    printf(BOLD "    -w [snapshot_file]\n" RESET);
+    print_paragraph("writes a binary snapshot of the (frozen) index and of the mesh, after the construction and, with the -r option, the reindexing. "
+                    "The snapshot preserves the compressed encoding of the tetrahedra arrays of a reindexed index.", cols);
+    printf(BOLD "    -l [snapshot_file]\n" RESET);
+    print_paragraph("loads the index and the mesh from a snapshot written with the -w option, without reading the mesh_file. "
+                    "The index parameters are recovered from the snapshot, and the queries are executed on the frozen index (as with -z).", cols);
     printf(BOLD "    - i [mesh_file]\n" RESET);
     print_paragraph("reads the mesh_file containing the tetrahedral mesh.", cols);
 
@@ -23,39 +23,6 @@
 
 #include "border_checker.h"
 
-void Border_Checker::calc_mesh_borders(Node_V &n, Mesh &mesh)
-{
-    if(n.get_v_array_size() == 0)
-        return;
-
-    vector< vector<triangle_tetrahedron_tuple> > all_faces;
-    vector<triangle_tetrahedron_tuple> faces;
-    all_faces.assign(n.get_v_end()-n.get_v_start(),faces);
-
-    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
-    {
-        RunIterator const& tet_id = itPair.first;
-        Tetrahedron& t = mesh.get_tetrahedron(*tet_id);
-        for(int j=0; j<t.vertices_num(); j++)
-        {
-            int real_index = t.TV(j);
-            if(n.indexes_vertex(real_index))
-            {
-                //we insert the three triangular faces incident in vertex v_pos
-                get_incident_triangles(t,*tet_id,j,all_faces[real_index-n.get_v_start()]);
-            }
-        }
-    }
-
-    for(vector< vector<triangle_tetrahedron_tuple> >::iterator iter=all_faces.begin(); iter!=all_faces.end(); ++iter)
-    {
-        if(iter->size() > 0)
-        {
-            this->set_mesh_borders(*iter,mesh);
-        }
-    }
-}
-
 void Border_Checker::calc_mesh_borders(Node_T &n, Box &dom, Mesh& mesh)
 {
     map< int, vector<triangle_tetrahedron_tuple> > all_faces;
@@ -54,25 +54,27 @@ public:
     template<class D> void calc_mesh_borders(Node_T &n, Box &dom, int level, Mesh &mesh, D &division);
     /**
      * @brief A public procedure that visits recursively a tree and exploit the mesh borders.
-     * This version requires a tree on which the spatial coherence has been exploited, and is compatible with P-Ttrees.
+     * This version requires a tree on which the spatial coherence has been exploited, and is compatible with P-Ttrees
+     * and with the frozen trees (i.e., with the nodes encoding a vertices range).
      *
-     * @param n a P_Node& parameter representing the current node
+     * @param n a N& parameter representing the current node
      * @param dom a Box& parameter representing the current domain of node n
      * @param level an integer argument representing the level of n in the hierarchy
      * @param mesh a Mesh& parameter representing the indexed tetrahedral mesh
      * @param division a D& parameter representing the spatial subdivision of the tree
      */
-    template<class D> void calc_mesh_borders(Node_V &n, Box &dom, int level, Mesh &mesh, D &division);
+    template<class N, class D> void calc_mesh_borders(N &n, Box &dom, int level, Mesh &mesh, D &division);
 
 private:
     /**
      * @brief A private procedure that exploits the mesh border in a leaf block.
-     * This version requires a tree on which the spatial coherence has been exploited, and is compatible with P-Ttrees and PT-Ttrees.
+     * This version requires a tree on which the spatial coherence has been exploited, and is compatible with P-Ttrees, PT-Ttrees
+     * and frozen trees.
      *
      * @param n a N& parameter representing the current node
      * @param mesh a Mesh& parameter representing the indexed tetrahedral mesh
      */
-    void calc_mesh_borders(Node_V& n, Mesh& mesh);
+    template<class N> void calc_mesh_borders(N& n, Mesh& mesh);
     /**
      * @brief A private procedure that exploits the mesh border in a leaf block.
      * This version is compatible with T-Ttrees and RT-Ttrees on which the spatial coherence has been exploited
@@ -110,16 +112,18 @@ template<class D> void Border_Checker::calc_mesh_borders(Node_T &n, Box &dom, in
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->calc_mesh_borders(*n.get_son(i),son_dom,son_level,mesh,division);
         }
     }
 }
 
-template<class D> void Border_Checker::calc_mesh_borders(Node_V &n, Box &dom, int level, Mesh &mesh, D &division)
+template<class N, class D> void Border_Checker::calc_mesh_borders(N &n, Box &dom, int level, Mesh &mesh, D &division)
 {
     if (n.is_leaf())
     {
@@ -134,4 +138,37 @@ template<class D> void Border_Checker::calc_mesh_borders(Node_V &n, Box &dom, in
     }
 }
 
+template<class N> void Border_Checker::calc_mesh_borders(N &n, Mesh &mesh)
+{
+    if(n.get_v_array_size() == 0)
+        return;
+
+    vector< vector<triangle_tetrahedron_tuple> > all_faces;
+    vector<triangle_tetrahedron_tuple> faces;
+    all_faces.assign(n.get_v_end()-n.get_v_start(),faces);
+
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& t = mesh.get_tetrahedron(*tet_id);
+        for(int j=0; j<t.vertices_num(); j++)
+        {
+            int real_index = t.TV(j);
+            if(n.indexes_vertex(real_index))
+            {
+                //we insert the three triangular faces incident in vertex v_pos
+                get_incident_triangles(t,*tet_id,j,all_faces[real_index-n.get_v_start()]);
+            }
+        }
+    }
+
+    for(vector< vector<triangle_tetrahedron_tuple> >::iterator iter=all_faces.begin(); iter!=all_faces.end(); ++iter)
+    {
+        if(iter->size() > 0)
+        {
+            this->set_mesh_borders(*iter,mesh);
+        }
+    }
+}
+
 #endif // BORDERCHECKER_H
@@ -0,0 +1,281 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INTERLEAVED_POINT_LOCATOR_H
+#define INTERLEAVED_POINT_LOCATOR_H
+
+#include <vector>
+#include "basic_types/mesh.h"
+#include "geometry/geometry_wrapper.h"
+
+/**
+ * @brief The Interleaved_Point_Locator class executes independent point locations keeping several of them in flight at the same time.
+ * The descent of a point location is a chain of dependent memory accesses (the sons of a node, the tetrahedra array of the leaf,
+ * the tetrahedra and their vertices), that stalls on each cache miss when the index does not fit in cache.
+ * Here, each point location is an explicit state machine (equivalent to the exec_point_query recursion of Spatial_Queries):
+ * the locations of a group are advanced one step at a time in round-robin, and each step issues a software prefetch of the data
+ * needed by the next step of the same location (asynchronous memory access chaining), thus the misses of the group overlap.
+ * The results are the same of Spatial_Queries::locate_point.
+ */
+class Interleaved_Point_Locator
+{
+public:
+    ///the default number of point locations kept in flight
+    static const int DEFAULT_GROUP_SIZE = 8;
+    /**
+     * @brief A constructor method
+     * @param group_size an integer representing the number of point locations kept in flight
+     */
+    Interleaved_Point_Locator(int group_size = DEFAULT_GROUP_SIZE) { this->group_size = (group_size < 1) ? 1 : group_size; }
+    ///A public method that returns the number of point locations kept in flight
+    inline int get_group_size() const { return this->group_size; }
+    /**
+     * @brief A public method that locates a set of points
+     *
+     * @param tree a T& argument, represents the tree where the points are located
+     * @param points a vector<Point>& containing the points to locate
+     * @param results a vector<int>& that is set, for each point, with the tetrahedron containing it (0 if the point is outside the mesh)
+     */
+    template<class T> void locate_points(T& tree, vector<Point>& points, vector<int>& results);
+
+private:
+    int group_size;
+
+    ///the stages of a point location
+    enum Stage { DESCEND, LEAF, DONE };
+
+    ///the state of a point location in flight
+    template<class N> struct Location
+    {
+        Stage stage;
+        int point;
+        //the current node, with its domain and level
+        N* node;
+        Box dom;
+        int level;
+        //the position in the tetrahedra array of the leaf
+        int_vect_iter it;
+        int_vect_iter end;
+        int run_id;
+        //the tetrahedra of the current run still to test
+        int t_next;
+        int t_last;
+    };
+
+    /**
+     * @brief A private method that starts the location of a point
+     */
+    template<class N> void start(Location<N> &loc, int point, N &root, Mesh &mesh);
+    /**
+     * @brief A private method that advances a point location of one step
+     * A step either visits a node of the hierarchy, or an entry of the leaf tetrahedra array, or a batch of tetrahedra of a run.
+     *
+     * @param loc a Location<N>& argument, representing the location to advance
+     * @param points a vector<Point>& containing the points to locate
+     * @param results a vector<int>& containing the tetrahedra found for the points
+     * @param mesh a Mesh& argument, representing the current mesh
+     * @param division a D& argument, representing the tree subdivision
+     */
+    template<class N, class D> void step(Location<N> &loc, vector<Point>& points, vector<int>& results, Mesh &mesh, D &division);
+    /**
+     * @brief A private method that tests a batch of tetrahedra, and terminates the location if one of them contains the point
+     * As in the recursive visit, the point is assigned to the first tetrahedron of the batch containing it
+     */
+    template<class N> inline bool test_batch(Location<N> &loc, const int *t_ids, int num, Point &p, vector<int>& results, Mesh &mesh)
+    {
+        int inside = Geometry_Wrapper::point_in_tetra_batch(t_ids,num,p,mesh);
+        if(inside == 0)
+            return false;
+        for(int i=0; i<num; i++)
+        {
+            if(inside & (1 << i))
+            {
+                results[loc.point] = t_ids[i];
+                break;
+            }
+        }
+        loc.stage = DONE;
+        return true;
+    }
+    /**
+     * @brief A private method that prefetches the records of a batch of consecutive tetrahedra
+     */
+    inline void prefetch_tetrahedra(int first, int last, Mesh &mesh)
+    {
+        for(int t=first; t<=last && t<first+Geometry_Wrapper::BATCH_SIZE; t++)
+            __builtin_prefetch(&mesh.get_tetrahedron(t));
+    }
+    /**
+     * @brief A private method that prefetches the vertices of a batch of consecutive tetrahedra
+     * NOTA: this reads the tetrahedra records, thus it is issued one step after prefetch_tetrahedra
+     */
+    inline void prefetch_vertices(int first, int last, Mesh &mesh)
+    {
+        for(int t=first; t<=last && t<first+Geometry_Wrapper::BATCH_SIZE; t++)
+        {
+            Tetrahedron &tet = mesh.get_tetrahedron(t);
+            for(int v=0; v<tet.vertices_num(); v++)
+                mesh.prefetch_vertex(tet.TV(v));
+        }
+    }
+};
+
+template<class T> void Interleaved_Point_Locator::locate_points(T& tree, vector<Point>& points, vector<int>& results)
+{
+    typedef typename std::remove_reference<decltype(tree.get_root())>::type N;
+
+    results.assign(points.size(),0);
+    vector<Location<N> > group(this->group_size);
+    int next = 0;
+    int active = 0;
+    for(unsigned l=0; l<group.size(); l++)
+    {
+        if(next < (int)points.size())
+        {
+            this->start(group[l],next++,tree.get_root(),tree.get_mesh());
+            active++;
+        }
+        else
+            group[l].stage = DONE;
+    }
+
+    while(active > 0)
+    {
+        for(unsigned l=0; l<group.size(); l++)
+        {
+            Location<N> &loc = group[l];
+            if(loc.stage == DONE)
+                continue;
+            this->step(loc,points,results,tree.get_mesh(),tree.get_decomposition());
+            if(loc.stage == DONE)
+            {
+                // the slot is reused by the next point
+                if(next < (int)points.size())
+                    this->start(loc,next++,tree.get_root(),tree.get_mesh());
+                else
+                    active--;
+            }
+        }
+    }
+}
+
+template<class N> void Interleaved_Point_Locator::start(Location<N> &loc, int point, N &root, Mesh &mesh)
+{
+    loc.stage = DESCEND;
+    loc.point = point;
+    loc.node = &root;
+    loc.dom = mesh.get_domain();
+    loc.level = 0;
+}
+
+template<class N, class D> void Interleaved_Point_Locator::step(Location<N> &loc, vector<Point>& points, vector<int>& results, Mesh &mesh, D &division)
+{
+    Point &p = points[loc.point];
+
+    if(loc.stage == DESCEND)
+    {
+        if(loc.node->is_leaf())
+        {
+            loc.stage = LEAF;
+            loc.it = loc.node->get_t_array_begin();
+            loc.end = loc.node->get_t_array_end();
+            loc.run_id = 0;
+            loc.t_next = 1;
+            loc.t_last = 0;
+            if(loc.it != loc.end)
+                __builtin_prefetch(&*loc.it);
+            return;
+        }
+
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(loc.dom,loc.level,son_doms);
+        for (int i = 0; i < division.son_number(); i++)
+        {
+            if(son_doms[i].contains(p,mesh.get_domain().get_max()))
+            {
+                loc.node = loc.node->get_son(i);
+                loc.dom = son_doms[i];
+                loc.level++;
+                __builtin_prefetch(loc.node);
+                return;
+            }
+        }
+        // no son contains the point
+        loc.stage = DONE;
+        return;
+    }
+
+    // LEAF stage: a batch of the current run is tested
+    if(loc.t_next <= loc.t_last)
+    {
+        int num = min(Geometry_Wrapper::BATCH_SIZE,loc.t_last-loc.t_next+1);
+        int t_ids[Geometry_Wrapper::BATCH_SIZE];
+        for(int i=0; i<num; i++)
+            t_ids[i] = loc.t_next + i;
+        if(this->test_batch(loc,t_ids,num,p,results,mesh))
+            return;
+        loc.t_next += num;
+        // the vertices of the next batch (whose records were prefetched at the previous step) and the records of the following one
+        if(loc.t_next <= loc.t_last)
+        {
+            this->prefetch_vertices(loc.t_next,loc.t_last,mesh);
+            this->prefetch_tetrahedra(loc.t_next+Geometry_Wrapper::BATCH_SIZE,loc.t_last,mesh);
+            return;
+        }
+    }
+
+    if(loc.it == loc.end)
+    {
+        loc.stage = DONE;
+        return;
+    }
+
+    Box bb;
+    pair<int,int> run;
+    if(loc.node->get_run_bounding_box(loc.it,bb,mesh,run,loc.run_id))
+    {
+        ++loc.it;
+        if(bb.contains(p,mesh.get_domain().get_max()))
+        {
+            loc.t_next = run.first;
+            loc.t_last = run.second;
+            this->prefetch_tetrahedra(loc.t_next,loc.t_last,mesh);
+            this->prefetch_tetrahedra(loc.t_next+Geometry_Wrapper::BATCH_SIZE,loc.t_last,mesh);
+        }
+    }
+    else
+    {
+        // the consecutive tetrahedra not encoded in runs are tested together
+        int t_ids[Geometry_Wrapper::BATCH_SIZE];
+        int num = 0;
+        for(; loc.it != loc.end && *loc.it > 0 && num < Geometry_Wrapper::BATCH_SIZE; ++loc.it)
+            t_ids[num++] = *loc.it;
+        if(this->test_batch(loc,t_ids,num,p,results,mesh))
+            return;
+        for(int_vect_iter it=loc.it; it != loc.end && *it > 0 && it < loc.it+Geometry_Wrapper::BATCH_SIZE; ++it)
+            __builtin_prefetch(&mesh.get_tetrahedron(*it));
+    }
+}
+
+#endif // INTERLEAVED_POINT_LOCATOR_H
@@ -0,0 +1,64 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUERY_CONTEXT_H
+#define QUERY_CONTEXT_H
+
+#include "spatial_queries.h"
+#include "topological_queries.h"
+#include "statistics/query_statistics.h"
+#include "utilities/visited_set.h"
+
+/**
+ * @brief A class representing the buffers used to execute single queries on a tree (one at a time).
+ * The buffers are sized on the tetrahedra of the mesh and reused by the successive queries, thus a query does not allocate memory
+ * once the results have reached their largest size.
+ * The tree and the mesh are only read by the queries, thus several threads can query the same tree, each one with its own context.
+ */
+class Query_Context
+{
+public:
+    /**
+     * @brief A constructor method
+     * @param tetrahedra_num an integer representing the number of tetrahedra of the mesh
+     */
+    Query_Context(int tetrahedra_num) : qS(tetrahedra_num,4), checkTetra(tetrahedra_num+1) {}
+
+    ///A public variable representing the executor of the spatial queries
+    Spatial_Queries sq;
+    ///A public variable representing the executor of the topological queries (with its buffers)
+    Topological_Queries tq;
+    ///A public variable containing the result of a box or line query
+    QueryStatistics qS;
+    ///A public variable representing the tetrahedra already tested by a windowed or linearized TT query
+    Visited_Set checkTetra;
+    ///A public variable containing the result of a windowed VT query
+    VT_Result vt;
+    ///A public variable containing the result of a windowed distortion query
+    Distortion_Result dist;
+    ///A public variable containing the result of a windowed or linearized TT query
+    TT_Result tt;
+};
+
+#endif // QUERY_CONTEXT_H
@@ -22,6 +22,52 @@
  */
 
 #include "spatial_queries.h"
+#include <atomic>
+
+int Spatial_Queries::get_workers_num(int queries_num, int threads_num)
+{
+    int chunks_num = (queries_num + QUERY_CHUNK - 1) / QUERY_CHUNK;
+    if(threads_num > chunks_num)
+        threads_num = chunks_num;
+    return (threads_num < 1) ? 1 : threads_num;
+}
+
+void Spatial_Queries::exec_query_chunks(int queries_num, int workers_num, const std::function<void(int,int,int)> &exec_range)
+{
+    if(workers_num == 1)
+    {
+        exec_range(0,0,queries_num);
+        return;
+    }
+
+    std::atomic<int> next_query(0);
+    Thread_Pool pool(workers_num);
+    for(int w=0; w<workers_num; w++)
+    {
+        // the state of a worker is used by a single task, thus it is never accessed concurrently
+        pool.submit([&exec_range,&next_query,queries_num,w]()
+        {
+            int begin;
+            while((begin = next_query.fetch_add(QUERY_CHUNK)) < queries_num)
+                exec_range(w,begin,min(begin+QUERY_CHUNK,queries_num));
+        });
+    }
+    pool.wait();
+}
+
+int Spatial_Queries::merge_workers(vector<Query_Worker> &workers, Statistics &stats, double &tot_time, Latency_Histogram &latency, Perf_Query_Summary &perf)
+{
+    int hit_ratio = 0;
+    for(unsigned w=0; w<workers.size(); w++)
+    {
+        stats.get_query_statistics().merge(workers[w].stats.get_query_statistics());
+        hit_ratio += workers[w].hit_ratio;
+        tot_time += workers[w].tot_time;
+        latency.merge(workers[w].latency);
+        perf.merge(workers[w].perf);
+    }
+    return hit_ratio;
+}
 
 bool Spatial_Queries::atomic_point_in_tetra_test(int tet_id, Point& p, QueryStatistics& qS, Mesh& mesh)
 {
@@ -34,14 +80,81 @@ bool Spatial_Queries::atomic_point_in_tetra_test(int tet_id, Point& p, QueryStat
     return false;
 }
 
+bool Spatial_Queries::batch_point_in_tetra_test(int first_id, int num, Point& p, QueryStatistics& qS, Mesh& mesh)
+{
+    // the lanes exceeding the batch are set too, as the compiler cannot see that gather_batch only reads the first num entries
+    int t_ids[Geometry_Wrapper::BATCH_SIZE] = {0};
+    for(int i=0; i<num; i++)
+        t_ids[i] = first_id + i;
+
+    int inside = Geometry_Wrapper::point_in_tetra_batch(t_ids,num,p,mesh);
+    for(int i=0; i<num; i++)
+    {
+        qS.numGeometricTest++;
+        if(inside & (1 << i))
+        {
+            qS.tetrahedra.push_back(t_ids[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t Spatial_Queries::get_morton_code(Point& p, Box& dom)
+{
+    const uint64_t cells = (1 << 21) - 1;
+    uint64_t code = 0;
+    for(int j=0; j<3; j++)
+    {
+        double extent = dom.get_max().get_c(j) - dom.get_min().get_c(j);
+        double r = (extent > 0) ? (p.get_c(j) - dom.get_min().get_c(j)) / extent : 0;
+        uint64_t q = (r <= 0) ? 0 : ((r >= 1) ? cells : static_cast<uint64_t>(r * cells));
+        for(int b=0; b<21; b++)
+            code |= ((q >> b) & 1) << (3*b + j);
+    }
+    return code;
+}
+
+int Spatial_Queries::locate_points_in_tetra(int t_id, vector<Point>& points, vector<int>& candidates, vector<int>& results, Mesh& mesh)
+{
+    double x[Geometry_Wrapper::BATCH_SIZE], y[Geometry_Wrapper::BATCH_SIZE], z[Geometry_Wrapper::BATCH_SIZE];
+    int found = 0;
+    int kept = 0;
+    for(unsigned c=0; c<candidates.size(); c+=Geometry_Wrapper::BATCH_SIZE)
+    {
+        int num = min(Geometry_Wrapper::BATCH_SIZE,static_cast<int>(candidates.size()-c));
+        for(int i=0; i<Geometry_Wrapper::BATCH_SIZE; i++)
+        {
+            // the lanes exceeding the batch replicate its last point
+            Point &p = points[candidates[c + ((i < num) ? i : num-1)]];
+            x[i] = p.get_x();
+            y[i] = p.get_y();
+            z[i] = p.get_z();
+        }
+        int inside = Geometry_Wrapper::points_in_tetra_batch(t_id,x,y,z,num,mesh);
+        for(int i=0; i<num; i++)
+        {
+            if(inside & (1 << i))
+            {
+                results[candidates[c+i]] = t_id;
+                found++;
+            }
+            else
+                candidates[kept++] = candidates[c+i];
+        }
+    }
+    candidates.resize(kept);
+    return found;
+}
+
 void Spatial_Queries::atomic_tetra_in_box_test(int tet_id, Box &b, QueryStatistics& qS, Mesh& mesh, bool get_stats)
 {
     if(get_stats)
-        qS.access_per_tetra[tet_id]++;
+        qS.access_per_tetra.increment(tet_id);
 
-    if(!qS.checkTetra[tet_id])
+    if(!qS.checkTetra.contains(tet_id))
     {
-        qS.checkTetra[tet_id]=true;
+        qS.checkTetra.insert(tet_id);
 
         if(get_stats)
             qS.numGeometricTest++;
@@ -53,14 +166,24 @@ void Spatial_Queries::atomic_tetra_in_box_test(int tet_id, Box &b, QueryStatisti
     }
 }
 
+void Spatial_Queries::batch_tetra_in_box_test(const int *t_ids, int num, Box &b, QueryStatistics& qS, Mesh& mesh)
+{
+    int inside = Geometry_Wrapper::tetra_in_box_batch(t_ids,num,b,mesh);
+    for(int i=0; i<num; i++)
+    {
+        if(inside & (1 << i))
+            qS.tetrahedra.push_back(t_ids[i]);
+    }
+}
+
 void Spatial_Queries::atomic_line_in_tetra_test(int tet_id, Box &b, QueryStatistics& qS, Mesh& mesh, bool get_stats)
 {
     if(get_stats)
-        qS.access_per_tetra[tet_id]++;
+        qS.access_per_tetra.increment(tet_id);
 
-    if(!qS.checkTetra[tet_id])
+    if(!qS.checkTetra.contains(tet_id))
     {
-        qS.checkTetra[tet_id]=true;
+        qS.checkTetra.insert(tet_id);
 
         if(get_stats)
             qS.numGeometricTest++;
@@ -24,8 +24,14 @@
 #ifndef SPATIAL_QUERIES_H
 #define SPATIAL_QUERIES_H
 
+#include <functional>
+#include <algorithm>
 #include "statistics/statistics.h"
+#include "statistics/latency_histogram.h"
+#include "utilities/perf_counters.h"
 #include "utilities/timer.h"
+#include "utilities/thread_pool.h"
+#include "utilities/sorting.h"
 
 /**
  * @brief The Spatial_Queries class provides an interface for executing spatial queries on the Tetrahedral trees
@@ -42,8 +48,9 @@ public:
      * \param tree a T& argument, represents the tree where the statistics are executed
      * \param query_path a string argument, representing the file path of the query input
      * \param stats a Statistics& argument, representing the object for computing the associated statistics
+     * \param threads_num an integer representing the number of threads among which the queries are distributed
      */
-    template<class T> void exec_point_locations(T& tree, string query_path, Statistics &stats);
+    template<class T> void exec_point_locations(T& tree, string query_path, Statistics &stats, int threads_num = 1);
     ///A public method that excutes box queries, reading the boxes from file
     /*!
      * This method prints the results on standard output
@@ -51,8 +58,9 @@ public:
      * \param tree a T& argument, represents the tree where the statistics are executed
      * \param query_path a string argument, representing the file path of the query input
      * \param stats a Statistics& argument, representing the object for computing the associated statistics
+     * \param threads_num an integer representing the number of threads among which the queries are distributed
      */
-    template<class T> void exec_box_queries(T& tree, string query_path, Statistics &stats);
+    template<class T> void exec_box_queries(T& tree, string query_path, Statistics &stats, int threads_num = 1);
     ///A public method that excutes line queries, reading the lines from file
     /*!
      * This method prints the results on standard output
@@ -60,10 +68,111 @@ public:
      * \param tree a T& argument, represents the tree where the statistics are executed
      * \param query_path a string argument, representing the file path of the query input
      * \param stats a Statistics& argument, representing the object for computing the associated statistics
+     * \param threads_num an integer representing the number of threads among which the queries are distributed
      */
-    template<class T> void exec_line_queries(T& tree, string query_path, Statistics &stats);
+    template<class T> void exec_line_queries(T& tree, string query_path, Statistics &stats, int threads_num = 1);
+    /**
+     * @brief A public method that locates a single point
+     *
+     * @param tree a T& argument, represents the tree where the point is located
+     * @param p a Point& argument, representing the point
+     * @return the tetrahedron containing the point (0 if the point is outside the mesh)
+     */
+    template<class T> int locate_point(T& tree, Point& p);
+    /**
+     * @brief A public method that executes a single box query
+     *
+     * @param tree a T& argument, represents the tree where the query is executed
+     * @param b a Box& argument, representing the box
+     * @param qS a QueryStatistics& argument, sized on the tetrahedra of the mesh, whose tetrahedra are set with the ones intersecting the box
+     */
+    template<class T> void box_query(T& tree, Box& b, QueryStatistics& qS);
+    /**
+     * @brief A public method that executes a single line query
+     * NOTA: the faces of the tetrahedra must be coherently oriented (see Geometry_Wrapper::set_faces_ordering)
+     *
+     * @param tree a T& argument, represents the tree where the query is executed
+     * @param b a Box& argument, representing the line (by the minimum and maximum points of the box)
+     * @param qS a QueryStatistics& argument, sized on the tetrahedra of the mesh, whose tetrahedra are set with the ones intersecting the line (sorted)
+     */
+    template<class T> void line_query(T& tree, Box& b, QueryStatistics& qS);
+    /**
+     * @brief A public method that locates a batch of points with a single traversal of the tree
+     * The points are first sorted on their Morton codes, so that spatially close points are processed together.
+     * Then, at each node the points are partitioned among the sons, thus all the points falling in the same leaf are located together:
+     * the tetrahedra of the leaf, and the bounding boxes of its runs, are visited once and tested against several points at a time.
+     * The results are the same of a point location executed for each point.
+     *
+     * @param tree a T& argument, represents the tree where the points are located
+     * @param points a vector<Point>& containing the points to locate
+     * @param results a vector<int>& that is set, for each point, with the tetrahedron containing it (0 if the point is outside the mesh)
+     * @param threads_num an integer representing the number of threads used to sort the points
+     */
+    template<class T> void locate_points(T& tree, vector<Point>& points, vector<int>& results, int threads_num = 1);
+    ///A public method that excutes a batched point location, reading the points from file
+    /*!
+     * This method prints the results on standard output
+     *
+     * \param tree a T& argument, represents the tree where the points are located
+     * \param query_path a string argument, representing the file path of the query input
+     * \param threads_num an integer representing the number of threads used to sort the points
+     */
+    template<class T> void exec_batched_point_locations(T& tree, string query_path, int threads_num = 1);
+    /**
+     * @brief A public method that sets the path (without extension) of the files in which the point, box and line query drivers
+     * write the percentiles of the query latencies (see Writer::write_latency_stats). With an empty path only the standard output is used.
+     */
+    inline void set_latency_path(string path) { this->latency_path = path; }
 
 private:
+    string latency_path;
+
+    /**
+     * @brief A private struct representing the state of a thread executing a subset of the queries.
+     * Each thread owns its query statistics (and thus its visited sets), that are merged once all the queries are executed.
+     */
+    struct Query_Worker
+    {
+        QueryStatistics qS;
+        Statistics stats;
+        int hit_ratio;
+        double tot_time;
+        Latency_Histogram latency;
+        Perf_Query_Summary perf;
+
+        Query_Worker(const QueryStatistics &q) : qS(q) { this->hit_ratio = 0; this->tot_time = 0; }
+    };
+    ///the number of consecutive queries assigned to a thread at a time
+    static const int QUERY_CHUNK = 64;
+
+    /**
+     * @brief A private method that returns the number of threads to use for a set of queries
+     * @param queries_num an integer representing the number of queries
+     * @param threads_num an integer representing the number of threads requested
+     * @return an integer between 1 and threads_num
+     */
+    int get_workers_num(int queries_num, int threads_num);
+    /**
+     * @brief A private method that distributes a set of queries among the threads
+     * The queries are split in chunks of QUERY_CHUNK consecutive queries, that are dynamically assigned to the threads.
+     * With a single worker the queries are executed by the calling thread.
+     *
+     * @param queries_num an integer representing the number of queries
+     * @param workers_num an integer representing the number of threads (and of workers)
+     * @param exec_range a procedure executing the queries in the range [begin,end) with the state of the given worker
+     */
+    void exec_query_chunks(int queries_num, int workers_num, const std::function<void(int w, int begin, int end)> &exec_range);
+    /**
+     * @brief A private method that merges the statistics of the workers
+     * @param workers a vector containing the workers
+     * @param stats a Statistics& argument, in which the queries statistics are merged
+     * @param tot_time a double& argument, set with the sum of the query times of the workers
+     * @param latency a Latency_Histogram& argument, in which the latencies of the queries are merged
+     * @param perf a Perf_Query_Summary& argument, in which the hardware counters of the queries are merged
+     * @return the number of queries with a non-empty result
+     */
+    int merge_workers(vector<Query_Worker> &workers, Statistics &stats, double &tot_time, Latency_Histogram &latency, Perf_Query_Summary &perf);
+
     ///A private method that executes a single point location on a Tetrahedral tree
     /*!
      * \param n a N& argument, representing the current node to visit
@@ -75,6 +184,55 @@ private:
      * \param division a D& argument, representing the tree subdivision
      */
     template<class N, class D> void exec_point_query(N& n, Box& dom, int level, Point& p, QueryStatistics& qS, Mesh& mesh, D& division);
+    /**
+     * @brief A private method that computes the Morton code of a point, quantizing its coordinates on 21 bits w.r.t. a domain
+     * @param p a Point& argument, representing the point
+     * @param dom a Box& argument, representing the domain
+     * @return the Morton code of the point
+     */
+    uint64_t get_morton_code(Point& p, Box& dom);
+    /**
+     * @brief A private method that locates a subset of the points in a subtree
+     *
+     * @param n a N& argument, representing the current node to visit
+     * @param dom a Box& argument, representing the node domain
+     * @param level an integer argument representing the level of n in the hierarchy
+     * @param points a vector<Point>& containing all the points of the batch
+     * @param begin a pointer to the first index of the points falling in the domain of n
+     * @param end a pointer past the last index of the points falling in the domain of n
+     * @param results a vector<int>& containing the tetrahedra found for the points
+     * @param candidates a vector<int>& used as buffer in the leaves
+     * @param mesh a Mesh& argument, representing the current mesh
+     * @param division a D& argument, representing the tree subdivision
+     */
+    template<class N, class D> void locate_points(N& n, Box& dom, int level, vector<Point>& points, int *begin, int *end, vector<int>& results,
+                                                  vector<int>& candidates, Mesh& mesh, D& division);
+    /**
+     * @brief A private method that locates a subset of the points in the tetrahedra of a leaf
+     * The tetrahedra array is visited once: the points contained in the bounding box of a run (or all of them, for a single tetrahedron)
+     * are tested against the tetrahedra, BATCH_SIZE points at a time, and each point is assigned to the first tetrahedron containing it
+     *
+     * @param n a N& argument, representing the current leaf
+     * @param points a vector<Point>& containing all the points of the batch
+     * @param begin a pointer to the first index of the points falling in the leaf
+     * @param end a pointer past the last index of the points falling in the leaf
+     * @param results a vector<int>& containing the tetrahedra found for the points
+     * @param candidates a vector<int>& used as buffer
+     * @param mesh a Mesh& argument, representing the current mesh
+     */
+    template<class N> void locate_points_in_leaf(N& n, vector<Point>& points, int *begin, int *end, vector<int>& results, vector<int>& candidates, Mesh& mesh);
+    /**
+     * @brief A private method that tests a set of points against a tetrahedron, BATCH_SIZE points at a time
+     * The points contained in the tetrahedron are assigned to it and removed from the set
+     *
+     * @param t_id an integer representing the tetrahedron
+     * @param points a vector<Point>& containing all the points of the batch
+     * @param candidates a vector<int>& containing the indices of the points to test
+     * @param results a vector<int>& containing the tetrahedra found for the points
+     * @param mesh a Mesh& argument, representing the current mesh
+     * @return the number of points contained in the tetrahedron
+     */
+    int locate_points_in_tetra(int t_id, vector<Point>& points, vector<int>& candidates, vector<int>& results, Mesh& mesh);
     ///A private method that executes a single box query on a Tetrahedral tree
     /*!
      * \param n a N& argument, representing the actual node to visit
@@ -115,6 +273,17 @@ private:
      * @return true if an intersection exists, false otherwise
      */
     bool atomic_point_in_tetra_test(int tet_id, Point& p, QueryStatistics& qS, Mesh& mesh);
+    /**
+     * @brief A private method executing a point-in-tetra test on a batch of consecutive tetrahedra
+     * The statistics are updated as if the tetrahedra were tested one at a time, stopping at the first one containing the point
+     * @param first_id an integer representing the first tetrahedron of the batch
+     * @param num an integer representing the number of tetrahedra of the batch (at most Geometry_Wrapper::BATCH_SIZE)
+     * @param p a Point& argument, representing the point query
+     * @param qS a QueryStatistics& argument, representing the object in which the statistics are saved
+     * @param mesh a Mesh& argument, representing the current mesh
+     * @return true if an intersection exists, false otherwise
+     */
+    bool batch_point_in_tetra_test(int first_id, int num, Point& p, QueryStatistics& qS, Mesh& mesh);
     ///A private method that executes a box query in a leaf
     /*!
      * \param n a N& argument, representing the actual leaf
@@ -134,6 +303,17 @@ private:
      * @param get_stats a boolean, true if statistics must be computed, false otherwise
      */
     void atomic_tetra_in_box_test(int tet_id, Box& b, QueryStatistics& qS, Mesh& mesh, bool get_stats);
+    /**
+     * @brief A private method executing a tetra-in-box test on a batch of tetrahedra, adding the ones intersecting the box to the result set
+     * NOTA: the tetrahedra must be already flagged as checked
+     *
+     * @param t_ids an array containing the tetrahedra to test
+     * @param num an integer representing the number of tetrahedra of the batch (at most Geometry_Wrapper::BATCH_SIZE)
+     * @param b a Box& argument, representing the box query
+     * @param qS a QueryStatistics& argument, representing the object in which the statistics are saved
+     * @param mesh a Mesh& argument, representing the current mesh
+     */
+    void batch_tetra_in_box_test(const int *t_ids, int num, Box& b, QueryStatistics& qS, Mesh& mesh);
     /**
      * @brief A private method that adds the tetrahedra in a leaf to the result set
      * NOTA: this procedures simply add all the tetrahedra as the domain of the leaf is completely contained by the box QueryStatistics
@@ -165,115 +345,327 @@ private:
     void atomic_line_in_tetra_test(int tet_id, Box &b, QueryStatistics& qS, Mesh& mesh, bool get_stats);
 };
 
-template<class T> void Spatial_Queries::exec_point_locations(T& tree, string query_path, Statistics &stats)
+template<class T> void Spatial_Queries::exec_point_locations(T& tree, string query_path, Statistics &stats, int threads_num)
 {
-    QueryStatistics qS = QueryStatistics();
     vector<Point> points;
     Reader::read_queries(points,query_path);
 
-    Timer time;
-    double tot_time = 0;
-    int hit_ratio = 0;
+    vector<int> results(points.size());
+    vector<Query_Worker> workers(this->get_workers_num(points.size(),threads_num), Query_Worker(QueryStatistics()));
 
-    for(unsigned i=0;i<points.size();i++)
+    Timer wall_time;
+    Perf_Counters phase_counters(true);
+    phase_counters.start();
+    wall_time.start();
+    this->exec_query_chunks(points.size(),workers.size(),[&](int w, int begin, int end)
     {
-        time.start();
-        this->exec_point_query(tree.get_root(),tree.get_mesh().get_domain(),0,points[i],qS, tree.get_mesh(),tree.get_decomposition());
-        time.stop();
-        tot_time += time.get_elapsed_time();
+        Query_Worker &worker = workers[w];
+        Perf_Counters counters;
+        for(int i=begin; i<end; i++)
+        {
+            counters.start();
+            uint64_t start = Latency_Histogram::get_time_ns();
+            this->exec_point_query(tree.get_root(),tree.get_mesh().get_domain(),0,points[i],worker.qS, tree.get_mesh(),tree.get_decomposition());
+            uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+            counters.stop();
+            worker.perf.add(counters);
+            worker.tot_time += elapsed * 1e-9;
+            worker.latency.record(elapsed,worker.qS.numNode,worker.qS.numGeometricTest);
+
+            results[i] = worker.qS.tetrahedra.size();
+            worker.hit_ratio += worker.stats.compute_queries_statistics(worker.qS);
+            worker.qS.reset();
+        }
+    });
+    wall_time.stop();
+    phase_counters.stop();
 
-        //debug print
-        if(qS.tetrahedra.size()>0)
+    //debug print
+    for(unsigned i=0;i<points.size();i++)
+    {
+        if(results[i]>0)
             cout<<"found tetra for point "<<i<<endl;
         else
             cout<<"nothing found for point "<<i<<endl;
-
-        hit_ratio += stats.compute_queries_statistics(qS);
-        qS.reset();
     }
+
+    double tot_time = 0;
+    Latency_Histogram latency;
+    Perf_Query_Summary perf;
+    int hit_ratio = this->merge_workers(workers,stats,tot_time,latency,perf);
     cerr<<"[TIME] exec point locations "<<tot_time<<endl;
+    if(workers.size() > 1)
+        cerr<<"[TIME] exec point locations (wall clock, "<<workers.size()<<" threads) "<<wall_time.get_elapsed_time()<<endl;
+    phase_counters.print_counters("exec point locations");
+    perf.print_counters("point locations");
 
     Writer::write_queries_stats(points.size(),stats.get_query_statistics(),hit_ratio);
+    if(!Writer::write_latency_stats("point",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
     points.clear();
 }
 
-template<class T> void Spatial_Queries::exec_box_queries(T& tree, string query_path, Statistics &stats)
+template<class T> void Spatial_Queries::exec_box_queries(T& tree, string query_path, Statistics &stats, int threads_num)
 {
-    QueryStatistics qS = QueryStatistics(tree.get_mesh().get_num_tetrahedra(),4);
-
     vector<Box> boxes;
     Reader::read_queries(boxes,query_path);
 
-    Timer time;
-    double tot_time = 0;
-    int hit_ratio = 0;
+    vector<int> results(boxes.size());
+    vector<Query_Worker> workers(this->get_workers_num(boxes.size(),threads_num), Query_Worker(QueryStatistics(tree.get_mesh().get_num_tetrahedra(),4)));
 
-    for(unsigned j=0;j<boxes.size();j++)
+    Timer wall_time;
+    Perf_Counters phase_counters(true);
+    phase_counters.start();
+    wall_time.start();
+    this->exec_query_chunks(boxes.size(),workers.size(),[&](int w, int begin, int end)
     {
-//        cout<<"B: "<<boxes[j]<<endl;
-        // exec for timings
-        time.start();
-        this->exec_box_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],qS, tree.get_mesh(),tree.get_decomposition(),false);
-        time.stop();
-        tot_time += time.get_elapsed_time();
-
-        // exec again for stats
-        qS.reset(false);
-        this->exec_box_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],qS, tree.get_mesh(),tree.get_decomposition(),true);
-
-        //debug print
-        cout<<qS.tetrahedra.size()<<" intersect box "<<j<<endl;
-//        int a; cin>>a;
+        Query_Worker &worker = workers[w];
+        Perf_Counters counters;
+        QueryStatistics &qS = worker.qS;
+        for(int j=begin; j<end; j++)
+        {
+            // exec for timings
+            counters.start();
+            uint64_t start = Latency_Histogram::get_time_ns();
+            this->exec_box_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],qS, tree.get_mesh(),tree.get_decomposition(),false);
+            uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+            counters.stop();
+            worker.perf.add(counters);
+            worker.tot_time += elapsed * 1e-9;
+
+            // exec again for stats
+            qS.reset(false);
+            this->exec_box_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],qS, tree.get_mesh(),tree.get_decomposition(),true);
+            worker.latency.record(elapsed,qS.numNode,qS.numGeometricTest);
+
+            results[j] = qS.tetrahedra.size();
+            worker.hit_ratio += worker.stats.compute_queries_statistics(qS);
+            qS.reset(true);
+        }
+    });
+    wall_time.stop();
+    phase_counters.stop();
 
-        hit_ratio += stats.compute_queries_statistics(qS);
-        qS.reset(true);
-    }
+    //debug print
+    for(unsigned j=0;j<boxes.size();j++)
+        cout<<results[j]<<" intersect box "<<j<<endl;
+
+    double tot_time = 0;
+    Latency_Histogram latency;
+    Perf_Query_Summary perf;
+    int hit_ratio = this->merge_workers(workers,stats,tot_time,latency,perf);
     cerr<<"[TIME] exec box queries "<<tot_time<<endl;
+    if(workers.size() > 1)
+        cerr<<"[TIME] exec box queries (wall clock, "<<workers.size()<<" threads) "<<wall_time.get_elapsed_time()<<endl;
+    phase_counters.print_counters("exec box queries");
+    perf.print_counters("box queries");
 
     Writer::write_queries_stats(boxes.size(),stats.get_query_statistics(),hit_ratio);
+    if(!Writer::write_latency_stats("box",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
     boxes.clear();
 }
 
-template<class T> void Spatial_Queries::exec_line_queries(T& tree, string query_path, Statistics &stats)
+template<class T> void Spatial_Queries::exec_line_queries(T& tree, string query_path, Statistics &stats, int threads_num)
 {
-    QueryStatistics qS = QueryStatistics(tree.get_mesh().get_num_tetrahedra(),8);
-
     vector<Box> boxes;
     Reader::read_queries(boxes,query_path);
 
-    Timer time;
-    double tot_time = 0;
-    int hit_ratio = 0;
+    vector<int> results(boxes.size());
+    vector<Query_Worker> workers(this->get_workers_num(boxes.size(),threads_num), Query_Worker(QueryStatistics(tree.get_mesh().get_num_tetrahedra(),8)));
 
-    for(unsigned j=0;j<boxes.size();j++)
+    Timer wall_time;
+    Perf_Counters phase_counters(true);
+    phase_counters.start();
+    wall_time.start();
+    this->exec_query_chunks(boxes.size(),workers.size(),[&](int w, int begin, int end)
     {
-        // exec for timings
-        time.start();
-        this->exec_line_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],/*line_length,*/qS, tree.get_mesh(),tree.get_decomposition(),false);
-        std::sort(qS.tetrahedra.begin(),qS.tetrahedra.end());
-        vector<int>::iterator last_pos = std::unique(qS.tetrahedra.begin(),qS.tetrahedra.end());
-        qS.tetrahedra.resize(std::distance(qS.tetrahedra.begin(),last_pos));
-        time.stop();
-        tot_time += time.get_elapsed_time();
-
-        qS.reset(false);
-        this->exec_line_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],qS, tree.get_mesh(),tree.get_decomposition(),true);
-        std::sort(qS.tetrahedra.begin(),qS.tetrahedra.end());
-        std::unique(qS.tetrahedra.begin(),qS.tetrahedra.end());
-        qS.tetrahedra.resize(std::distance(qS.tetrahedra.begin(),last_pos));
-        hit_ratio += stats.compute_queries_statistics(qS);
-
-        //debug print
-        cout<<qS.tetrahedra.size()<<" intersect line "<<j<<" "<<boxes[j]<<endl;
-        qS.reset(true);
-    }
+        Query_Worker &worker = workers[w];
+        Perf_Counters counters;
+        QueryStatistics &qS = worker.qS;
+        for(int j=begin; j<end; j++)
+        {
+            // exec for timings
+            counters.start();
+            uint64_t start = Latency_Histogram::get_time_ns();
+            this->exec_line_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],/*line_length,*/qS, tree.get_mesh(),tree.get_decomposition(),false);
+            std::sort(qS.tetrahedra.begin(),qS.tetrahedra.end());
+            vector<int>::iterator last_pos = std::unique(qS.tetrahedra.begin(),qS.tetrahedra.end());
+            qS.tetrahedra.resize(std::distance(qS.tetrahedra.begin(),last_pos));
+            uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+            counters.stop();
+            worker.perf.add(counters);
+            worker.tot_time += elapsed * 1e-9;
+
+            qS.reset(false);
+            this->exec_line_query(tree.get_root(),tree.get_mesh().get_domain(),0,boxes[j],qS, tree.get_mesh(),tree.get_decomposition(),true);
+            std::sort(qS.tetrahedra.begin(),qS.tetrahedra.end());
+            std::unique(qS.tetrahedra.begin(),qS.tetrahedra.end());
+            qS.tetrahedra.resize(std::distance(qS.tetrahedra.begin(),last_pos));
+            worker.hit_ratio += worker.stats.compute_queries_statistics(qS);
+            worker.latency.record(elapsed,qS.numNode,qS.numGeometricTest);
+
+            results[j] = qS.tetrahedra.size();
+            qS.reset(true);
+        }
+    });
+    wall_time.stop();
+    phase_counters.stop();
+
+    //debug print
+    for(unsigned j=0;j<boxes.size();j++)
+        cout<<results[j]<<" intersect line "<<j<<" "<<boxes[j]<<endl;
+
+    double tot_time = 0;
+    Latency_Histogram latency;
+    Perf_Query_Summary perf;
+    int hit_ratio = this->merge_workers(workers,stats,tot_time,latency,perf);
     cerr<<"[TIME] exec line queries "<<tot_time<<endl;
+    if(workers.size() > 1)
+        cerr<<"[TIME] exec line queries (wall clock, "<<workers.size()<<" threads) "<<wall_time.get_elapsed_time()<<endl;
+    phase_counters.print_counters("exec line queries");
+    perf.print_counters("line queries");
     cerr<<"avg geom test: "<<stats.get_query_statistics().avgGeometricTest/(double)hit_ratio<<endl;
 
     Writer::write_queries_stats(boxes.size(),stats.get_query_statistics(),hit_ratio);
+    if(!Writer::write_latency_stats("line",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
     boxes.clear();
 }
 
+template<class T> int Spatial_Queries::locate_point(T& tree, Point& p)
+{
+    QueryStatistics qS;
+    this->exec_point_query(tree.get_root(),tree.get_mesh().get_domain(),0,p,qS,tree.get_mesh(),tree.get_decomposition());
+    return qS.tetrahedra.empty() ? 0 : qS.tetrahedra[0];
+}
+
+template<class T> void Spatial_Queries::box_query(T& tree, Box& b, QueryStatistics& qS)
+{
+    qS.reset(true);
+    this->exec_box_query(tree.get_root(),tree.get_mesh().get_domain(),0,b,qS,tree.get_mesh(),tree.get_decomposition(),false);
+}
+
+template<class T> void Spatial_Queries::line_query(T& tree, Box& b, QueryStatistics& qS)
+{
+    qS.reset(true);
+    this->exec_line_query(tree.get_root(),tree.get_mesh().get_domain(),0,b,qS,tree.get_mesh(),tree.get_decomposition(),false);
+    std::sort(qS.tetrahedra.begin(),qS.tetrahedra.end());
+    qS.tetrahedra.erase(std::unique(qS.tetrahedra.begin(),qS.tetrahedra.end()),qS.tetrahedra.end());
+}
+
+template<class T> void Spatial_Queries::locate_points(T& tree, vector<Point>& points, vector<int>& results, int threads_num)
+{
+    results.assign(points.size(),0);
+    if(points.empty())
+        return;
+
+    // the points are visited following their Morton order
+    vector<code_vertex_pair> codes(points.size());
+    for(unsigned i=0; i<points.size(); i++)
+    {
+        codes[i].v = i;
+        codes[i].code = this->get_morton_code(points[i],tree.get_mesh().get_domain());
+    }
+    Thread_Pool pool(threads_num);
+    radix_sorting(codes,pool);
+
+    vector<int> ids(points.size());
+    for(unsigned i=0; i<codes.size(); i++)
+        ids[i] = codes[i].v;
+    codes.clear();
+
+    vector<int> candidates;
+    this->locate_points(tree.get_root(),tree.get_mesh().get_domain(),0,points,&ids[0],&ids[0]+ids.size(),results,candidates,tree.get_mesh(),tree.get_decomposition());
+}
+
+template<class T> void Spatial_Queries::exec_batched_point_locations(T& tree, string query_path, int threads_num)
+{
+    vector<Point> points;
+    Reader::read_queries(points,query_path);
+    vector<int> results;
+
+    Timer time;
+    Perf_Counters phase_counters(true);
+    phase_counters.start();
+    time.start();
+    this->locate_points(tree,points,results,threads_num);
+    time.stop();
+    phase_counters.stop();
+
+    //debug print
+    int hit_ratio = 0;
+    for(unsigned i=0;i<points.size();i++)
+    {
+        if(results[i]>0)
+        {
+            cout<<"found tetra for point "<<i<<endl;
+            hit_ratio++;
+        }
+        else
+            cout<<"nothing found for point "<<i<<endl;
+    }
+    cerr<<"[TIME] exec batched point locations "<<time.get_elapsed_time()<<endl;
+    phase_counters.print_counters("exec batched point locations");
+    cerr<<"hit_ratio: "<<hit_ratio<<endl;
+}
+
+template<class N, class D> void Spatial_Queries::locate_points(N& n, Box& dom, int level, vector<Point>& points, int *begin, int *end, vector<int>& results,
+                                                               vector<int>& candidates, Mesh& mesh, D& division)
+{
+    if (n.is_leaf())
+    {
+        this->locate_points_in_leaf(n,points,begin,end,results,candidates,mesh);
+    }
+    else
+    {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
+        for (int i = 0; i < division.son_number() && begin != end; i++)
+        {
+            Box &son_dom = son_doms[i];
+            // as in exec_point_query, a point is assigned to the first son containing it
+            // (the stable partition keeps the Morton order of the points)
+            int *son_end = std::stable_partition(begin,end,[&](int p){ return son_dom.contains(points[p],mesh.get_domain().get_max()); });
+            if(son_end != begin)
+                this->locate_points(*n.get_son(i),son_dom,level+1,points,begin,son_end,results,candidates,mesh,division);
+            begin = son_end;
+        }
+    }
+}
+
+template<class N> void Spatial_Queries::locate_points_in_leaf(N &n, vector<Point>& points, int *begin, int *end, vector<int>& results, vector<int>& candidates, Mesh &mesh)
+{
+    Box bb;
+    pair<int,int> run;
+    int run_id = 0;
+
+    // the points not located yet are kept in [begin,end)
+    for(vector<int>::iterator it=n.get_t_array_begin(); it!=n.get_t_array_end() && begin != end; ++it)
+    {
+        int found = 0;
+        candidates.clear();
+        if(n.get_run_bounding_box(it,bb,mesh,run,run_id))
+        {
+            for(int *p=begin; p!=end; ++p)
+            {
+                if(bb.contains(points[*p],mesh.get_domain().get_max()))
+                    candidates.push_back(*p);
+            }
+            for(int t_id=run.first; t_id<=run.second && !candidates.empty(); t_id++)
+                found += this->locate_points_in_tetra(t_id,points,candidates,results,mesh);
+        }
+        else
+        {
+            candidates.assign(begin,end);
+            found += this->locate_points_in_tetra(*it,points,candidates,results,mesh);
+        }
+
+        if(found > 0)
+            end = std::remove_if(begin,end,[&](int p){ return results[p] != 0; });
+    }
+}
+
 template<class N, class D> void Spatial_Queries::exec_point_query(N &n, Box &dom, int level, Point &p, QueryStatistics &qS, Mesh &mesh, D &division)
 {
     qS.numNode++;
@@ -302,16 +694,17 @@ template<class N> void Spatial_Queries::exec_point_query_leaf(N &n, Point &p, Qu
 {
     Box bb;
     pair<int,int> run;
+    int run_id = 0;
 
     for(vector<int>::iterator it=n.get_t_array_begin(); it!=n.get_t_array_end(); ++it)
     {
-        if(n.get_run_bounding_box(it,bb,mesh,run))
+        if(n.get_run_bounding_box(it,bb,mesh,run,run_id))
         {
             if(bb.contains(p,mesh.get_domain().get_max()))
             {
-                for(int t_id=run.first; t_id<=run.second; t_id++)
+                for(int t_id=run.first; t_id<=run.second; t_id+=Geometry_Wrapper::BATCH_SIZE)
                 {
-                    if(atomic_point_in_tetra_test(t_id,p,qS,mesh))
+                    if(batch_point_in_tetra_test(t_id,min(Geometry_Wrapper::BATCH_SIZE,run.second-t_id+1),p,qS,mesh))
                         return;
                 }
             }
@@ -389,9 +782,11 @@ template<class N, class D> void Spatial_Queries::exec_box_query(N &n, Box &dom,
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->exec_box_query(*n.get_son(i), son_dom, son_level, b, qS, mesh,division, get_stats);
         }
@@ -402,10 +797,11 @@ template<class N> void Spatial_Queries::exec_box_query_leaf_test(N &n, Box &b, Q
 {
     Box bb;
     pair<int,int> run;
+    int run_id = 0;
 
     for(vector<int>::iterator it=n.get_t_array_begin(); it!=n.get_t_array_end(); ++it)
     {
-        if(n.get_run_bounding_box(it,bb,mesh,run))
+        if(n.get_run_bounding_box(it,bb,mesh,run,run_id))
         {
 //            if(get_stats)
 //            {
@@ -424,11 +820,11 @@ template<class N> void Spatial_Queries::exec_box_query_leaf_test(N &n, Box &b, Q
                 for(int t_id=run.first; t_id<=run.second; t_id++)
                 {
                     if(get_stats)
-                        qS.access_per_tetra[t_id]++;
+                        qS.access_per_tetra.increment(t_id);
 
-                    if(!qS.checkTetra[t_id])
+                    if(!qS.checkTetra.contains(t_id))
                     {
-                        qS.checkTetra[t_id]=true;
+                        qS.checkTetra.insert(t_id);
                         qS.tetrahedra.push_back(t_id);
 
                         if(get_stats)
@@ -448,13 +844,33 @@ template<class N> void Spatial_Queries::exec_box_query_leaf_test(N &n, Box &b, Q
 //                if(get_stats)
 //                    cerr<<"b intersects bbox: checking -> "<<run.second-run.first<<endl;
 
+                int batch[Geometry_Wrapper::BATCH_SIZE];
+                int batch_size = 0;
                 for(int t_id=run.first; t_id<=run.second; t_id++)
                 {
                     if(get_stats)
-                        if(!qS.checkTetra[t_id])
+                        qS.access_per_tetra.increment(t_id);
+
+                    if(!qS.checkTetra.contains(t_id))
+                    {
+                        qS.checkTetra.insert(t_id);
+
+                        if(get_stats)
+                        {
                             qS.box_intersect_bbox_geom_tests_num++;
-                    atomic_tetra_in_box_test(t_id,b,qS,mesh,get_stats);
+                            qS.numGeometricTest++;
+                        }
+
+                        batch[batch_size++] = t_id;
+                        if(batch_size == Geometry_Wrapper::BATCH_SIZE)
+                        {
+                            batch_tetra_in_box_test(batch,batch_size,b,qS,mesh);
+                            batch_size = 0;
+                        }
+                    }
                 }
+                if(batch_size > 0)
+                    batch_tetra_in_box_test(batch,batch_size,b,qS,mesh);
             }
             else if(get_stats) // bbox does not intesect the search box
             {
@@ -467,9 +883,9 @@ template<class N> void Spatial_Queries::exec_box_query_leaf_test(N &n, Box &b, Q
                     /// computing the statistics like this (i.e., by flagging as visited also these tops)
                     /// affects the stat about the average geometric tests executed
                     ///
-                    if(!qS.checkTetra[t_id] && !qS.avoid_to_check_tetra[t_id])
+                    if(!qS.checkTetra.contains(t_id) && !qS.avoid_to_check_tetra.contains(t_id))
                     {
-                        qS.avoid_to_check_tetra[t_id]=true;
+                        qS.avoid_to_check_tetra.insert(t_id);
                         //if(get_stats)
                         qS.avoided_tetra_geom_tests_num++;
                     }
@@ -490,11 +906,11 @@ template<class N> void Spatial_Queries::add_tetrahedra_to_box_query_result(N& n,
     {
         RunIterator const& tet_id = itPair.first;
         if(get_stats)
-            qS.access_per_tetra[*tet_id]++;
+            qS.access_per_tetra.increment(*tet_id);
 
-        if(!qS.checkTetra[*tet_id])
+        if(!qS.checkTetra.contains(*tet_id))
         {
-            qS.checkTetra[*tet_id]=true;
+            qS.checkTetra.insert(*tet_id);
             qS.tetrahedra.push_back(*tet_id);
 
             if(get_stats)
@@ -524,9 +940,11 @@ template<class N, class D> void Spatial_Queries::exec_line_query(N &n, Box &dom,
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->exec_line_query(*n.get_son(i), son_dom, son_level, b, qS, mesh, division, get_stats);
         }
@@ -537,10 +955,11 @@ template<class N> void Spatial_Queries::exec_line_query_leaf(N& n, Box &b, Query
 {
     Box bb;
     pair<int,int> run;
+    int run_id = 0;
 
     for(vector<int>::iterator it=n.get_t_array_begin(); it!=n.get_t_array_end(); ++it)
     {
-        if(n.get_run_bounding_box(it,bb,mesh,run))
+        if(n.get_run_bounding_box(it,bb,mesh,run,run_id))
         {
             if(Geometry_Wrapper::line_in_bounding_box(b.get_min(),b.get_max(),bb))
             {
@@ -24,9 +24,7 @@
 #ifndef TOPOLOGICALQUERIES_H
 #define TOPOLOGICALQUERIES_H
 
-#include <set>
-#include <map>
-#include <boost/dynamic_bitset.hpp>
+#include <functional>
 
 #include "basic_types/vertex.h"
 #include "basic_types/tetrahedron.h"
@@ -34,8 +32,13 @@
 #include "basic_types/box.h"
 #include "tetrahedral_trees/node_v.h"
 #include "tetrahedral_trees/node_t.h"
+#include "tetrahedral_trees/frozen_node.h"
 #include "geometry/geometry_wrapper.h"
 #include "geometry/geometry_distortion.h"
+#include "utilities/visited_set.h"
+#include "utilities/thread_pool.h"
+#include "topological_relations.h"
+#include "windowed_results.h"
 
 using namespace std;
 
@@ -49,11 +52,11 @@ public:
     /**
      * @brief A constructor method
      */
-    Topological_Queries() { }
+    Topological_Queries() { this->visited_nodes_num = this->geometric_tests_num = 0; }
     /**
      * @brief A copy-constructor method
      */
-    Topological_Queries(const Topological_Queries&) {}
+    Topological_Queries(const Topological_Queries&) { this->visited_nodes_num = this->geometric_tests_num = 0; }
     /**
      * @brief A destructor method
      */
@@ -105,50 +108,195 @@ public:
      */
     template<class N, class D> void linearized_TT(N &n, Box &dom, Mesh &mesh, D &division, string query_path);
 
-    template<class N, class D> void batched_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex);
-    template<class N, class D> void batched_TT(N &n, Mesh &mesh, D &division);
+    ///A public method that executes a single windowed VT query
+    /*!
+     * The result is cleared before the query, thus it can be reused for successive queries
+     *
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param b a Box& argument, representing the query box
+     * \param reindexed a boolean, true if the index and the mesh are spatially reordered
+     * \param vt a VT_Result& argument, that is set with the VT relations of the vertices in the box
+     */
+    template<class N, class D> void windowed_VT_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, bool reindexed, VT_Result &vt);
+    ///A public method that executes a single windowed curvature query
+    /*!
+     * The result is cleared before the query, thus it can be reused for successive queries.
+     * NOTA: the border faces of the mesh must be already set (see Border_Checker)
+     *
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param b a Box& argument, representing the query box
+     * \param reindexed a boolean, true if the index and the mesh are spatially reordered
+     * \param dist a Distortion_Result& argument, that is set with the distortion of the vertices in the box
+     */
+    template<class N, class D> void windowed_Distortion_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, bool reindexed, Distortion_Result &dist);
+    ///A public method that executes a single windowed TT query
+    /*!
+     * The result is cleared before the query, thus it can be reused for successive queries
+     *
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param b a Box& argument, representing the query box
+     * \param tt a TT_Result& argument, that is set with the (partial) TT relations of the tetrahedra intersecting the box
+     * \param checkTetra a Visited_Set& argument, with an entry for each tetrahedron, used to mark the tetrahedra already tested
+     */
+    template<class N, class D> void windowed_TT_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, TT_Result &tt, Visited_Set &checkTetra);
+    ///A public method that executes a single linearized TT query
+    /*!
+     * The result is cleared before the query, thus it can be reused for successive queries.
+     * NOTA: the faces of the tetrahedra must be coherently oriented (see Geometry_Wrapper::set_faces_ordering)
+     *
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param b a Box& argument, representing the query line (by the minimum and maximum points of the box)
+     * \param tt a TT_Result& argument, that is set with the (partial) TT relations of the tetrahedra intersecting the line
+     * \param checkTetra a Visited_Set& argument, with an entry for each tetrahedron, used to mark the tetrahedra already tested
+     */
+    template<class N, class D> void linearized_TT_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, TT_Result &tt, Visited_Set &checkTetra);
+
+    ///A public method that extracts the VT relation of the whole mesh with a visit of the leaves, and prints the extraction statistics
+    /*!
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param reindex a boolean, true if the index and the mesh are spatially reordered
+     * \param vt a VT_Relation& argument, that is set with the relation
+     * \param threads_num an integer representing the number of threads processing the leaves
+     */
+    template<class N, class D> void batched_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, VT_Relation &vt, int threads_num = 1);
+    ///A public method that extracts the TT relation of the whole mesh with a visit of the leaves, and prints the extraction statistics
+    /*!
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param reindex a boolean, true if the index and the mesh are spatially reordered
+     * \param tt a TT_Relation& argument, that is set with the relation
+     * \param threads_num an integer representing the number of threads processing the leaves
+     */
+    template<class N, class D> void batched_TT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, TT_Relation &tt, int threads_num = 1);
+    ///A public method that extracts the VT relation of the whole mesh in compressed sparse row form
+    /*!
+     * The leaves are visited twice: first the tetrahedra incident in each vertex are counted, then they are placed
+     * in the slots of their vertices. Each vertex gets its tetrahedra from the leaf that indexes it (or contains it, if reindex is false),
+     * thus, with more than one thread, the leaves are processed in parallel without synchronization.
+     *
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param reindex a boolean, true if the index and the mesh are spatially reordered
+     * \param vt a VT_Relation& argument, that is set with the relation
+     * \param threads_num an integer representing the number of threads processing the leaves
+     */
+    template<class N, class D> void extract_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, VT_Relation &vt, int threads_num = 1);
+    ///A public method that extracts the TT relation of the whole mesh in a flat array
+    /*!
+     * With a single thread, each leaf pairs only the faces not set by the previous leaves.
+     * With more threads, the leaves are processed in parallel: a face is paired only by the leaf indexing its smallest vertex
+     * (or containing it, if reindex is false), thus each entry of the relation is written by a single leaf.
+     *
+     * \param n a N& argument, representing the root of the tree
+     * \param dom a Box& argument, representing the root domain
+     * \param mesh a Mesh& argument, representing the current mesh
+     * \param division a D& argument, representing the tree subdivision type
+     * \param reindex a boolean, true if the index and the mesh are spatially reordered
+     * \param tt a TT_Relation& argument, that is set with the relation
+     * \param threads_num an integer representing the number of threads processing the leaves
+     */
+    template<class N, class D> void extract_TT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, TT_Relation &tt, int threads_num = 1);
+    ///A public method that returns the number of nodes visited by the last windowed or linearized query
+    inline long get_visited_nodes_num() const { return this->visited_nodes_num; }
+    ///A public method that returns the number of geometric tests (on the vertices or on the tetrahedra) executed by the last windowed or linearized query
+    inline long get_geometric_tests_num() const { return this->geometric_tests_num; }
+    /**
+     * @brief A public method that sets the path (without extension) of the files in which the windowed and linearized query drivers
+     * write the percentiles of the query latencies (see Writer::write_latency_stats). With an empty path only the standard output is used.
+     */
+    inline void set_latency_path(string path) { this->latency_path = path; }
 
 private:
+    string latency_path;
+    // the costs of the last windowed or linearized query
+    long visited_nodes_num;
+    long geometric_tests_num;
+    // the geometric tests of the windowed and linearized queries, counted in the query costs
+    inline bool vertex_in_box(const Vertex &v, Box &b) { this->geometric_tests_num++; return b.contains_with_all_closed_faces(v); }
+    inline bool tetra_in_box(int t_id, Box &b, Mesh &mesh) { this->geometric_tests_num++; return Geometry_Wrapper::tetra_in_box(t_id,b,mesh); }
+    inline bool line_in_tetra(Box &b, int t_id, Mesh &mesh) { this->geometric_tests_num++; return Geometry_Wrapper::line_in_tetra(b.get_min(),b.get_max(),t_id,mesh); }
+
     // windowed VT - auxiliary functions
-    template<class D> void windowed_VT(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &vt);
-    template<class N, class D> void windowed_VT_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &vt);
-    template<class D> void windowed_VT(Node_V &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &vt);
-    void windowed_VT_Leaf(Node_T& n, Box &dom, Box &b, Mesh& mesh, map<int,vector<int> > &vt);
-    void windowed_VT_Leaf(Node_V& n, Box &b, Mesh& mesh, map<int,vector<int> > &vt);
-    template<class N> void windowed_VT_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, map<int,vector<int> > &vt);
-    void update_resulting_VT(int v, int t, map<int,vector<int> > &vt);
+    template<class D> void windowed_VT(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, VT_Result &vt);
+    template<class N, class D> void windowed_VT_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, VT_Result &vt);
+    template<class N, class D> void windowed_VT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, VT_Result &vt);
+    void windowed_VT_Leaf(Node_T& n, Box &dom, Box &b, Mesh& mesh, VT_Result &vt);
+    template<class N> void windowed_VT_Leaf(N& n, Box &b, Mesh& mesh, VT_Result &vt);
+    template<class N> void windowed_VT_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, VT_Result &vt);
+    void finalize_VT_Leaf(VT_Result &vt);
     // windowed distortion - auxiliary functions
-    template<class D> void windowed_Distortion(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,double> &dist);
-    template<class N, class D> void windowed_Distortion_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,double> &dist);
-    template<class D> void windowed_Distortion(Node_V &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,double> &dist);
-    void windowed_Distortion_Leaf(Node_T& n, Box &dom, Box &b, Mesh& mesh, map<int,double> &dist);
-    template<class N> void windowed_Distortion_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, map<int,double> &dist);
-    void windowed_Distortion_Leaf(Node_V &n, Box &b, Mesh& mesh, map<int,double> &dist);
-    void update_resulting_distortion(int v, double d, map<int,double> &dist);
-    void finalize_Distortion_Leaf(int v_start, vector<vector<int> > &all_vt, vector<double> &local_distortion, boost::dynamic_bitset<> &isVBorder, Mesh& mesh, map<int,double> &dist);
-    // windowed TT - auxiliary functions
-    template<class N, class D> void windowed_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &tt, bm::bvector<> &checkTetra);
-    template<class N> void windowed_TT_Leaf_test(N& n, Box &b, Mesh& mesh, map<int,vector<int> > &tt, bm::bvector<> &checkTetra);
-    template<class N> void windowed_TT_Leaf_add(N& n, Mesh& mesh, map<int,vector<int> > &tt, bm::bvector<> &checkTetra);
-    void add_faces(int t_id, vector<triangle_tetrahedron_tuple> &faces, Mesh &mesh, map<int,vector<int> >::const_iterator &iter, map<int,vector<int> > &tt);
-    void pair_adjacent_tetrahedra(vector<triangle_tetrahedron_tuple> &faces, Mesh &mesh, map<int, vector<int> > &tt);
-    void update_resulting_TT(int pos, int t1, int t2, map<int,vector<int> > &tt);
-    void init_TT_entry(int t1, map<int,vector<int> > &tt);
+    template<class D> void windowed_Distortion(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, Distortion_Result &dist);
+    template<class N, class D> void windowed_Distortion_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, Distortion_Result &dist);
+    template<class N, class D> void windowed_Distortion(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, Distortion_Result &dist);
+    void windowed_Distortion_Leaf(Node_T& n, Box &dom, Box &b, Mesh& mesh, Distortion_Result &dist);
+    template<class N> void windowed_Distortion_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, Distortion_Result &dist);
+    template<class N> void windowed_Distortion_Leaf(N &n, Box &b, Mesh& mesh, Distortion_Result &dist);
+    // check_border enables the detection of the border vertices, and correct_border selects if the 3D correction is applied on the border vertices or on the others
+    void finalize_Distortion_Leaf(bool check_border, bool correct_border, Mesh& mesh, Distortion_Result &dist);
+    // windowed TT - auxiliary functions (the tetrahedra are identified in the result by their entry)
+    template<class N, class D> void windowed_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, TT_Result &tt, Visited_Set &checkTetra);
+    template<class N> void windowed_TT_Leaf_test(N& n, Box &b, Mesh& mesh, TT_Result &tt, Visited_Set &checkTetra);
+    template<class N> void windowed_TT_Leaf_add(N& n, Mesh& mesh, TT_Result &tt, Visited_Set &checkTetra);
+    void add_faces(int t_id, vector<triangle_tetrahedron_tuple> &faces, Mesh &mesh, int entry, TT_Result &tt);
+    void pair_adjacent_tetrahedra(vector<triangle_tetrahedron_tuple> &faces, Mesh &mesh, TT_Result &tt);
+    void update_resulting_TT(int pos, int t1, int t2, TT_Result &tt);
+    int init_TT_entry(int t1, TT_Result &tt);
     // linearized TT - auxiliary functions
-    template<class N, class D> void linearized_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &tt, bm::bvector<> &checkTetra);
-    template<class N> void linearized_TT_Leaf(N& n, Box &b, Mesh& mesh, map<int,vector<int> > &tt, bm::bvector<> &checkTetra);
+    template<class N, class D> void linearized_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, TT_Result &tt, Visited_Set &checkTetra);
+    template<class N> void linearized_TT_Leaf(N& n, Box &b, Mesh& mesh, TT_Result &tt, Visited_Set &checkTetra);
     // windowed and linearized TT auxiliary function
-    void finalize_TT_Leaf(vector<triangle_tetrahedron_tuple> &faces, map<int,vector<int> > &tt, Mesh &mesh);
-
-    template<class N, class D> void batched_VT_visit(N &n, Box &dom, int level, Mesh &mesh, D &division, bool stats, int &max_entries);
-    template<class N, class D> void batched_VT_no_reindex(N &n, Box &dom, int level, Mesh &mesh, D &division, bool stats, int &max_entries);
-    void batched_VT_leaf(Node_T &n, Box &dom, Mesh &mesh, bool stats, int &max_entries);
-    void batched_VT_leaf(Node_V &n, Box &, Mesh &mesh, bool stats, int &max_entries);
-    void batched_VT_no_reindex_leaf(Node_T &n, Box &dom, Mesh &mesh, bool stats, int &max_entries);
-    void batched_VT_no_reindex_leaf(Node_V &n, Box &dom, Mesh &mesh, bool stats, int &max_entries);
+    void finalize_TT_Leaf(vector<triangle_tetrahedron_tuple> &faces, TT_Result &tt, Mesh &mesh);
+    // the buffers of the leaves visited by the windowed queries, reused to avoid an allocation for each leaf
+    Leaf_VT_Buffer leaf_vt;
+    vector<triangle_tetrahedron_tuple> leaf_faces;
 
-    template<class N, class D> void batched_TT_visit(N &n, Mesh &mesh, D &division, vector<vector<int> > &tt, bool stats, int &max_entries);
-    template<class N> void batched_TT_leaf(N &n, Mesh &mesh, vector<vector<int> > &tt, bool stats, int &max_entries);
+    // batched VT - auxiliary functions (the vertex-tetrahedron pairs found in the leaves are passed to the add functor)
+    template<class N, class D> void extract_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, VT_Relation &vt, int &max_entries, int threads_num);
+    template<class N, class D, class F> void batched_VT_visit(N &n, Box &dom, int level, Mesh &mesh, D &division, bool reindex, F &add, int &max_entries);
+    template<class N, class F> void batched_VT_leaf(N &n, Box &dom, Mesh &mesh, bool reindex, F &add, int &max_entries);
+    template<class N, class D, class F> void batched_VT_visit(N &n, Box &dom, int level, Mesh &mesh, D &division, F &add, int &max_entries);
+    // on a frozen tree the leaves are visited with a sequential scan of the nodes
+    template<class D, class F> void batched_VT_visit(Frozen_Node &n, Box &dom, int level, Mesh &mesh, D &division, F &add, int &max_entries);
+    template<class N, class D, class F> void batched_VT_no_reindex(N &n, Box &dom, int level, Mesh &mesh, D &division, F &add, int &max_entries);
+    template<class F> void batched_VT_leaf(Node_T &n, Box &dom, Mesh &mesh, F &add, int &max_entries);
+    template<class N, class F> void batched_VT_leaf(N &n, Box &, Mesh &mesh, F &add, int &max_entries);
+    template<class N, class F> void batched_VT_no_reindex_leaf(N &n, Box &dom, Mesh &mesh, F &add, int &max_entries);
+    template<class F> void batched_VT_no_reindex_leaf(Node_V &n, Box &dom, Mesh &mesh, F &add, int &max_entries);
+    // batched TT - auxiliary functions
+    // (returns true if the leaves are processed in parallel, each one pairing only the faces it owns:
+    // then, max_entries counts the owned faces of a leaf, rather than the faces still unpaired when the leaf is visited)
+    template<class N, class D> bool extract_TT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, TT_Relation &tt, int &max_entries, int threads_num);
+    template<class N, class D> void batched_TT_visit(N &n, Mesh &mesh, D &division, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries);
+    template<class D> void batched_TT_visit(Frozen_Node &n, Mesh &mesh, D &division, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries);
+    template<class N> void batched_TT_leaf(N &n, Mesh &mesh, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries);
+    template<class N> void batched_TT_owned_leaf(N &n, Box &dom, Mesh &mesh, bool reindex, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries);
+    // parallel batched extraction - auxiliary functions
+    ///the number of leaves assigned to a thread at a time
+    static const int LEAF_CHUNK = 16;
+    template<class N, class D> void collect_leaves(N &n, Box &dom, int level, D &division, vector<pair<N*,Box> > &leaves);
+    void get_leaf_v_range(Node_T &n, Box &dom, Mesh &mesh, int &v_start, int &v_end) { n.get_v_range(v_start,v_end,dom,mesh); }
+    template<class N> void get_leaf_v_range(N &n, Box &, Mesh &, int &v_start, int &v_end);
+    int get_workers_num(int leaves_num, int threads_num);
+    void exec_leaf_chunks(int leaves_num, int workers_num, const std::function<void(int,int,int)> &exec_range);
 };
 
 #include "topological_queries_windowed.h"
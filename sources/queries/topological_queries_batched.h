@@ -2,109 +2,316 @@
 #define TOPOLOGICAL_QUERIES_BATCHED
 
 #include "topological_queries.h"
+#include "utilities/perf_counters.h"
 
-template<class N, class D> void Topological_Queries::batched_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex)
+template<class N, class D> void Topological_Queries::batched_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, VT_Relation &vt, int threads_num)
 {
 //    cout<<"batched_VT"<<endl;
 
     Timer time;
+    Perf_Counters phase_counters(true);
     int max_entities = 0;
 
+    phase_counters.start();
     time.start();
-    if(reindex)
-        this->batched_VT_visit(n,dom,0,mesh,division,false,max_entities);
-    else
-        this->batched_VT_no_reindex(n,dom,0,mesh,division,false,max_entities);
+    this->extract_VT(n,dom,mesh,division,reindex,vt,max_entities,threads_num);
     time.stop();
+    phase_counters.stop();
     time.print_elapsed_time("[TIME] extracting bactched VT: ");
+    phase_counters.print_counters("extracting batched VT");
+
+    cerr<<"[STATS] maximum number of entities: "<<max_entities<<endl;
+    cerr<<"[MEMORY] VT relation: "<<vt.get_bytes()<<" bytes"<<endl;
+}
+
+template<class N, class D> void Topological_Queries::extract_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, VT_Relation &vt, int threads_num)
+{
+    int max_entities = 0;
+    this->extract_VT(n,dom,mesh,division,reindex,vt,max_entities,threads_num);
+}
+
+template<class N, class D> void Topological_Queries::extract_VT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, VT_Relation &vt, int &max_entries, int threads_num)
+{
+    vector<int> &offsets = vt.get_offsets();
+    vector<int> &tetrahedra = vt.get_tetrahedra();
+
+    // each vertex is indexed by a single leaf, that writes its counter and its slots, thus the leaves can be processed in parallel
+    vector<pair<N*,Box> > leaves;
+    if(threads_num > 1)
+        this->collect_leaves(n,dom,0,division,leaves);
+    int workers_num = this->get_workers_num(leaves.size(),threads_num);
+    vector<int> workers_max(workers_num,0);
+
+    // (1) each leaf counts the tetrahedra incident in the vertices it indexes
+    offsets.assign(mesh.get_num_vertices()+1,0);
+    auto count = [&offsets](int v, int) { offsets[v]++; };
+    if(workers_num == 1)
+        this->batched_VT_visit(n,dom,0,mesh,division,reindex,count,max_entries);
+    else
+    {
+        this->exec_leaf_chunks(leaves.size(),workers_num,[&](int w, int begin, int end)
+        {
+            for(int l=begin; l<end; l++)
+                this->batched_VT_leaf(*leaves[l].first,leaves[l].second,mesh,reindex,count,workers_max[w]);
+        });
+        for(int w=0; w<workers_num; w++)
+            max_entries = max(max_entries,workers_max[w]);
+    }
+
+    for(unsigned v=1; v<offsets.size(); v++)
+        offsets[v] += offsets[v-1];
 
+    // (2) the same visit places the tetrahedra in the slots of their vertices
+    tetrahedra.resize(offsets.back());
+    vector<int> cursors(offsets.begin(),offsets.end()-1);
+    auto fill = [&cursors,&tetrahedra](int v, int t) { tetrahedra[cursors[v-1]++] = t; };
+    int unused = 0;
+    if(workers_num == 1)
+        this->batched_VT_visit(n,dom,0,mesh,division,reindex,fill,unused);
+    else
+    {
+        this->exec_leaf_chunks(leaves.size(),workers_num,[&](int, int begin, int end)
+        {
+            int unused = 0;
+            for(int l=begin; l<end; l++)
+                this->batched_VT_leaf(*leaves[l].first,leaves[l].second,mesh,reindex,fill,unused);
+        });
+    }
+}
+
+template<class N, class D, class F> void Topological_Queries::batched_VT_visit(N &n, Box &dom, int level, Mesh &mesh, D &division, bool reindex, F &add, int &max_entries)
+{
     if(reindex)
-        this->batched_VT_visit(n,dom,0,mesh,division,true,max_entities);
+        this->batched_VT_visit(n,dom,level,mesh,division,add,max_entries);
     else
-        this->batched_VT_no_reindex(n,dom,0,mesh,division,true,max_entities);
-    cerr<<"[STATS] maximum number of entities: "<<max_entities<<endl;
+        this->batched_VT_no_reindex(n,dom,level,mesh,division,add,max_entries);
 }
 
-template<class N, class D> void Topological_Queries::batched_VT_visit(N &n, Box &dom, int level, Mesh &mesh, D &division, bool stats, int &max_entries)
+template<class N, class F> void Topological_Queries::batched_VT_leaf(N &n, Box &dom, Mesh &mesh, bool reindex, F &add, int &max_entries)
+{
+    if(reindex)
+        this->batched_VT_leaf(n,dom,mesh,add,max_entries);
+    else
+        this->batched_VT_no_reindex_leaf(n,dom,mesh,add,max_entries);
+}
+
+template<class N, class D, class F> void Topological_Queries::batched_VT_visit(N &n, Box &dom, int level, Mesh &mesh, D &division, F &add, int &max_entries)
 {
-//    cout<<"ci arrivo"<<endl;
-//    cout<<n<<" "<<dom<<endl;
     if (n.is_leaf())
-    {        
-//        cout<<"batched_VT_leaf"<<endl;
-        this->batched_VT_leaf(n,dom,mesh,stats,max_entries);
+    {
+        this->batched_VT_leaf(n,dom,mesh,add,max_entries);
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             N& son = *n.get_son(i);
-            this->batched_VT_visit(son, son_dom, son_level, mesh, division, stats, max_entries);
+            this->batched_VT_visit(son, son_dom, son_level, mesh, division, add, max_entries);
         }
     }
 }
 
-template<class N, class D> void Topological_Queries::batched_VT_no_reindex(N &n, Box &dom, int level, Mesh &mesh, D &division, bool stats, int &max_entries)
+template<class F> void Topological_Queries::batched_VT_leaf(Node_T &n, Box &dom, Mesh &mesh, F &add, int &max_entries)
+{
+    int v_start;
+    int v_end;
+
+    n.get_v_range(v_start,v_end,dom,mesh); // we need to gather the vertices range..
+
+    if(v_start == v_end) //no internal vertices..
+        return;
+
+    int entries = 0;
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& tet = mesh.get_tetrahedron(*tet_id);
+        for(int v=0; v<tet.vertices_num(); v++)
+        {
+            int real_v_index = tet.TV(v);
+            //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
+            if (n.indexes_vertex(v_start,v_end,real_v_index))
+            {
+                add(real_v_index,*tet_id);
+                entries++;
+            }
+        }
+    }
+
+    if(max_entries < entries)
+        max_entries = entries;
+}
+
+template<class N, class F> void Topological_Queries::batched_VT_leaf(N &n, Box &, Mesh &mesh, F &add, int &max_entries)
+{
+    // here we have a reindexed index thus, if there are no vertices indexed the array size is zero
+    if(n.get_v_array_size() == 0)
+        return;
+
+    int entries = 0;
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& tet = mesh.get_tetrahedron(*tet_id);
+        for(int v=0; v<4; v++)
+        {
+            int real_v_index = tet.TV(v);
+            //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
+            if (n.indexes_vertex(real_v_index))
+            {
+                add(real_v_index,*tet_id);
+                entries++;
+            }
+        }
+    }
+
+    if(max_entries < entries)
+        max_entries = entries;
+}
+
+template<class D, class F> void Topological_Queries::batched_VT_visit(Frozen_Node &n, Box &dom, int, Mesh &mesh, D &, F &add, int &max_entries)
+{
+    // the leaves of a reindexed tree do not need their domain, and the leaves of a frozen subtree are stored contiguously
+    for(int l = n.get_leaves_begin(); l < n.get_leaves_end(); l++)
+        this->batched_VT_leaf(*n.get_leaf(l),dom,mesh,add,max_entries);
+}
+
+template<class N, class D, class F> void Topological_Queries::batched_VT_no_reindex(N &n, Box &dom, int level, Mesh &mesh, D &division, F &add, int &max_entries)
 {
 //    cout<<"batched_VT_no_reindex"<<endl;
     if (n.is_leaf())
     {
-        this->batched_VT_no_reindex_leaf(n,dom,mesh,stats,max_entries);
+        this->batched_VT_no_reindex_leaf(n,dom,mesh,add,max_entries);
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
-            this->batched_VT_no_reindex(*n.get_son(i), son_dom, son_level, mesh, division, stats, max_entries);
+            this->batched_VT_no_reindex(*n.get_son(i), son_dom, son_level, mesh, division, add, max_entries);
         }
     }
 }
 
-template<class N, class D> void Topological_Queries::batched_TT(N &n, Mesh &mesh, D &division)
+template<class N, class F> void Topological_Queries::batched_VT_no_reindex_leaf(N &n, Box &dom, Mesh &mesh, F &add, int &max_entries)
 {
-    int max_entities = 0;
+    int entries = 0;
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& tet = mesh.get_tetrahedron(*tet_id);
+        for(int v=0; v<tet.vertices_num(); v++)
+        {
+            //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
+            if (dom.contains(mesh.get_vertex(tet.TV(v)),mesh.get_domain().get_max()))
+            {
+                add(tet.TV(v),*tet_id);
+                entries++;
+            }
+        }
+    }
 
-    vector<vector<int> > tt;
-    vector<int> tmp;
-    tmp.assign(4,-1);
-    tt.assign(mesh.get_num_tetrahedra(),tmp);
+    if(max_entries < entries)
+        max_entries = entries;
+}
+
+template<class F> void Topological_Queries::batched_VT_no_reindex_leaf(Node_V &n, Box &dom, Mesh &mesh, F &add, int &max_entries)
+{
+    if(n.get_v_array_size() == 0)
+        return; // no vertices.. skip the current leaf block
+
+    this->batched_VT_no_reindex_leaf<Node_V,F>(n,dom,mesh,add,max_entries);
+}
+
+template<class N, class D> void Topological_Queries::batched_TT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, TT_Relation &tt, int threads_num)
+{
+    int max_entities = 0;
 
     Timer time;
+    Perf_Counters phase_counters(true);
+    phase_counters.start();
     time.start();
-    this->batched_TT_visit(n,mesh,division,tt,false,max_entities);
+    bool owned_faces = this->extract_TT(n,dom,mesh,division,reindex,tt,max_entities,threads_num);
     time.stop();
+    phase_counters.stop();
     time.print_elapsed_time("[TIME] extracting bactched TT: ");
+    phase_counters.print_counters("extracting batched TT");
+
+    // the two counts differ, thus the parallel one is reported under its own label
+    if(owned_faces)
+        cerr<<"[STATS] maximum number of owned faces: "<<max_entities<<endl;
+    else
+        cerr<<"[STATS] maximum number of faces: "<<max_entities<<endl;
+    cerr<<"[MEMORY] TT relation: "<<tt.get_bytes()<<" bytes"<<endl;
+}
 
-    tt.clear();
-    tmp.assign(4,-1);
-    tt.assign(mesh.get_num_tetrahedra(),tmp);
+template<class N, class D> void Topological_Queries::extract_TT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, TT_Relation &tt, int threads_num)
+{
+    int max_entities = 0;
+    this->extract_TT(n,dom,mesh,division,reindex,tt,max_entities,threads_num);
+}
 
-    this->batched_TT_visit(n,mesh,division,tt,true,max_entities);
-    cerr<<"[STATS] maximum number of faces: "<<max_entities<<endl;
+template<class N, class D> bool Topological_Queries::extract_TT(N &n, Box &dom, Mesh &mesh, D &division, bool reindex, TT_Relation &tt, int &max_entries, int threads_num)
+{
+    tt.init(mesh.get_num_tetrahedra());
+
+    vector<pair<N*,Box> > leaves;
+    if(threads_num > 1)
+        this->collect_leaves(n,dom,0,division,leaves);
+    int workers_num = this->get_workers_num(leaves.size(),threads_num);
+
+    if(workers_num == 1)
+    {
+        vector<triangle_tetrahedron_tuple> faces;
+        this->batched_TT_visit(n,mesh,division,tt,faces,max_entries);
+        return false;
+    }
+
+    vector<vector<triangle_tetrahedron_tuple> > workers_faces(workers_num);
+    vector<int> workers_max(workers_num,0);
+    this->exec_leaf_chunks(leaves.size(),workers_num,[&](int w, int begin, int end)
+    {
+        for(int l=begin; l<end; l++)
+            this->batched_TT_owned_leaf(*leaves[l].first,leaves[l].second,mesh,reindex,tt,workers_faces[w],workers_max[w]);
+    });
+    for(int w=0; w<workers_num; w++)
+        max_entries = max(max_entries,workers_max[w]);
+    return true;
 }
 
-template<class N, class D> void Topological_Queries::batched_TT_visit(N &n, Mesh &mesh, D &division, vector<vector<int> > &tt, bool stats, int &max_entries)
+template<class N, class D> void Topological_Queries::batched_TT_visit(N &n, Mesh &mesh, D &division, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries)
 {
     if (n.is_leaf())
     {
-        this->batched_TT_leaf(n,mesh,tt,stats,max_entries);
+        this->batched_TT_leaf(n,mesh,tt,faces,max_entries);
     }
     else
     {
         for (int i = 0; i < division.son_number(); i++)
         {
-            this->batched_TT_visit(*n.get_son(i), mesh, division, tt, stats, max_entries);
+            this->batched_TT_visit(*n.get_son(i), mesh, division, tt, faces, max_entries);
         }
     }
 }
 
-template<class N> void Topological_Queries::batched_TT_leaf(N &n, Mesh &mesh, vector<vector<int> > &tt, bool stats, int &max_entries)
+template<class D> void Topological_Queries::batched_TT_visit(Frozen_Node &n, Mesh &mesh, D &, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries)
+{
+    // the leaves of a frozen subtree are stored contiguously
+    for(int l = n.get_leaves_begin(); l < n.get_leaves_end(); l++)
+        this->batched_TT_leaf(*n.get_leaf(l),mesh,tt,faces,max_entries);
+}
+
+template<class N> void Topological_Queries::batched_TT_leaf(N &n, Mesh &mesh, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries)
 {
-    vector<triangle_tetrahedron_tuple> faces;
+    // the faces buffer is shared by the leaves
+    faces.clear();
     triangle_tetrahedron_tuple face;
 
     for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
@@ -114,7 +321,7 @@ template<class N> void Topological_Queries::batched_TT_leaf(N &n, Mesh &mesh, ve
 
         for(int v=0; v<tet.vertices_num(); v++)
         {
-            if(tt[*tet_id-1][v]==-1) // the entry is not initialized
+            if(tt.get(*tet_id,v)==-1) // the entry is not initialized
             {
                 tet.face_tuple(v,face,*tet_id);
                 faces.push_back(face);
@@ -132,8 +339,8 @@ template<class N> void Topological_Queries::batched_TT_leaf(N &n, Mesh &mesh, ve
         {
             if(faces[j] == faces[j+1])
             {
-                tt[faces[j].t -1][faces[j].f_pos] = faces[j+1].t;
-                tt[faces[j+1].t -1][faces[j+1].f_pos] = faces[j].t;
+                tt.set(faces[j].t,faces[j].f_pos,faces[j+1].t);
+                tt.set(faces[j+1].t,faces[j+1].f_pos,faces[j].t);
                 j+=2;
             }
             else
@@ -150,12 +357,70 @@ template<class N> void Topological_Queries::batched_TT_leaf(N &n, Mesh &mesh, ve
             break;
     }
 
-    if(stats)
+    if(max_entries < (int)faces.size())
+        max_entries = (int)faces.size();
+}
+
+template<class N> void Topological_Queries::batched_TT_owned_leaf(N &n, Box &dom, Mesh &mesh, bool reindex, TT_Relation &tt, vector<triangle_tetrahedron_tuple> &faces, int &max_entries)
+{
+    int v_start = 0, v_end = 0;
+    if(reindex)
+        this->get_leaf_v_range(n,dom,mesh,v_start,v_end);
+
+    // a face is paired only by the leaf that indexes its smallest vertex: this leaf is unique, and indexes all the tetrahedra incident
+    // in that vertex (thus, both the tetrahedra sharing the face). Then, each entry of tt is written by a single leaf.
+    faces.clear();
+    triangle_tetrahedron_tuple face;
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& tet = mesh.get_tetrahedron(*tet_id);
+        for(int v=0; v<tet.vertices_num(); v++)
+        {
+            tet.face_tuple(v,face,*tet_id);
+            bool owned = reindex ? (face.v1 >= v_start && face.v1 < v_end) : dom.contains(mesh.get_vertex(face.v1),mesh.get_domain().get_max());
+            if(owned)
+                faces.push_back(face);
+        }
+    }
+
+    sorting_faces(faces);
+    for(unsigned j=0; j+1<faces.size(); j++)
+    {
+        if(faces[j] == faces[j+1])
+        {
+            tt.set(faces[j].t,faces[j].f_pos,faces[j+1].t);
+            tt.set(faces[j+1].t,faces[j+1].f_pos,faces[j].t);
+            j++;
+        }
+    }
+
+    if(max_entries < (int)faces.size())
+        max_entries = (int)faces.size();
+}
+
+template<class N> void Topological_Queries::get_leaf_v_range(N &n, Box &, Mesh &, int &v_start, int &v_end)
+{
+    if(n.get_v_array_size() == 0)
+        v_start = v_end = 0;
+    else
     {
-        if(max_entries < (int)faces.size())
-            max_entries = (int)faces.size();
+        v_start = n.get_v_start();
+        v_end = n.get_v_end();
     }
 }
 
-#endif // TOPOLOGICAL_QUERIES_BATCHED
+template<class N, class D> void Topological_Queries::collect_leaves(N &n, Box &dom, int level, D &division, vector<pair<N*,Box> > &leaves)
+{
+    if (n.is_leaf())
+        leaves.push_back(make_pair(&n,dom));
+    else
+    {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
+        for (int i = 0; i < division.son_number(); i++)
+            this->collect_leaves(*n.get_son(i),son_doms[i],level+1,division,leaves);
+    }
+}
 
+#endif // TOPOLOGICAL_QUERIES_BATCHED
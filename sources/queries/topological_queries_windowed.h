@@ -27,37 +27,56 @@
 #include "io/reader.h"
 #include "utilities/sorting.h"
 #include "io/writer.h"
+#include "statistics/latency_histogram.h"
+#include "utilities/perf_counters.h"
 
 template<class N, class D> void Topological_Queries::windowed_VT(N &n, Box &dom, Mesh &mesh, D &division, string query_path, bool reindexed)
 {
     vector<Box> boxes;
     Reader::read_queries(boxes,query_path);
 
-    map<int,vector<int> > results;
-
-    Timer time;
+    VT_Result results;
+    Latency_Histogram latency;
+    Perf_Counters phase_counters, counters;
+    Perf_Query_Summary perf;
     double tot_time = 0;
 
-
+    phase_counters.start();
     for(unsigned j=0;j<boxes.size();j++)
     {
-        time.start();
-        if(reindexed)
-            windowed_VT(n,dom,0,boxes[j],mesh,division,results);
-        else
-            windowed_VT_no_reindex(n,dom,0,boxes[j],mesh,division,results);
-        time.stop();
-        tot_time += time.get_elapsed_time();
+        counters.start();
+        uint64_t start = Latency_Histogram::get_time_ns();
+        windowed_VT_query(n,dom,mesh,division,boxes[j],reindexed,results);
+        uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+        counters.stop();
+        perf.add(counters);
+        tot_time += elapsed * 1e-9;
+        latency.record(elapsed,this->visited_nodes_num,this->geometric_tests_num);
 
         //debug print
         cout<<"for box "<<j<<" vertices found: "<<results.size()<<endl;
-        results.clear();
-    }    
+    }
+    phase_counters.stop();
     cerr<<"extracting windowed VT "<<tot_time<<endl;
+    phase_counters.print_counters("extracting windowed VT");
+    perf.print_counters("windowed VT");
+    if(!Writer::write_latency_stats("wvt",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
+}
+
+template<class N, class D> void Topological_Queries::windowed_VT_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, bool reindexed, VT_Result &vt)
+{
+    this->visited_nodes_num = this->geometric_tests_num = 0;
+    vt.clear();
+    if(reindexed)
+        windowed_VT(n,dom,0,b,mesh,division,vt);
+    else
+        windowed_VT_no_reindex(n,dom,0,b,mesh,division,vt);
 }
 
-template<class D> void Topological_Queries::windowed_VT(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &vt)
+template<class D> void Topological_Queries::windowed_VT(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, VT_Result &vt)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -67,17 +86,20 @@ template<class D> void Topological_Queries::windowed_VT(Node_T &n, Box &dom, int
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_VT(*n.get_son(i), son_dom, son_level, b, mesh, division, vt);
         }
     }
 }
 
-template<class N, class D> void Topological_Queries::windowed_VT_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &vt)
+template<class N, class D> void Topological_Queries::windowed_VT_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, VT_Result &vt)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -87,17 +109,20 @@ template<class N, class D> void Topological_Queries::windowed_VT_no_reindex(N &n
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_VT_no_reindex(*n.get_son(i), son_dom, son_level, b, mesh, division, vt);
         }
     }
 }
 
-template<class D> void Topological_Queries::windowed_VT(Node_V &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &vt)
+template<class N, class D> void Topological_Queries::windowed_VT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, VT_Result &vt)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -108,18 +133,45 @@ template<class D> void Topological_Queries::windowed_VT(Node_V &n, Box &dom, int
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_VT(*n.get_son(i), son_dom, son_level, b, mesh, division, vt);
         }
     }
 }
 
-template<class N> void Topological_Queries::windowed_VT_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, map<int,vector<int> > &vt)
+template<class N> void Topological_Queries::windowed_VT_Leaf(N& n, Box &b, Mesh& mesh, VT_Result &vt)
+{
+    if(n.get_v_array_size() == 0)
+        return;
+
+    // local smaller structure... in the end inserted into the global result..
+    this->leaf_vt.clear();
+
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& tet = mesh.get_tetrahedron(*tet_id);
+        for(int v=0; v<tet.vertices_num(); v++)
+        {
+            int real_v_index = tet.TV(v);
+            //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
+            if (n.indexes_vertex(real_v_index) && this->vertex_in_box(mesh.get_vertex(real_v_index),b))
+                this->leaf_vt.add(real_v_index,*tet_id);
+        }
+    }
+
+    finalize_VT_Leaf(vt);
+}
+
+template<class N> void Topological_Queries::windowed_VT_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, VT_Result &vt)
 {
-    map<int,vector<int> > local_vt;  // local smaller structure... in the end inserted into the global map..
+    // local smaller structure... in the end inserted into the global result..
+    this->leaf_vt.clear();
 
     for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
     {
@@ -129,12 +181,12 @@ template<class N> void Topological_Queries::windowed_VT_Leaf_no_reindex(N& n, Bo
         {
             //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
             if (dom.contains(mesh.get_vertex(tet.TV(v)),mesh.get_domain().get_max()) &&
-                    b.contains_with_all_closed_faces(mesh.get_vertex(tet.TV(v))))
-                update_resulting_VT(tet.TV(v),*tet_id,local_vt);
+                    this->vertex_in_box(mesh.get_vertex(tet.TV(v)),b))
+                this->leaf_vt.add(tet.TV(v),*tet_id);
         }
     }
 
-    vt.insert(local_vt.begin(),local_vt.end());
+    finalize_VT_Leaf(vt);
 }
 
 template<class N, class D> void Topological_Queries::windowed_Distortion(N &n, Box &dom, Mesh &mesh, D &division, string query_path, bool reindexed)
@@ -149,28 +201,48 @@ template<class N, class D> void Topological_Queries::windowed_Distortion(N &n, B
     time.stop();
     time.print_elapsed_time("updating borders ");
 
-    map<int,double> results;
+    Distortion_Result results;
+    Latency_Histogram latency;
+    Perf_Counters phase_counters, counters;
+    Perf_Query_Summary perf;
     double tot_time = 0;
 
+    phase_counters.start();
     for(unsigned j=0;j<boxes.size();j++)
     {
-        time.start();
-        if(reindexed)
-            windowed_Distortion(n,dom,0,boxes[j],mesh,division,results);
-        else
-            windowed_Distortion_no_reindex(n,dom,0,boxes[j],mesh,division,results);
-        time.stop();
-        tot_time += time.get_elapsed_time();
+        counters.start();
+        uint64_t start = Latency_Histogram::get_time_ns();
+        windowed_Distortion_query(n,dom,mesh,division,boxes[j],reindexed,results);
+        uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+        counters.stop();
+        perf.add(counters);
+        tot_time += elapsed * 1e-9;
+        latency.record(elapsed,this->visited_nodes_num,this->geometric_tests_num);
 
         //debug print
         cout<<"for box "<<j<<" vertices found: "<<results.size()<<endl;
-        results.clear();
     }
+    phase_counters.stop();
     cerr<<"extracting windowed distortion "<<tot_time<<endl;
+    phase_counters.print_counters("extracting windowed distortion");
+    perf.print_counters("windowed distortion");
+    if(!Writer::write_latency_stats("wdist",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
+}
+
+template<class N, class D> void Topological_Queries::windowed_Distortion_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, bool reindexed, Distortion_Result &dist)
+{
+    this->visited_nodes_num = this->geometric_tests_num = 0;
+    dist.clear();
+    if(reindexed)
+        windowed_Distortion(n,dom,0,b,mesh,division,dist);
+    else
+        windowed_Distortion_no_reindex(n,dom,0,b,mesh,division,dist);
 }
 
-template<class D> void Topological_Queries::windowed_Distortion(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,double> &dist)
+template<class D> void Topological_Queries::windowed_Distortion(Node_T &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, Distortion_Result &dist)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -180,17 +252,20 @@ template<class D> void Topological_Queries::windowed_Distortion(Node_T &n, Box &
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_Distortion(*n.get_son(i), son_dom, son_level, b, mesh, division, dist);
         }
     }
 }
 
-template<class N, class D> void Topological_Queries::windowed_Distortion_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,double> &dist)
+template<class N, class D> void Topological_Queries::windowed_Distortion_no_reindex(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, Distortion_Result &dist)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -200,17 +275,20 @@ template<class N, class D> void Topological_Queries::windowed_Distortion_no_rein
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_Distortion_no_reindex(*n.get_son(i), son_dom, son_level, b, mesh, division, dist);
         }
     }
 }
 
-template<class D> void Topological_Queries::windowed_Distortion(Node_V &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,double> &dist)
+template<class N, class D> void Topological_Queries::windowed_Distortion(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, Distortion_Result &dist)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -220,20 +298,23 @@ template<class D> void Topological_Queries::windowed_Distortion(Node_V &n, Box &
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_Distortion(*n.get_son(i), son_dom, son_level, b, mesh, division, dist);
         }
     }
 }
 
-template<class N> void Topological_Queries::windowed_Distortion_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, map<int,double> &dist)
+template<class N> void Topological_Queries::windowed_Distortion_Leaf(N &n, Box &b, Mesh& mesh, Distortion_Result &dist)
 {
-    map<int,vector<int> > vt;
-    set<int> border_v;
-    map<int,double> local_dist; // local smaller structure... in the end inserted into the global map..
+    if(n.get_v_array_size() == 0)
+        return;
+
+    this->leaf_vt.clear();
 
     for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
     {
@@ -242,55 +323,35 @@ template<class N> void Topological_Queries::windowed_Distortion_Leaf_no_reindex(
         for(int v=0; v<tet.vertices_num(); v++)
         {
             int real_v_index = tet.TV(v);
+            //if a vertex has the partial vt != from 0 then must be into the search box...
             //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
-            if (dom.contains(mesh.get_vertex(real_v_index),mesh.get_domain().get_max()) &&
-                    b.contains_with_all_closed_faces(mesh.get_vertex(real_v_index)))
-            {
-                update_resulting_VT(real_v_index,*tet_id,vt);
-
-                double partial_distortion = Geometry_Distortion::get_trihedral_angle(tet,real_v_index,mesh);
-                update_resulting_distortion(real_v_index,partial_distortion,local_dist);
-
-                set<int>::iterator iter = border_v.find(real_v_index);
-                if(iter == border_v.end())
-                {
-                    //controllo se almeno uno degli altri tre è negativo e nel caso metto il vertice corrente come di bordo
-                    for(int j=1; j<tet.vertices_num(); j++)
-                    {
-                        if(tet.is_border_face((j+v)%tet.vertices_num()))
-                        {
-                            border_v.insert(real_v_index);
-                            break;
-                        }
-                    }
-                }
-            }
+            if (n.indexes_vertex(real_v_index) && this->vertex_in_box(mesh.get_vertex(real_v_index),b))
+                this->leaf_vt.add(real_v_index,*tet_id);
         }
     }
+    // on these leaves the border vertices are not detected, thus the 3D correction is never applied
+    finalize_Distortion_Leaf(false,true,mesh,dist);
+}
 
-    for(map<int,vector<int> >::iterator iter=vt.begin(); iter!=vt.end(); ++iter)
-    {
-        int real_v_index = iter->first;
+template<class N> void Topological_Queries::windowed_Distortion_Leaf_no_reindex(N& n, Box &dom, Box &b, Mesh& mesh, Distortion_Result &dist)
+{
+    this->leaf_vt.clear();
 
-        map<int,double>::iterator it_v = local_dist.find(real_v_index);
-        set<int>::iterator it = border_v.find(real_v_index);
-        if(it == border_v.end())
-        {
-            it_v->second = - it_v->second;
-            for(int_vect_iter t = iter->second.begin(); t != iter->second.end(); ++t)
-            {
-                Tetrahedron& tet = mesh.get_tetrahedron(*t);
-                double partial_distortion = Geometry_Distortion::get_trihedral_angle_3D(tet,real_v_index,mesh);
-                it_v->second += partial_distortion;
-            }
-        }
-        else
+    for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
+    {
+        RunIterator const& tet_id = itPair.first;
+        Tetrahedron& tet = mesh.get_tetrahedron(*tet_id);
+        for(int v=0; v<tet.vertices_num(); v++)
         {
-            it_v->second = ( 4*PI - it_v->second );
+            int real_v_index = tet.TV(v);
+            //a vertex must be inside the leaf and inside the box (this avoids to insert the same vertex in different leaves)
+            if (dom.contains(mesh.get_vertex(real_v_index),mesh.get_domain().get_max()) &&
+                    this->vertex_in_box(mesh.get_vertex(real_v_index),b))
+                this->leaf_vt.add(real_v_index,*tet_id);
         }
     }
-
-    dist.insert(local_dist.begin(),local_dist.end());
+    // here the 3D correction is applied on the vertices that are not on the border
+    finalize_Distortion_Leaf(true,false,mesh,dist);
 }
 
 template<class N, class D> void Topological_Queries::windowed_TT(N &n, Box &dom, Mesh &mesh, D &division, string query_path)
@@ -298,30 +359,48 @@ template<class N, class D> void Topological_Queries::windowed_TT(N &n, Box &dom,
     vector<Box> boxes;
     Reader::read_queries(boxes,query_path);
 
-    map<int,vector<int> > results;
-    Timer time;
+    TT_Result results;
+    Latency_Histogram latency;
+    Perf_Counters phase_counters, counters;
+    Perf_Query_Summary perf;
     double tot_time = 0.0;
 
-    bm::bvector<> checkTetra;
+    Visited_Set checkTetra(mesh.get_num_tetrahedra()+1);
 
+    phase_counters.start();
     for(unsigned j=0;j<boxes.size();j++)
     {
-        time.start();
-        windowed_TT(n,dom,0,boxes[j],mesh,division,results,checkTetra);
-        time.stop();
-        tot_time += time.get_elapsed_time();
+        counters.start();
+        uint64_t start = Latency_Histogram::get_time_ns();
+        windowed_TT_query(n,dom,mesh,division,boxes[j],results,checkTetra);
+        uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+        counters.stop();
+        perf.add(counters);
+        tot_time += elapsed * 1e-9;
+        latency.record(elapsed,this->visited_nodes_num,this->geometric_tests_num);
 
         //debug print
         cout<<"for box "<<j<<" tetrahedra found: "<<results.size()<<endl;
-        results.clear();
-
-        checkTetra.reset();
     }
+    phase_counters.stop();
     cerr<<"extracting windowed TT "<<tot_time<<endl;
+    phase_counters.print_counters("extracting windowed TT");
+    perf.print_counters("windowed TT");
+    if(!Writer::write_latency_stats("wtt",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
+}
+
+template<class N, class D> void Topological_Queries::windowed_TT_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, TT_Result &tt, Visited_Set &checkTetra)
+{
+    this->visited_nodes_num = this->geometric_tests_num = 0;
+    tt.clear();
+    checkTetra.clear();
+    windowed_TT(n,dom,0,b,mesh,division,tt,checkTetra);
 }
 
-template<class N, class D> void Topological_Queries::windowed_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &tt, bm::bvector<> &checkTetra)
+template<class N, class D> void Topological_Queries::windowed_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, TT_Result &tt, Visited_Set &checkTetra)
 {
+    this->visited_nodes_num++;
     if (!dom.intersects(b))
         return;
 
@@ -334,36 +413,40 @@ template<class N, class D> void Topological_Queries::windowed_TT(N &n, Box &dom,
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->windowed_TT(*n.get_son(i), son_dom, son_level, b, mesh, division, tt, checkTetra);
         }
     }
 }
 
-template<class N> void Topological_Queries::windowed_TT_Leaf_test(N& n, Box &b, Mesh& mesh, map<int,vector<int> > &tt, bm::bvector<> &checkTetra)
+template<class N> void Topological_Queries::windowed_TT_Leaf_test(N& n, Box &b, Mesh& mesh, TT_Result &tt, Visited_Set &checkTetra)
 {
-    vector<triangle_tetrahedron_tuple> faces;
+    vector<triangle_tetrahedron_tuple> &faces = this->leaf_faces;
+    faces.clear();
     Box bb;
     pair<int,int> run;
+    int run_id = 0;
 
     for(vector<int>::iterator it=n.get_t_array_begin(); it!=n.get_t_array_end(); ++it)
     {
-        if(n.get_run_bounding_box(it,bb,mesh,run))
+        if(n.get_run_bounding_box(it,bb,mesh,run,run_id))
         {
             if(b.completely_contains(bb))
             {
                 for(int t_id=run.first; t_id<=run.second; t_id++)
                 {
-                    map<int,vector<int> >::const_iterator entry = tt.find(t_id);
+                    int entry = tt.find(t_id);
 
-                    checkTetra[t_id]=true;
+                    checkTetra.insert(t_id);
 
                     //if the run is completely contained.. simply add..
-                    if(entry == tt.end()) // first time for the current tetrahedron
-                        init_TT_entry(t_id,tt);
+                    if(entry == -1) // first time for the current tetrahedron
+                        entry = init_TT_entry(t_id,tt);
                     add_faces(t_id,faces,mesh,entry,tt);
                 }
             }
@@ -371,55 +454,56 @@ template<class N> void Topological_Queries::windowed_TT_Leaf_test(N& n, Box &b,
             {
                 for(int t_id=run.first; t_id<=run.second; t_id++)
                 {
-                    map<int,vector<int> >::const_iterator entry = tt.find(t_id);
+                    int entry = tt.find(t_id);
 
                     //if I have an entry into the result or I have an intersection with the box
-                    if(entry != tt.end() || (!checkTetra[t_id] && Geometry_Wrapper::tetra_in_box(t_id,b,mesh)))
+                    if(entry != -1 || (!checkTetra.contains(t_id) && this->tetra_in_box(t_id,b,mesh)))
                     {
 
-                        if(entry == tt.end()) // first time for the current tetrahedron
-                            init_TT_entry(t_id,tt);
+                        if(entry == -1) // first time for the current tetrahedron
+                            entry = init_TT_entry(t_id,tt);
                         add_faces(t_id,faces,mesh,entry,tt);
                     }
 
-                    checkTetra[t_id]=true;
+                    checkTetra.insert(t_id);
                 }
             }
         }
         else
         {
-            map<int,vector<int> >::const_iterator entry = tt.find(*it);
+            int entry = tt.find(*it);
 
             //if I have an entry into the result or I have an intersection with the box
-            if(entry != tt.end() || (!checkTetra[*it] && Geometry_Wrapper::tetra_in_box(*it,b,mesh)))
+            if(entry != -1 || (!checkTetra.contains(*it) && this->tetra_in_box(*it,b,mesh)))
             {
 
-                if(entry == tt.end()) // first time for the current tetrahedron
-                    init_TT_entry(*it,tt);
+                if(entry == -1) // first time for the current tetrahedron
+                    entry = init_TT_entry(*it,tt);
                 add_faces(*it,faces,mesh,entry,tt);
             }
 
-            checkTetra[*it]=true;
+            checkTetra.insert(*it);
         }
     }
     finalize_TT_Leaf(faces,tt,mesh);
 }
 
-template<class N> void Topological_Queries::windowed_TT_Leaf_add(N& n, Mesh& mesh, map<int,vector<int> > &tt, bm::bvector<> &checkTetra)
+template<class N> void Topological_Queries::windowed_TT_Leaf_add(N& n, Mesh& mesh, TT_Result &tt, Visited_Set &checkTetra)
 {
-    vector<triangle_tetrahedron_tuple> faces;
+    vector<triangle_tetrahedron_tuple> &faces = this->leaf_faces;
+    faces.clear();
 
     for(RunIteratorPair itPair = n.make_t_array_iterator_pair(); itPair.first != itPair.second; ++itPair.first)
     {
         RunIterator const& tet_id = itPair.first;
 
-        map<int,vector<int> >::const_iterator entry = tt.find(*tet_id);
+        int entry = tt.find(*tet_id);
 
-        checkTetra[*tet_id]=true;
+        checkTetra.insert(*tet_id);
 
         //if I have an entry into the result or I have an intersection with the box
-        if(entry == tt.end()) // first time for the current tetrahedron
-            init_TT_entry(*tet_id,tt);
+        if(entry == -1) // first time for the current tetrahedron
+            entry = init_TT_entry(*tet_id,tt);
         add_faces(*tet_id,faces,mesh,entry,tt);
     }
     finalize_TT_Leaf(faces,tt,mesh);
@@ -430,28 +514,48 @@ template<class N, class D> void Topological_Queries::linearized_TT(N &n, Box &do
     vector<Box> boxes;
     Reader::read_queries(boxes,query_path);
 
-    map<int,vector<int> > results;
-    Timer time;
+    TT_Result results;
+    Latency_Histogram latency;
+    Perf_Counters phase_counters, counters;
+    Perf_Query_Summary perf;
     double tot_time = 0.0;
 
-    bm::bvector<> checkTetra;
+    Visited_Set checkTetra(mesh.get_num_tetrahedra()+1);
 
+    phase_counters.start();
     for(unsigned j=0;j<boxes.size();j++)
     {
-        time.start();
-        linearized_TT(n,dom,0,boxes[j],mesh,division,results,checkTetra);
-        tot_time += time.get_elapsed_time();
+        counters.start();
+        uint64_t start = Latency_Histogram::get_time_ns();
+        linearized_TT_query(n,dom,mesh,division,boxes[j],results,checkTetra);
+        uint64_t elapsed = Latency_Histogram::get_time_ns() - start;
+        counters.stop();
+        perf.add(counters);
+        tot_time += elapsed * 1e-9;
+        latency.record(elapsed,this->visited_nodes_num,this->geometric_tests_num);
 
         //debug print
         cout<<"for box "<<j<<" tetrahedra found: "<<results.size()<<endl;
-        results.clear();
-        checkTetra.reset();
     }
+    phase_counters.stop();
     cerr<<"extracting linearized TT "<<tot_time<<endl;
+    phase_counters.print_counters("extracting linearized TT");
+    perf.print_counters("linearized TT");
+    if(!Writer::write_latency_stats("ltt",latency,this->latency_path))
+        cerr << "Error writing the latency files." << endl;
+}
+
+template<class N, class D> void Topological_Queries::linearized_TT_query(N &n, Box &dom, Mesh &mesh, D &division, Box &b, TT_Result &tt, Visited_Set &checkTetra)
+{
+    this->visited_nodes_num = this->geometric_tests_num = 0;
+    tt.clear();
+    checkTetra.clear();
+    linearized_TT(n,dom,0,b,mesh,division,tt,checkTetra);
 }
 
-template<class N, class D> void Topological_Queries::linearized_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, map<int,vector<int> > &tt, bm::bvector<> &checkTetra)
+template<class N, class D> void Topological_Queries::linearized_TT(N &n, Box &dom, int level, Box &b, Mesh &mesh, D &division, TT_Result &tt, Visited_Set &checkTetra)
 {
+    this->visited_nodes_num++;
     if(!Geometry_Wrapper::line_in_box(b.get_min(),b.get_max(),dom))
         return;
 
@@ -461,57 +565,61 @@ template<class N, class D> void Topological_Queries::linearized_TT(N &n, Box &do
     }
     else
     {
+        Box son_doms[D::SON_NUMBER];
+        division.compute_domains(dom,level,son_doms);
         for (int i = 0; i < division.son_number(); i++)
         {
-            Box son_dom = division.compute_domain(dom,level,i);
+            Box &son_dom = son_doms[i];
             int son_level = level +1;
             this->linearized_TT(*n.get_son(i), son_dom, son_level, b, mesh, division, tt,checkTetra);
         }
     }
 }
 
-template<class N> void Topological_Queries::linearized_TT_Leaf(N& n, Box &b, Mesh& mesh, map<int,vector<int> > &tt, bm::bvector<> &checkTetra)
+template<class N> void Topological_Queries::linearized_TT_Leaf(N& n, Box &b, Mesh& mesh, TT_Result &tt, Visited_Set &checkTetra)
 {
-    vector<triangle_tetrahedron_tuple> faces;
+    vector<triangle_tetrahedron_tuple> &faces = this->leaf_faces;
+    faces.clear();
 
     Box bb;
     pair<int,int> run;
+    int run_id = 0;
 
     for(vector<int>::iterator it=n.get_t_array_begin(); it!=n.get_t_array_end(); ++it)
     {
-        if(n.get_run_bounding_box(it,bb,mesh,run))
+        if(n.get_run_bounding_box(it,bb,mesh,run,run_id))
         {
             if(Geometry_Wrapper::line_in_bounding_box(b.get_min(),b.get_max(),bb))
             {
                 for(int t_id=run.first; t_id<=run.second; t_id++)
                 {
-                    map<int,vector<int> >::const_iterator entry = tt.find(t_id);
+                    int entry = tt.find(t_id);
 
                     //if I have an entry into the result or I have an intersection with the box
-                    if(entry != tt.end() || (!checkTetra[t_id] && Geometry_Wrapper::line_in_tetra(b.get_min(),b.get_max(),t_id,mesh)))
+                    if(entry != -1 || (!checkTetra.contains(t_id) && this->line_in_tetra(b,t_id,mesh)))
                     {
-                        if(entry == tt.end()) // first time for the current tetrahedron
-                            init_TT_entry(t_id,tt);
+                        if(entry == -1) // first time for the current tetrahedron
+                            entry = init_TT_entry(t_id,tt);
                         add_faces(t_id,faces,mesh,entry,tt);
                     }
 
-                    checkTetra[t_id] = true;
+                    checkTetra.insert(t_id);
                 }
             }
         }
         else
         {
-            map<int,vector<int> >::const_iterator entry = tt.find(*it);
+            int entry = tt.find(*it);
 
             //if I have an entry into the result or I have an intersection with the box
-            if(entry != tt.end() || (!checkTetra[*it] && Geometry_Wrapper::line_in_tetra(b.get_min(),b.get_max(),*it,mesh)))
+            if(entry != -1 || (!checkTetra.contains(*it) && this->line_in_tetra(b,*it,mesh)))
             {
-                if(entry == tt.end()) // first time for the current tetrahedron
-                    init_TT_entry(*it,tt);
+                if(entry == -1) // first time for the current tetrahedron
+                    entry = init_TT_entry(*it,tt);
                 add_faces(*it,faces,mesh,entry,tt);
             }
 
-            checkTetra[*it] = true;
+            checkTetra.insert(*it);
         }
     }
     finalize_TT_Leaf(faces,tt,mesh);
@@ -0,0 +1,119 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TOPOLOGICAL_RELATIONS_H
+#define TOPOLOGICAL_RELATIONS_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief The VT_Relation class encodes the Vertex-Tetrahedra relation of a mesh in compressed sparse row (CSR) form.
+ * The tetrahedra incident in the vertices are stored contiguously, following the vertices order, and the offsets array
+ * (one entry more than the number of vertices) delimits the tetrahedra of each vertex.
+ * As in the mesh, vertices and tetrahedra are identified by their position indices, starting from 1.
+ */
+class VT_Relation
+{
+public:
+    ///A constructor method
+    VT_Relation() {}
+    ///A public method that returns the number of vertices encoded
+    inline int get_vertices_num() const { return this->offsets.empty() ? 0 : this->offsets.size()-1; }
+    ///A public method that returns the number of vertex-tetrahedron pairs encoded
+    inline size_t get_entries_num() const { return this->tetrahedra.size(); }
+    /**
+     * @brief A public method that returns the number of tetrahedra incident in a vertex
+     * @param v an integer representing the position index of the vertex
+     * @return an integer
+     */
+    inline int get_size(int v) const { return this->offsets[v] - this->offsets[v-1]; }
+    /**
+     * @brief A public method that returns the first tetrahedron incident in a vertex
+     * @param v an integer representing the position index of the vertex
+     * @return a const int* pointing to the position index of the tetrahedron
+     */
+    inline const int* begin(int v) const { return this->tetrahedra.data() + this->offsets[v-1]; }
+    /**
+     * @brief A public method that returns the position following the last tetrahedron incident in a vertex
+     * @param v an integer representing the position index of the vertex
+     * @return a const int*
+     */
+    inline const int* end(int v) const { return this->tetrahedra.data() + this->offsets[v]; }
+    ///A public method that returns the offsets array
+    inline vector<int>& get_offsets() { return this->offsets; }
+    ///A public method that returns the concatenated tetrahedra arrays
+    inline vector<int>& get_tetrahedra() { return this->tetrahedra; }
+    ///A public method that returns the size of the relation in bytes
+    inline size_t get_bytes() const { return (this->offsets.size() + this->tetrahedra.size()) * sizeof(int); }
+
+private:
+    vector<int> offsets;
+    vector<int> tetrahedra;
+};
+
+/**
+ * @brief The TT_Relation class encodes the Tetrahedron-Tetrahedron relation of a mesh in a flat array.
+ * The array contains four entries for each tetrahedron: the i-th entry is the tetrahedron adjacent along the face opposite
+ * to the i-th vertex, or -1 if the face is on the mesh boundary.
+ * As in the mesh, the tetrahedra are identified by their position indices, starting from 1.
+ */
+class TT_Relation
+{
+public:
+    ///A constructor method
+    TT_Relation() {}
+    /**
+     * @brief A public method that initializes the relation, with all the faces on the boundary
+     * @param tetrahedra_num an integer representing the number of tetrahedra
+     */
+    inline void init(int tetrahedra_num) { this->adjacents.assign(4*(size_t)tetrahedra_num,-1); }
+    ///A public method that returns the number of tetrahedra encoded
+    inline int get_tetrahedra_num() const { return this->adjacents.size() / 4; }
+    /**
+     * @brief A public method that returns the tetrahedron adjacent along a face
+     * @param t an integer representing the position index of the tetrahedron
+     * @param f an integer representing the position of the face (i.e., of the opposite vertex)
+     * @return the position index of the adjacent tetrahedron, -1 if the face is on the boundary
+     */
+    inline int get(int t, int f) const { return this->adjacents[4*(size_t)(t-1)+f]; }
+    /**
+     * @brief A public method that sets the tetrahedron adjacent along a face
+     * @param t an integer representing the position index of the tetrahedron
+     * @param f an integer representing the position of the face (i.e., of the opposite vertex)
+     * @param adj an integer representing the position index of the adjacent tetrahedron
+     */
+    inline void set(int t, int f, int adj) { this->adjacents[4*(size_t)(t-1)+f] = adj; }
+    ///A public method that returns the flat array
+    inline vector<int>& get_adjacents() { return this->adjacents; }
+    ///A public method that returns the size of the relation in bytes
+    inline size_t get_bytes() const { return this->adjacents.size() * sizeof(int); }
+
+private:
+    vector<int> adjacents;
+};
+
+#endif // TOPOLOGICAL_RELATIONS_H
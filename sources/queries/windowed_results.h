@@ -0,0 +1,239 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef WINDOWED_RESULTS_H
+#define WINDOWED_RESULTS_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * The containers collecting the results of the windowed topological queries.
+ * The results are appended to flat arrays that keep their capacity when cleared, thus a container reused for successive queries
+ * works as a per-query arena, and it does not allocate memory once it has grown to the size of the largest result.
+ * As in the mesh, vertices and tetrahedra are identified by their position indices, starting from 1.
+ */
+
+/**
+ * @brief The VT_Result class contains the VT relations of the vertices found by a windowed query, in compressed sparse row form.
+ * The vertices are added one at a time, each one followed by its incident tetrahedra.
+ */
+class VT_Result
+{
+public:
+    ///A constructor method
+    VT_Result() { this->offsets.push_back(0); }
+    ///A public method that removes all the vertices, keeping the allocated memory
+    inline void clear() { this->vertices.clear(); this->offsets.resize(1); this->tetrahedra.clear(); }
+    ///A public method that returns the number of vertices found
+    inline int size() const { return this->vertices.size(); }
+    ///A public method that returns the position index of the i-th vertex found
+    inline int get_vertex(int i) const { return this->vertices[i]; }
+    ///A public method that returns the first tetrahedron incident in the i-th vertex found
+    inline const int* begin(int i) const { return this->tetrahedra.data() + this->offsets[i]; }
+    ///A public method that returns the position following the last tetrahedron incident in the i-th vertex found
+    inline const int* end(int i) const { return this->tetrahedra.data() + this->offsets[i+1]; }
+    ///A public method that adds a vertex, whose tetrahedra are then added with add_tetrahedron
+    inline void add_vertex(int v) { this->vertices.push_back(v); this->offsets.push_back(this->offsets.back()); }
+    ///A public method that adds a tetrahedron to the last vertex added
+    inline void add_tetrahedron(int t) { this->tetrahedra.push_back(t); this->offsets.back()++; }
+
+private:
+    vector<int> vertices;
+    vector<int> offsets;
+    vector<int> tetrahedra;
+};
+
+/**
+ * @brief The Distortion_Result class contains the distortion values of the vertices found by a windowed query
+ */
+class Distortion_Result
+{
+public:
+    ///A constructor method
+    Distortion_Result() {}
+    ///A public method that removes all the vertices, keeping the allocated memory
+    inline void clear() { this->vertices.clear(); this->values.clear(); }
+    ///A public method that returns the number of vertices found
+    inline int size() const { return this->vertices.size(); }
+    ///A public method that returns the position index of the i-th vertex found
+    inline int get_vertex(int i) const { return this->vertices[i]; }
+    ///A public method that returns the distortion of the i-th vertex found
+    inline double get_value(int i) const { return this->values[i]; }
+    ///A public method that adds a vertex with its distortion
+    inline void add(int v, double value) { this->vertices.push_back(v); this->values.push_back(value); }
+
+private:
+    vector<int> vertices;
+    vector<double> values;
+};
+
+/**
+ * @brief The TT_Result class contains the (partial) TT relations of the tetrahedra found by a windowed query.
+ * Each tetrahedron gets a slot, with the four adjacent tetrahedra (-1 if not set), and the slots are reached from the
+ * tetrahedra with an open-addressing hash table with linear probing.
+ * The table is sized on the number of tetrahedra found (and not on the mesh), and its used buckets are reset when cleared.
+ */
+class TT_Result
+{
+public:
+    ///A constructor method
+    TT_Result() { this->buckets.assign(MIN_BUCKETS,Bucket()); }
+    ///A public method that removes all the tetrahedra, keeping the allocated memory
+    inline void clear()
+    {
+        for(unsigned s=0; s<this->positions.size(); s++)
+            this->buckets[this->positions[s]] = Bucket();
+        this->tetrahedra.clear();
+        this->positions.clear();
+        this->adjacents.clear();
+    }
+    ///A public method that returns the number of tetrahedra found
+    inline int size() const { return this->tetrahedra.size(); }
+    /**
+     * @brief A public method that returns the slot of a tetrahedron
+     * @param t an integer representing the position index of the tetrahedron
+     * @return the slot of the tetrahedron, -1 if the tetrahedron has not been added
+     */
+    inline int find(int t) const
+    {
+        for(uint32_t b = this->hash(t); ; b = (b+1) & (this->buckets.size()-1))
+        {
+            if(this->buckets[b].key == t)
+                return this->buckets[b].slot;
+            if(this->buckets[b].key == 0)
+                return -1;
+        }
+    }
+    /**
+     * @brief A public method that adds a tetrahedron, with all the adjacencies unset
+     * NOTA: the tetrahedron must not be already in the result
+     *
+     * @param t an integer representing the position index of the tetrahedron
+     * @return the slot of the tetrahedron
+     */
+    inline int insert(int t)
+    {
+        // the load factor is kept below one half
+        if(2*(this->tetrahedra.size()+1) > this->buckets.size())
+            this->grow();
+        int slot = this->tetrahedra.size();
+        this->tetrahedra.push_back(t);
+        this->positions.push_back(this->place(t,slot));
+        this->adjacents.insert(this->adjacents.end(),4,-1);
+        return slot;
+    }
+    ///A public method that returns the position index of the tetrahedron of a slot
+    inline int get_tetrahedron(int slot) const { return this->tetrahedra[slot]; }
+    ///A public method that returns the four adjacencies of the tetrahedron of a slot
+    inline int* get_adjacents(int slot) { return &this->adjacents[4*slot]; }
+
+private:
+    static const unsigned MIN_BUCKETS = 64;
+
+    ///a bucket of the hash table (a zero key marks an empty bucket)
+    struct Bucket
+    {
+        int key;
+        int slot;
+        Bucket() { key = 0; slot = -1; }
+    };
+
+    vector<Bucket> buckets;
+    ///the tetrahedra of the slots
+    vector<int> tetrahedra;
+    ///the buckets of the slots
+    vector<uint32_t> positions;
+    ///four adjacencies for each slot
+    vector<int> adjacents;
+
+    ///the buckets are a power of two, and the Fibonacci hashing spreads the (often consecutive) indices of the tetrahedra
+    inline uint32_t hash(int t) const { return (uint32_t(t) * 2654435769u) >> (32 - this->log_buckets()); }
+    inline int log_buckets() const
+    {
+        int l = 0;
+        while((1u << l) < this->buckets.size())
+            l++;
+        return l;
+    }
+    inline uint32_t place(int t, int slot)
+    {
+        uint32_t b = this->hash(t);
+        while(this->buckets[b].key != 0)
+            b = (b+1) & (this->buckets.size()-1);
+        this->buckets[b].key = t;
+        this->buckets[b].slot = slot;
+        return b;
+    }
+    inline void grow()
+    {
+        this->buckets.assign(2*this->buckets.size(),Bucket());
+        for(unsigned s=0; s<this->tetrahedra.size(); s++)
+            this->positions[s] = this->place(this->tetrahedra[s],s);
+    }
+};
+
+/**
+ * @brief The Leaf_VT_Buffer class collects the vertex-tetrahedron pairs found in a leaf, and groups them by vertex.
+ * The pairs are sorted on the vertices and, for each vertex, on the visiting order, thus the tetrahedra of a vertex keep the order
+ * in which they have been found.
+ */
+class Leaf_VT_Buffer
+{
+public:
+    ///A constructor method
+    Leaf_VT_Buffer() {}
+    ///A public method that removes all the pairs, keeping the allocated memory
+    inline void clear() { this->keys.clear(); this->tetrahedra.clear(); }
+    /**
+     * @brief A public method that adds a pair
+     * @return the position of the pair in the visiting order
+     */
+    inline int add(int v, int t)
+    {
+        int pos = this->tetrahedra.size();
+        this->keys.push_back(make_pair(v,pos));
+        this->tetrahedra.push_back(t);
+        return pos;
+    }
+    ///A public method that groups the pairs by vertex
+    inline void group() { sort(this->keys.begin(),this->keys.end()); }
+    ///A public method that returns the number of pairs
+    inline int size() const { return this->keys.size(); }
+    ///A public method that returns the vertex of the i-th grouped pair
+    inline int get_vertex(int i) const { return this->keys[i].first; }
+    ///A public method that returns the position in the visiting order of the i-th grouped pair
+    inline int get_position(int i) const { return this->keys[i].second; }
+    ///A public method that returns the tetrahedron of the i-th grouped pair
+    inline int get_tetrahedron(int i) const { return this->tetrahedra[this->keys[i].second]; }
+
+private:
+    vector<pair<int,int> > keys;
+    vector<int> tetrahedra;
+};
+
+#endif // WINDOWED_RESULTS_H
@@ -0,0 +1,127 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "channel.h"
+
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+Channel::Channel(int in_fd, int out_fd, bool owned)
+{
+    this->in_fd = in_fd;
+    this->out_fd = out_fd;
+    this->owned = owned;
+}
+
+Channel::~Channel()
+{
+    if(this->owned)
+    {
+        close(this->in_fd);
+        if(this->out_fd != this->in_fd)
+            close(this->out_fd);
+    }
+}
+
+bool Channel::read_fully(void *buffer, size_t bytes)
+{
+    char *pos = static_cast<char*>(buffer);
+    while(bytes > 0)
+    {
+        ssize_t num = read(this->in_fd,pos,bytes);
+        if(num < 0 && errno == EINTR)
+            continue;
+        if(num <= 0)
+            return false;
+        pos += num;
+        bytes -= num;
+    }
+    return true;
+}
+
+bool Channel::write_fully(const void *buffer, size_t bytes)
+{
+    const char *pos = static_cast<const char*>(buffer);
+    while(bytes > 0)
+    {
+        // a client that closes the connection must not kill the server with a SIGPIPE
+        ssize_t num = (this->in_fd == this->out_fd) ? send(this->out_fd,pos,bytes,MSG_NOSIGNAL) : write(this->out_fd,pos,bytes);
+        if(num < 0 && errno == EINTR)
+            continue;
+        if(num <= 0)
+            return false;
+        pos += num;
+        bytes -= num;
+    }
+    return true;
+}
+
+// fills the address of a socket, returning false if the path does not fit
+static bool get_socket_address(string &path, sockaddr_un &address)
+{
+    memset(&address,0,sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path))
+        return false;
+    strcpy(address.sun_path,path.c_str());
+    return true;
+}
+
+int Channel::listen_on(string path)
+{
+    sockaddr_un address;
+    if(!get_socket_address(path,address))
+        return -1;
+
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if(fd < 0)
+        return -1;
+    unlink(path.c_str());
+    if(bind(fd,reinterpret_cast<sockaddr*>(&address),sizeof(address)) < 0 || listen(fd,SOMAXCONN) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int Channel::connect_to(string path)
+{
+    sockaddr_un address;
+    if(!get_socket_address(path,address))
+        return -1;
+
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if(fd < 0)
+        return -1;
+    if(connect(fd,reinterpret_cast<sockaddr*>(&address),sizeof(address)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
@@ -0,0 +1,84 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief A class representing a bidirectional byte stream between the query server and a client.
+ * The stream is either a connected Unix domain socket or a pair of file descriptors (e.g., the standard input and output).
+ * The reads and writes block until all the requested bytes are transferred.
+ */
+class Channel
+{
+public:
+    /**
+     * @brief A constructor method
+     * @param in_fd an integer representing the file descriptor from which the data are read
+     * @param out_fd an integer representing the file descriptor on which the data are written
+     * @param owned a boolean, true if the descriptors must be closed with the channel
+     */
+    Channel(int in_fd, int out_fd, bool owned);
+    ///A destructor method
+    ~Channel();
+    /**
+     * @brief A public method that reads a given number of bytes
+     * @return true if all the bytes have been read, false if the stream has been closed or an error occurred
+     */
+    bool read_fully(void *buffer, size_t bytes);
+    /**
+     * @brief A public method that writes a given number of bytes
+     * @return true if all the bytes have been written, false if an error occurred
+     */
+    bool write_fully(const void *buffer, size_t bytes);
+
+    /**
+     * @brief A public static method that creates a Unix domain socket listening on a path
+     * An existing socket file on the same path is replaced.
+     * @param path a string containing the path of the socket
+     * @return the file descriptor of the socket, -1 if an error occurred
+     */
+    static int listen_on(string path);
+    /**
+     * @brief A public static method that connects to a Unix domain socket
+     * @param path a string containing the path of the socket
+     * @return the file descriptor of the connection, -1 if an error occurred
+     */
+    static int connect_to(string path);
+
+private:
+    int in_fd;
+    int out_fd;
+    bool owned;
+
+    Channel(const Channel&);
+    Channel& operator=(const Channel&);
+};
+
+#endif // CHANNEL_H
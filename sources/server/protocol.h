@@ -0,0 +1,95 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+
+/**
+ * @brief The binary protocol of the query server (see Query_Server).
+ * A client sends a series of requests, each one made by a Request_Header followed by its payload, and the server answers each request,
+ * in order, with a Response_Header followed by its payload.
+ * All the values are stored in native byte order, as the server is reached through a local socket or a pipe.
+ * The position indices of the vertices and of the tetrahedra start from 1, as in the mesh.
+ */
+namespace protocol
+{
+    ///the magic number at the beginning of each header
+    const uint32_t MAGIC = 0x54545131; // "TTQ1"
+
+    ///the requests, with their payloads
+    enum Request_Type { POINT = 1,                 ///< three doubles (x,y,z)
+                        BOX = 2,                   ///< six doubles (the minimum and maximum points)
+                        LINE = 3,                  ///< six doubles (the endpoints of the segment)
+                        WINDOWED_VT = 4,           ///< six doubles (the minimum and maximum points of the box)
+                        WINDOWED_TT = 5,           ///< six doubles (the minimum and maximum points of the box)
+                        LINEARIZED_TT = 6,         ///< six doubles (the endpoints of the segment)
+                        WINDOWED_DISTORTION = 7,   ///< six doubles (the minimum and maximum points of the box)
+                        SHUTDOWN = 8 };            ///< no payload, stops the server after the answer
+
+    ///the outcome of a request
+    enum Status { OK = 0,
+                  MALFORMED = 1,      ///< unknown request or wrong payload size
+                  UNSUPPORTED = 2 };  ///< the request cannot be answered by the current index
+
+    ///the header of a request
+    struct Request_Header
+    {
+        uint32_t magic;
+        uint32_t type;
+        ///an identifier chosen by the client, returned in the response
+        uint32_t id;
+        ///the size of the payload in bytes
+        uint32_t payload_bytes;
+    };
+
+    /**
+     * @brief The header of a response
+     * The payload depends on the request:
+     * - POINT, BOX and LINE: count int32, the tetrahedra found (for a point location, count is 0 if the point is outside the mesh)
+     * - WINDOWED_VT: count int32 vertices, count+1 int32 offsets and offsets[count] int32 incident tetrahedra (in compressed sparse row form)
+     * - WINDOWED_TT and LINEARIZED_TT: count int32 tetrahedra and 4*count int32 adjacent tetrahedra (-1 if not found in the query)
+     * - WINDOWED_DISTORTION: count doubles, the distortion values, and count int32 vertices
+     * - SHUTDOWN and the failed requests: no payload
+     */
+    struct Response_Header
+    {
+        uint32_t magic;
+        uint32_t type;
+        uint32_t id;
+        uint32_t status;
+        ///the number of elements found
+        uint64_t count;
+        ///the size of the payload in bytes
+        uint64_t payload_bytes;
+        ///the time spent by the server executing the query, in nanoseconds (the transfer of the request and of the response excluded)
+        uint64_t latency_ns;
+    };
+
+    ///the maximum payload accepted for a request
+    const uint32_t MAX_REQUEST_PAYLOAD = 1024;
+}
+
+#endif // PROTOCOL_H
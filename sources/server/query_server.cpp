@@ -0,0 +1,250 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "query_server.h"
+
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <unistd.h>
+#include <sys/socket.h>
+
+Query_Server::Query_Server(Index_Handle &handle) : handle(handle)
+{
+    this->listen_fd = -1;
+    this->stopping = false;
+}
+
+bool Query_Server::serve_socket(string path)
+{
+    this->listen_fd = Channel::listen_on(path);
+    if(this->listen_fd < 0)
+    {
+        cerr<<"[SERVER] cannot listen on "<<path<<": "<<strerror(errno)<<endl;
+        return false;
+    }
+    cerr<<"[SERVER] listening on "<<path<<endl;
+
+    while(!this->stopping)
+    {
+        int fd = accept(this->listen_fd,NULL,NULL);
+        if(fd < 0)
+        {
+            if(errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->connections_mutex);
+            this->connections.insert(fd);
+            // a connection accepted while stopping is closed as soon as it is served
+            if(this->stopping)
+                shutdown(fd,SHUT_RDWR);
+        }
+        std::thread(&Query_Server::serve_connection,this,fd).detach();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(this->connections_mutex);
+        this->connection_closed.wait(lock,[this]() { return this->connections.empty(); });
+    }
+    close(this->listen_fd);
+    unlink(path.c_str());
+    cerr<<"[SERVER] stopped"<<endl;
+    return true;
+}
+
+void Query_Server::serve_stream(int in_fd, int out_fd)
+{
+    // the responses get a private copy of the output descriptor, while the standard output is redirected on the standard error,
+    // so that the messages printed by the library cannot corrupt the stream
+    int response_fd = dup(out_fd);
+    if(out_fd == STDOUT_FILENO)
+        dup2(STDERR_FILENO,STDOUT_FILENO);
+    Channel channel(in_fd,response_fd,false);
+    this->serve(channel);
+    close(response_fd);
+}
+
+void Query_Server::stop()
+{
+    this->stopping = true;
+    // the shutdown wakes up the thread blocked on the accept, and the threads blocked reading from the (idle) clients
+    shutdown(this->listen_fd,SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(this->connections_mutex);
+    for(set<int>::iterator it=this->connections.begin(); it!=this->connections.end(); ++it)
+        shutdown(*it,SHUT_RDWR);
+}
+
+void Query_Server::serve_connection(int fd)
+{
+    bool shutdown_received;
+    {
+        Channel channel(fd,fd,false);
+        shutdown_received = this->serve(channel);
+    }
+    if(shutdown_received)
+        this->stop();
+    // the descriptor is removed before being closed, so that stop cannot shut down a reused descriptor.
+    // Nothing of the server is accessed after the notification, as the server may be destroyed as soon as the last connection is closed
+    std::lock_guard<std::mutex> lock(this->connections_mutex);
+    this->connections.erase(fd);
+    close(fd);
+    this->connection_closed.notify_all();
+}
+
+bool Query_Server::serve(Channel &channel)
+{
+    Session session(this->handle);
+    protocol::Request_Header request;
+    double coords[protocol::MAX_REQUEST_PAYLOAD / sizeof(double)];
+    bool shutdown_received = false;
+
+    while(!shutdown_received && channel.read_fully(&request,sizeof(request)))
+    {
+        protocol::Response_Header response;
+        response.magic = protocol::MAGIC;
+        response.type = request.type;
+        response.id = request.id;
+        response.count = 0;
+        response.latency_ns = 0;
+        session.payload.clear();
+
+        // a wrong header means that the stream is out of sync, thus the connection is closed after the answer
+        bool in_sync = (request.magic == protocol::MAGIC && request.payload_bytes <= protocol::MAX_REQUEST_PAYLOAD);
+        if(in_sync && !channel.read_fully(coords,request.payload_bytes))
+            break;
+
+        if(!in_sync || request.payload_bytes % sizeof(double) != 0)
+            response.status = protocol::MALFORMED;
+        else
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            response.status = this->answer(session,request.type,coords,request.payload_bytes / sizeof(double),response.count);
+            std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+            response.latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            session.requests_num++;
+            session.tot_time += response.latency_ns * 1e-9;
+            shutdown_received = (request.type == protocol::SHUTDOWN && response.status == protocol::OK);
+        }
+        response.payload_bytes = session.payload.size();
+
+        if(!channel.write_fully(&response,sizeof(response)) || !channel.write_fully(session.payload.data(),session.payload.size()) || !in_sync)
+            break;
+    }
+
+    cerr<<"[SERVER] connection closed: "<<session.requests_num<<" requests answered in "<<session.tot_time<<" sec"<<endl;
+    return shutdown_received;
+}
+
+protocol::Status Query_Server::answer(Session &session, uint32_t type, double *coords, int coords_num, uint64_t &count)
+{
+    Query_Context &context = *session.context;
+
+    if(type == protocol::SHUTDOWN)
+        return (coords_num == 0) ? protocol::OK : protocol::MALFORMED;
+    if(type == protocol::POINT)
+    {
+        if(coords_num != 3)
+            return protocol::MALFORMED;
+        Point p(coords[0],coords[1],coords[2]);
+        int t_id = this->handle.locate_point(context,p);
+        count = (t_id > 0) ? 1 : 0;
+        if(t_id > 0)
+            this->append(session.payload,&t_id,sizeof(int));
+        return protocol::OK;
+    }
+    if(type < protocol::BOX || type > protocol::WINDOWED_DISTORTION || coords_num != 6)
+        return protocol::MALFORMED;
+
+    Point min(coords[0],coords[1],coords[2]), max(coords[3],coords[4],coords[5]);
+    Box b(min,max);
+
+    if(type == protocol::BOX || type == protocol::LINE)
+    {
+        if(type == protocol::BOX)
+            this->handle.box_query(context,b);
+        else
+            this->handle.line_query(context,b);
+        count = context.qS.tetrahedra.size();
+        this->append(session.payload,context.qS.tetrahedra.data(),count*sizeof(int));
+    }
+    else if(type == protocol::WINDOWED_VT)
+    {
+        VT_Result &vt = context.vt;
+        this->handle.windowed_VT(context,b);
+        count = vt.size();
+        for(int i=0; i<vt.size(); i++)
+        {
+            int v = vt.get_vertex(i);
+            this->append(session.payload,&v,sizeof(int));
+        }
+        int offset = 0;
+        this->append(session.payload,&offset,sizeof(int));
+        for(int i=0; i<vt.size(); i++)
+        {
+            offset += vt.end(i) - vt.begin(i);
+            this->append(session.payload,&offset,sizeof(int));
+        }
+        for(int i=0; i<vt.size(); i++)
+            this->append(session.payload,vt.begin(i),(vt.end(i)-vt.begin(i))*sizeof(int));
+    }
+    else if(type == protocol::WINDOWED_TT || type == protocol::LINEARIZED_TT)
+    {
+        TT_Result &tt = context.tt;
+        if(type == protocol::WINDOWED_TT)
+            this->handle.windowed_TT(context,b);
+        else
+            this->handle.linearized_TT(context,b);
+        count = tt.size();
+        for(int i=0; i<tt.size(); i++)
+        {
+            int t_id = tt.get_tetrahedron(i);
+            this->append(session.payload,&t_id,sizeof(int));
+        }
+        for(int i=0; i<tt.size(); i++)
+            this->append(session.payload,tt.get_adjacents(i),4*sizeof(int));
+    }
+    else
+    {
+        if(!this->handle.is_distortion_supported())
+            return protocol::UNSUPPORTED;
+        Distortion_Result &dist = context.dist;
+        this->handle.windowed_Distortion(context,b);
+        count = dist.size();
+        for(int i=0; i<dist.size(); i++)
+        {
+            double value = dist.get_value(i);
+            this->append(session.payload,&value,sizeof(double));
+        }
+        for(int i=0; i<dist.size(); i++)
+        {
+            int v = dist.get_vertex(i);
+            this->append(session.payload,&v,sizeof(int));
+        }
+    }
+    return protocol::OK;
+}
@@ -0,0 +1,121 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <vector>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "protocol.h"
+#include "channel.h"
+#include "api/index_handle.h"
+
+using namespace std;
+
+/**
+ * @brief A class representing a server that keeps an index (and its mesh) in memory and answers the queries of its clients,
+ * following the binary protocol defined in protocol.h.
+ * The server listens on a Unix domain socket, and each connection is served by its own (detached) thread with its own query context,
+ * as the tree and the mesh are only read while answering. When the server stops, the open connections are shut down,
+ * and the server waits until all their threads have finished. Alternatively, a single client is served on a pair of file descriptors.
+ * The queries are executed by the Index_Handle of the C interface, which also prepares the mesh when it is created.
+ */
+class Query_Server
+{
+public:
+    /**
+     * @brief A constructor method
+     * @param handle an Index_Handle& argument, representing the index to query
+     */
+    Query_Server(Index_Handle &handle);
+    /**
+     * @brief A public method that serves the clients connecting to a Unix domain socket, until a SHUTDOWN request is received
+     * @param path a string containing the path of the socket
+     * @return true if the socket has been created, false otherwise
+     */
+    bool serve_socket(string path);
+    /**
+     * @brief A public method that serves a single client on a pair of file descriptors, until the input is closed or a SHUTDOWN request is received
+     * @param in_fd an integer representing the file descriptor from which the requests are read
+     * @param out_fd an integer representing the file descriptor on which the responses are written
+     */
+    void serve_stream(int in_fd, int out_fd);
+
+private:
+    Index_Handle &handle;
+    int listen_fd;
+    std::atomic<bool> stopping;
+    ///the descriptors of the open connections, guarded by connections_mutex
+    set<int> connections;
+    std::mutex connections_mutex;
+    ///notified when a connection is closed
+    std::condition_variable connection_closed;
+
+    ///the state of a connection, with the query context (taken from the pool of the index) reused by all its requests
+    struct Session
+    {
+        Index_Handle &handle;
+        unique_ptr<Query_Context> context;
+        ///the payload of the current response
+        vector<char> payload;
+        ///the number of requests answered and the total time spent answering them
+        long requests_num;
+        double tot_time;
+
+        Session(Index_Handle &handle) : handle(handle), context(handle.acquire_context()) { requests_num = 0; tot_time = 0; }
+        ~Session() { handle.release_context(std::move(context)); }
+    };
+
+    /**
+     * @brief A private method that answers the requests received on a channel
+     * @return true if a SHUTDOWN request has been received
+     */
+    bool serve(Channel &channel);
+    /**
+     * @brief A private method that executes a request, setting the response payload of the session
+     * @param type an integer representing the request type
+     * @param coords an array with the coordinates of the request payload
+     * @param coords_num an integer representing the number of coordinates in the request payload
+     * @param count the number of elements found
+     * @return the status of the response
+     */
+    protocol::Status answer(Session &session, uint32_t type, double *coords, int coords_num, uint64_t &count);
+    ///A private method that stops the socket server, waking up the thread waiting on the connections and the threads reading from them
+    void stop();
+    ///A private method that serves a connection accepted on the socket, and closes it
+    void serve_connection(int fd);
+    ///A private method that appends an array to the response payload
+    inline void append(vector<char> &payload, const void *data, size_t bytes)
+    {
+        const char *pos = static_cast<const char*>(data);
+        payload.insert(payload.end(),pos,pos+bytes);
+    }
+};
+
+#endif // QUERY_SERVER_H
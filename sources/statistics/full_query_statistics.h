@@ -135,6 +135,49 @@ public:
     double avg_avoided_tetra_geom_tests_num;
     int max_avoided_tetra_geom_tests_num;
 
+    /**
+     * @brief A public method that merges the statistics of another series of queries into this one
+     * (the average variables contain the sums over the queries until they are written, thus they are simply added)
+     *
+     * @param other a FullQueryStatistics& containing the statistics to merge
+     */
+    inline void merge(const FullQueryStatistics &other)
+    {
+        merge_entry(minTetra,avgTetra,maxTetra,other.minTetra,other.avgTetra,other.maxTetra);
+        merge_entry(minNode,avgNode,maxNode,other.minNode,other.avgNode,other.maxNode);
+        merge_entry(minLeaf,avgLeaf,maxLeaf,other.minLeaf,other.avgLeaf,other.maxLeaf);
+        merge_entry(minGeometricTest,avgGeometricTest,maxGeometricTest,other.minGeometricTest,other.avgGeometricTest,other.maxGeometricTest);
+        merge_entry(minUniqueTetraAccess,avgUniqueTetraAccess,maxUniqueTetraAccess,
+                    other.minUniqueTetraAccess,other.avgUniqueTetraAccess,other.maxUniqueTetraAccess);
+        merge_entry(minMultipleTetraAccess,avgMultipleTetraAccess,maxMultipleTetraAccess,
+                    other.minMultipleTetraAccess,other.avgMultipleTetraAccess,other.maxMultipleTetraAccess);
+        merge_entry(min_box_completely_contains_leaf_num,avg_box_completely_contains_leaf_num,max_box_completely_contains_leaf_num,
+                    other.min_box_completely_contains_leaf_num,other.avg_box_completely_contains_leaf_num,other.max_box_completely_contains_leaf_num);
+        merge_entry(min_box_completely_contains_bbox_num,avg_box_completely_contains_bbox_num,max_box_completely_contains_bbox_num,
+                    other.min_box_completely_contains_bbox_num,other.avg_box_completely_contains_bbox_num,other.max_box_completely_contains_bbox_num);
+        merge_entry(min_box_intersect_bbox_num,avg_box_intersect_bbox_num,max_box_intersect_bbox_num,
+                    other.min_box_intersect_bbox_num,other.avg_box_intersect_bbox_num,other.max_box_intersect_bbox_num);
+        merge_entry(min_box_no_intersect_bbox_num,avg_box_no_intersect_bbox_num,max_box_no_intersect_bbox_num,
+                    other.min_box_no_intersect_bbox_num,other.avg_box_no_intersect_bbox_num,other.max_box_no_intersect_bbox_num);
+        merge_entry(min_box_intersect_bbox_geom_tests_num,avg_box_intersect_bbox_geom_tests_num,max_box_intersect_bbox_geom_tests_num,
+                    other.min_box_intersect_bbox_geom_tests_num,other.avg_box_intersect_bbox_geom_tests_num,other.max_box_intersect_bbox_geom_tests_num);
+        merge_entry(min_tetra_compl_cont_leaf_num,avg_tetra_compl_cont_leaf_num,max_tetra_compl_cont_leaf_num,
+                    other.min_tetra_compl_cont_leaf_num,other.avg_tetra_compl_cont_leaf_num,other.max_tetra_compl_cont_leaf_num);
+        merge_entry(min_tetra_compl_cont_bbox_num,avg_tetra_compl_cont_bbox_num,max_tetra_compl_cont_bbox_num,
+                    other.min_tetra_compl_cont_bbox_num,other.avg_tetra_compl_cont_bbox_num,other.max_tetra_compl_cont_bbox_num);
+        merge_entry(min_avoided_tetra_geom_tests_num,avg_avoided_tetra_geom_tests_num,max_avoided_tetra_geom_tests_num,
+                    other.min_avoided_tetra_geom_tests_num,other.avg_avoided_tetra_geom_tests_num,other.max_avoided_tetra_geom_tests_num);
+    }
+
+private:
+    static inline void merge_entry(int &min, double &avg, int &max, int other_min, double other_avg, int other_max)
+    {
+        if(min > other_min)
+            min = other_min;
+        if(max < other_max)
+            max = other_max;
+        avg += other_avg;
+    }
 };
 
 #endif	/* _FULLQUERYSTATISTICS_H */
@@ -25,6 +25,7 @@
 #define	_INDEXSTATISTICS_H
 
 #include <vector>
+#include <cstddef>
 
 using namespace std;
 
@@ -58,6 +59,11 @@ public:
 
         t_list_length = 0;
         real_t_list_length = 0;
+
+        nodes_bytes = arena_bytes = 0;
+        t_arrays_bytes = v_arrays_bytes = run_bboxes_bytes = 0;
+        mesh_vertices_bytes = mesh_tetrahedra_bytes = 0;
+        query_bytes = 0;
     }
 
     ///A public variable representing the number of tree nodes
@@ -120,6 +126,22 @@ public:
     int t_list_length;
     ///A public variable representing the summation of the un-compressed tetrahedra arrays
     int real_t_list_length;
+    ///A public variable representing the bytes of the node structures of the hierarchy (arrays excluded)
+    size_t nodes_bytes;
+    ///A public variable representing the bytes reserved by the arena in which the nodes are allocated
+    size_t arena_bytes;
+    ///A public variable representing the bytes allocated by the tetrahedra arrays of the nodes
+    size_t t_arrays_bytes;
+    ///A public variable representing the bytes allocated by the vertices arrays (or ranges) of the nodes (P-Ttrees and PT-Ttrees only)
+    size_t v_arrays_bytes;
+    ///A public variable representing the bytes allocated by the bounding boxes of the runs of tetrahedra
+    size_t run_bboxes_bytes;
+    ///A public variable representing the bytes allocated by the mesh vertices
+    size_t mesh_vertices_bytes;
+    ///A public variable representing the bytes allocated by the mesh tetrahedra
+    size_t mesh_tetrahedra_bytes;
+    ///A public variable representing the bytes of the auxiliary structures (visited sets and results) allocated by each thread executing box queries
+    size_t query_bytes;
 };
 
 #endif	/* _INDEXSTATISTICS_H */
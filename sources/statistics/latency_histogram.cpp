@@ -0,0 +1,161 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <limits>
+
+Latency_Histogram::Latency_Histogram()
+{
+    this->count = 0;
+    this->min = std::numeric_limits<uint64_t>::max();
+    this->max = 0;
+    this->sum = 0;
+    this->max_nodes = 0;
+    this->max_geometric_tests = 0;
+}
+
+int Latency_Histogram::get_bucket(uint64_t latency_ns)
+{
+    if(latency_ns < 2*SUB_BUCKETS)
+        return latency_ns;
+    // the position of the most significant bit is at least SUB_BUCKET_BITS+1
+    int msb = 63 - __builtin_clzll(latency_ns);
+    int shift = msb - SUB_BUCKET_BITS;
+    return 2*SUB_BUCKETS + (msb-SUB_BUCKET_BITS-1)*SUB_BUCKETS + ((latency_ns >> shift) - SUB_BUCKETS);
+}
+
+uint64_t Latency_Histogram::get_bucket_max(int bucket)
+{
+    if((uint64_t)bucket < 2*SUB_BUCKETS)
+        return bucket;
+    int magnitude = (bucket - 2*SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t top = SUB_BUCKETS + (bucket - 2*SUB_BUCKETS) % SUB_BUCKETS;
+    int shift = magnitude + 1;
+    return ((top+1) << shift) - 1;
+}
+
+void Latency_Histogram::record(uint64_t latency_ns, long nodes_num, long geometric_tests_num)
+{
+    unsigned bucket = get_bucket(latency_ns);
+    if(bucket >= this->counts.size())
+    {
+        this->counts.resize(bucket+1,0);
+        this->nodes.resize(bucket+1,0);
+        this->geometric_tests.resize(bucket+1,0);
+    }
+    this->counts[bucket]++;
+    this->nodes[bucket] += nodes_num;
+    this->geometric_tests[bucket] += geometric_tests_num;
+
+    if(latency_ns > this->max || this->count == 0)
+    {
+        this->max = latency_ns;
+        this->max_nodes = nodes_num;
+        this->max_geometric_tests = geometric_tests_num;
+    }
+    if(latency_ns < this->min)
+        this->min = latency_ns;
+    this->count++;
+    this->sum += latency_ns;
+}
+
+void Latency_Histogram::merge(const Latency_Histogram &other)
+{
+    if(other.counts.size() > this->counts.size())
+    {
+        this->counts.resize(other.counts.size(),0);
+        this->nodes.resize(other.counts.size(),0);
+        this->geometric_tests.resize(other.counts.size(),0);
+    }
+    for(unsigned i=0; i<other.counts.size(); i++)
+    {
+        this->counts[i] += other.counts[i];
+        this->nodes[i] += other.nodes[i];
+        this->geometric_tests[i] += other.geometric_tests[i];
+    }
+
+    if(other.count > 0 && (other.max > this->max || this->count == 0))
+    {
+        this->max = other.max;
+        this->max_nodes = other.max_nodes;
+        this->max_geometric_tests = other.max_geometric_tests;
+    }
+    if(other.min < this->min)
+        this->min = other.min;
+    this->count += other.count;
+    this->sum += other.sum;
+}
+
+int Latency_Histogram::get_percentile_bucket(double percentile) const
+{
+    if(this->count == 0)
+        return -1;
+    // the rank of the query at the given percentile (starting from 1), computed on integers as the percentile scaled
+    // to thousandths of a percent, since a floating point product (e.g., 99.9/100*1000) can round above an integer rank
+    uint64_t scaled = (percentile > 0) ? std::llround(percentile * 1000) : 0;
+    uint64_t rank = (scaled * this->count + PERCENTILE_SCALE - 1) / PERCENTILE_SCALE;
+    if(rank < 1)
+        rank = 1;
+
+    uint64_t visited = 0;
+    for(unsigned i=0; i<this->counts.size(); i++)
+    {
+        visited += this->counts[i];
+        if(visited >= rank)
+            return i;
+    }
+    return this->counts.size()-1;
+}
+
+uint64_t Latency_Histogram::get_percentile(double percentile) const
+{
+    int bucket = this->get_percentile_bucket(percentile);
+    if(bucket < 0)
+        return 0;
+    uint64_t value = get_bucket_max(bucket);
+    return (value < this->max) ? value : this->max;
+}
+
+void Latency_Histogram::get_percentile_costs(double percentile, uint64_t &queries_num, double &avg_nodes, double &avg_geometric_tests) const
+{
+    queries_num = 0;
+    avg_nodes = 0;
+    avg_geometric_tests = 0;
+    if(this->count == 0)
+        return;
+    if(percentile >= 100)
+    {
+        // the bucket of the maximum also groups faster queries, thus the slowest one is reported by its own costs
+        queries_num = 1;
+        avg_nodes = this->max_nodes;
+        avg_geometric_tests = this->max_geometric_tests;
+        return;
+    }
+    int bucket = this->get_percentile_bucket(percentile);
+    queries_num = this->counts[bucket];
+    avg_nodes = this->nodes[bucket] / (double)queries_num;
+    avg_geometric_tests = this->geometric_tests[bucket] / (double)queries_num;
+}
@@ -0,0 +1,118 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief A class representing a histogram of the query latencies (in nanoseconds), with a bounded relative error (HDR-style).
+ * The values smaller than 2*SUB_BUCKETS are recorded exactly, while the larger ones are grouped in SUB_BUCKETS buckets
+ * per power of two, thus a recorded value differs from the upper bound of its bucket by less than 1/SUB_BUCKETS of the value.
+ * Each bucket also accumulates the number of nodes visited and of geometric tests executed by its queries,
+ * so that the costs of the slowest queries can be compared with the ones of the typical queries,
+ * while the costs of the slowest query are kept exactly, with its latency.
+ * The memory used does not depend on the number of queries recorded.
+ */
+class Latency_Histogram
+{
+public:
+    ///A constructor method
+    Latency_Histogram();
+    /**
+     * @brief A public method that records a query
+     * @param latency_ns the time spent by the query, in nanoseconds
+     * @param nodes_num the number of nodes visited by the query
+     * @param geometric_tests_num the number of geometric tests executed by the query
+     */
+    void record(uint64_t latency_ns, long nodes_num, long geometric_tests_num);
+    /**
+     * @brief A public method that adds the queries recorded by another histogram to this one
+     * @param other a Latency_Histogram& containing the queries to add
+     */
+    void merge(const Latency_Histogram &other);
+    ///A public method that returns the number of queries recorded
+    inline uint64_t get_count() const { return this->count; }
+    ///A public method that returns the minimum latency recorded (exact)
+    inline uint64_t get_min() const { return (this->count > 0) ? this->min : 0; }
+    ///A public method that returns the maximum latency recorded (exact)
+    inline uint64_t get_max() const { return this->max; }
+    ///A public method that returns the average latency
+    inline double get_mean() const { return (this->count > 0) ? this->sum / (double)this->count : 0; }
+    /**
+     * @brief A public method that returns the latency below which a percentage of the queries falls
+     * @param percentile a double between 0 and 100
+     * @return the upper bound of the bucket containing the percentile (never larger than the maximum latency)
+     */
+    uint64_t get_percentile(double percentile) const;
+    /**
+     * @brief A public method that summarizes the queries in the bucket containing a percentile
+     * The 100th percentile is summarized by the slowest query alone.
+     * @param percentile a double between 0 and 100
+     * @param queries_num set with the number of queries in the bucket
+     * @param avg_nodes set with the average number of nodes visited by these queries
+     * @param avg_geometric_tests set with the average number of geometric tests executed by these queries
+     */
+    void get_percentile_costs(double percentile, uint64_t &queries_num, double &avg_nodes, double &avg_geometric_tests) const;
+
+    ///A public static method that returns the current time of a monotonic clock, in nanoseconds
+    static inline uint64_t get_time_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    ///the number of bits of precision kept for each power of two
+    static const int SUB_BUCKET_BITS = 7;
+    static const uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    ///the scale of the percentiles when computing the ranks (the 100th percentile, in thousandths of a percent)
+    static const uint64_t PERCENTILE_SCALE = 100000;
+
+    ///the number of queries recorded, by bucket
+    vector<uint64_t> counts;
+    ///the number of nodes visited and of geometric tests executed, by bucket
+    vector<uint64_t> nodes;
+    vector<uint64_t> geometric_tests;
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+    ///the number of nodes visited and of geometric tests executed by the slowest query
+    long max_nodes;
+    long max_geometric_tests;
+
+    ///A private method that returns the bucket of a latency
+    static int get_bucket(uint64_t latency_ns);
+    ///A private method that returns the largest latency contained by a bucket
+    static uint64_t get_bucket_max(int bucket);
+    ///A private method that returns the bucket containing a percentile (-1 if no query is recorded)
+    int get_percentile_bucket(double percentile) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -27,8 +27,8 @@
 #include <list>
 #include <vector>
 #include <set>
-#include <bm/bm.h>
 #include "utilities/sorting.h"
+#include "utilities/visited_set.h"
 
 using namespace std;
 ///A class representing a container used to store the statistics obtained from a query over a spatial index
@@ -40,10 +40,10 @@ public:
     int numLeaf;
     ///A public variable representing the number of geometric tests executed during a query
     int numGeometricTest;
-    ///A public variable representing the list of tetrahedra that has been checked during a box query    
-    bm::bvector<> checkTetra;
-    ///A public array, with an entry for each tetrahedron, containing the number of accesses a tetrahedron had during a query
-    vector<int> access_per_tetra;
+    ///A public variable representing the set of tetrahedra that has been checked during a box query
+    Visited_Set checkTetra;
+    ///A public counter, with an entry for each tetrahedron, containing the number of accesses a tetrahedron had during a query
+    Access_Counter access_per_tetra;
     ///A public variable representing the tetrahedra (without duplicates) satisfying a query
     vector<int> tetrahedra;
 
@@ -60,15 +60,27 @@ public:
     int tetra_compl_cont_leaf_num;
     int tetra_compl_cont_bbox_num;
 
-    bm::bvector<> avoid_to_check_tetra;
+    Visited_Set avoid_to_check_tetra;
 
     ///A constructor method
-    QueryStatistics()  { numNode=numLeaf=numGeometricTest=0; } // used for point locations
+    QueryStatistics() // used for point locations
+    {
+        numNode=numLeaf=numGeometricTest=0;
+
+        box_completely_contains_leaf_num = box_completely_contains_bbox_num = 0;
+        box_intersect_bbox_num = box_no_intersect_bbox_num = box_intersect_bbox_geom_tests_num = 0;
+
+        tetra_compl_cont_leaf_num = tetra_compl_cont_bbox_num = 0;
+        avoided_tetra_geom_tests_num = 0;
+    }
     ///A constructor method
     QueryStatistics(int num_t, int perc_res) // used for box queries
     {
         numNode=numLeaf=numGeometricTest=0;
-        access_per_tetra = vector<int>(num_t,0);
+        // the tetrahedra are indexed from 1 to num_t
+        checkTetra.resize(num_t+1);
+        avoid_to_check_tetra.resize(num_t+1);
+        access_per_tetra = Access_Counter(num_t+1);
 
         int reserving = num_t / perc_res;
         tetrahedra.reserve(reserving);
@@ -80,12 +92,19 @@ public:
         avoided_tetra_geom_tests_num = 0;
     }
     ///A destructor method
+    /**
+     * @brief A public method that returns the bytes allocated by the auxiliary structures (visited sets, access counter and results)
+     * @return a size_t value
+     */
+    inline size_t get_bytes() const
+    {
+        return this->checkTetra.get_bytes() + this->avoid_to_check_tetra.get_bytes() + this->access_per_tetra.get_bytes()
+                + this->tetrahedra.capacity() * sizeof(int);
+    }
     virtual ~QueryStatistics()
     {
         numNode=numLeaf=numGeometricTest=0;
-        checkTetra.reset();
         tetrahedra.clear();
-        access_per_tetra.clear();
 
         box_completely_contains_leaf_num = box_completely_contains_bbox_num = 0;
         box_intersect_bbox_num = box_no_intersect_bbox_num = box_intersect_bbox_geom_tests_num = 0;
@@ -93,8 +112,6 @@ public:
         tetra_compl_cont_leaf_num = tetra_compl_cont_bbox_num = 0;
 
         avoided_tetra_geom_tests_num = 0;
-
-        avoid_to_check_tetra.reset();
     }
 
     /**
@@ -103,9 +120,9 @@ public:
     inline void reset(bool )
     {
         numNode=numLeaf=numGeometricTest=0;
-        checkTetra.reset();
+        checkTetra.clear();
         tetrahedra.clear();
-        fill(access_per_tetra.begin(),access_per_tetra.end(),0);
+        access_per_tetra.clear();
 
         box_completely_contains_leaf_num = box_completely_contains_bbox_num = 0;
         box_intersect_bbox_num = box_no_intersect_bbox_num = box_intersect_bbox_geom_tests_num = 0;
@@ -114,7 +131,7 @@ public:
 
         avoided_tetra_geom_tests_num = 0;
 
-        avoid_to_check_tetra.reset();
+        avoid_to_check_tetra.clear();
     }
     /**
      * @brief A public procedure that resets the variables of this class (point queries wrapper)
@@ -91,6 +91,21 @@ void Statistics::compute_leaf_statistics(Node_V &n, Box& dom, Mesh& mesh, bool r
     }
 }
 
+void Statistics::add_node_bytes(Node_T &n)
+{
+    this->indexStats.nodes_bytes += sizeof(Node_T);
+    this->indexStats.t_arrays_bytes += n.get_t_array_bytes();
+    this->indexStats.run_bboxes_bytes += n.get_run_bounding_boxes_bytes();
+}
+
+void Statistics::add_node_bytes(Node_V &n)
+{
+    this->indexStats.nodes_bytes += sizeof(Node_V);
+    this->indexStats.t_arrays_bytes += n.get_t_array_bytes();
+    this->indexStats.run_bboxes_bytes += n.get_run_bounding_boxes_bytes();
+    this->indexStats.v_arrays_bytes += n.get_v_array_bytes();
+}
+
 void Statistics::set_leaf_vertices_stats(int num_vertex)
 {
     if(this->indexStats.minVertexInFullLeaf==-1 || this->indexStats.minVertexInFullLeaf > num_vertex)
@@ -237,17 +252,15 @@ int Statistics::compute_queries_statistics(QueryStatistics &qS)
 
     //local analysis of access-per-tetra
     int multiple = 0;
-    int mult_counter = 0;
     int unique = 0;
-    for(int_vect_iter iter=qS.access_per_tetra.begin(); iter!=qS.access_per_tetra.end(); ++iter)
+    const vector<int> &accessed = qS.access_per_tetra.get_accessed();
+    for(unsigned i=0; i<accessed.size(); i++)
     {
-        if(*iter==1)
+        int access_num = qS.access_per_tetra.get(accessed[i]);
+        if(access_num==1)
             unique++;
         else
-        {
-            multiple += *iter;
-            mult_counter++;
-        }
+            multiple += access_num;
     }
 
     //unique tetrahedra access statistics
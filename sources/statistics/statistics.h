@@ -132,12 +132,27 @@ private:
      * @param num_t_overlapping an integer containing the number of tetrahedra simply crossing (i.e., no indexed vertices) by the leaf
      */
     void set_leaf_tetrahedra_stats(int num_t_completely, int num_t_partially, int num_t_overlapping);
+    /**
+     * @brief A private procedure that accounts the bytes of a node and of its arrays (wrapper for T-Ttrees and RT-Ttrees)
+     * @param n a Node_T& argument, representing the current node
+     */
+    void add_node_bytes(Node_T& n);
+    /**
+     * @brief A private procedure that accounts the bytes of a node and of its arrays, the vertices one included (wrapper for P-Ttrees and PT-Ttrees)
+     * @param n a Node_V& argument, representing the current node
+     */
+    void add_node_bytes(Node_V& n);
 };
 
 template<class T> void Statistics::get_index_statistics(T& tree, bool reindex)
 {
     init_vector(tree.get_mesh());
     visit_tree(tree.get_root(),tree.get_mesh().get_domain(),0,tree.get_mesh(),tree.get_decomposition(),reindex);
+    this->indexStats.arena_bytes = tree.get_nodes().get_reserved_bytes();
+    this->indexStats.mesh_vertices_bytes = tree.get_mesh().get_vertices_bytes();
+    this->indexStats.mesh_tetrahedra_bytes = tree.get_mesh().get_tetrahedra_bytes();
+    // the structures allocated by each thread executing box queries
+    this->indexStats.query_bytes = QueryStatistics(tree.get_mesh().get_num_tetrahedra(),4).get_bytes();
     calc_remaining_index_statistics();
     check_inconsistencies();
     Writer::write_tree_stats(this->indexStats);
@@ -147,6 +162,8 @@ template<class T> void Statistics::get_index_statistics(T& tree, bool reindex)
 template<class N,class D> void Statistics::visit_tree(N &n, Box& dom, int level, Mesh& mesh, D& division, bool reindex)
 {
     this->indexStats.numNode++;
+    // the arrays of the internal nodes are accounted too, as they may keep their capacity
+    this->add_node_bytes(n);
 
     if(n.is_leaf())
     {
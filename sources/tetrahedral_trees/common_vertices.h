@@ -0,0 +1,88 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef COMMON_VERTICES_H
+#define COMMON_VERTICES_H
+
+#include "basic_types/tetrahedron.h"
+#include "basic_types/mesh.h"
+
+/**
+ * @brief A class tracking the vertices shared by all the tetrahedra of a set, used by the pm criterion of the trees.
+ * The common vertices are at most four (the vertices of any tetrahedron of the set), thus each insertion
+ * updates them in constant time, intersecting them with the vertices of the new tetrahedron.
+ */
+class Common_Vertices
+{
+public:
+    ///A constructor method, initializing an empty set of tetrahedra
+    Common_Vertices() { this->vertices_num = 0; this->tetrahedra_num = 0; }
+    /**
+     * @brief A public method that updates the common vertices with a new tetrahedron
+     * @param t a Tetrahedron& argument, representing the tetrahedron added to the set
+     */
+    inline void add_tetrahedron(const Tetrahedron &t)
+    {
+        if(this->tetrahedra_num == 0)
+        {
+            for(int v=0; v<t.vertices_num(); v++)
+                this->vertices[v] = t.TV(v);
+            this->vertices_num = t.vertices_num();
+        }
+        else
+        {
+            int kept = 0;
+            for(int i=0; i<this->vertices_num; i++)
+            {
+                if(t.has_vertex(this->vertices[i]))
+                    this->vertices[kept++] = this->vertices[i];
+            }
+            this->vertices_num = kept;
+        }
+        this->tetrahedra_num++;
+    }
+    /**
+     * @brief A public method that computes the common vertices of an array of tetrahedra
+     * @param tetrahedra a const int_vect& argument, containing the tetrahedra (without runs)
+     * @param mesh a Mesh& argument, representing the tetrahedral mesh
+     */
+    inline void add_tetrahedra(const int_vect &tetrahedra, Mesh &mesh)
+    {
+        for(unsigned i=0; i<tetrahedra.size() && (this->tetrahedra_num == 0 || this->vertices_num > 0); i++)
+            this->add_tetrahedron(mesh.get_tetrahedron(tetrahedra[i]));
+    }
+    /**
+     * @brief A public method that checks if all the tetrahedra of the set are incident in a common vertex
+     * @return a boolean value, true if the set is not empty and there is a vertex shared by all its tetrahedra
+     */
+    inline bool has_common_vertex() const { return (this->vertices_num > 0); }
+
+private:
+    ///the vertices shared by all the tetrahedra of the set
+    int vertices[4];
+    int vertices_num;
+    int tetrahedra_num;
+};
+
+#endif // COMMON_VERTICES_H
@@ -0,0 +1,239 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FROZEN_NODE_H
+#define FROZEN_NODE_H
+
+#include <vector>
+#include "basic_types/box.h"
+#include "basic_types/mesh.h"
+#include "geometry/geometry_wrapper.h"
+#include "run_iterator.h"
+#include "run_bounding_box.h"
+
+/**
+ * @brief A class containing the linearized, pointer-free, representation of a Tetrahedral tree.
+ * The nodes are identified by their position index, and the arrays are indexed by these positions (structure-of-arrays).
+ * The sons of a node are stored in a contiguous block, and the blocks are placed in depth-first order.
+ * The leaves are also ranked in depth-first order: the tetrahedra arrays of the leaves (in their compressed form) are concatenated
+ * following this order, and the leaves in the subtree of a node form a contiguous range of ranks.
+ * The stored bounding boxes of the runs are concatenated in the same way.
+ * As the arrays only contain integers and plain coordinates, the layout can be copied or mapped in memory as is.
+ */
+class Frozen_Layout
+{
+public:
+    ///A constructor method
+    Frozen_Layout() {}
+    ///A public method that returns the number of nodes
+    inline int get_nodes_num() const { return this->sons.size(); }
+    ///A public method that returns the number of leaves
+    inline int get_leaves_num() const { return this->leaves.size(); }
+    ///A public method that returns the positions of the first sons (-1 for the leaves)
+    inline int_vect& get_sons() { return this->sons; }
+    ///A public method that returns, for each node, the rank of the first leaf in its subtree
+    inline int_vect& get_leaf_begins() { return this->leaf_begins; }
+    ///A public method that returns, for each node, the rank following the last leaf in its subtree
+    inline int_vect& get_leaf_ends() { return this->leaf_ends; }
+    ///A public method that returns the positions of the leaves, following their ranks
+    inline int_vect& get_leaves() { return this->leaves; }
+    ///A public method that returns the offsets of the leaf tetrahedra arrays (one entry more than the number of leaves)
+    inline int_vect& get_t_offsets() { return this->t_offsets; }
+    ///A public method that returns the concatenated tetrahedra arrays
+    inline int_vect& get_tetrahedra() { return this->tetrahedra; }
+    ///A public method that returns the offsets of the leaf run bounding boxes arrays (one entry more than the number of leaves)
+    inline int_vect& get_r_offsets() { return this->r_offsets; }
+    ///A public method that returns the concatenated run bounding boxes arrays
+    inline vector<Run_Bounding_Box>& get_run_bboxes() { return this->run_bboxes; }
+    ///A public method that returns the first vertex indexed by each leaf (0 if the leaf has no vertices range)
+    inline int_vect& get_v_starts() { return this->v_starts; }
+    ///A public method that returns the first vertex outside each leaf
+    inline int_vect& get_v_ends() { return this->v_ends; }
+    /**
+     * @brief A public method that swaps the content of two layouts
+     * @param other a Frozen_Layout& argument
+     */
+    inline void swap(Frozen_Layout &other)
+    {
+        this->sons.swap(other.sons);
+        this->leaf_begins.swap(other.leaf_begins);
+        this->leaf_ends.swap(other.leaf_ends);
+        this->leaves.swap(other.leaves);
+        this->t_offsets.swap(other.t_offsets);
+        this->tetrahedra.swap(other.tetrahedra);
+        this->r_offsets.swap(other.r_offsets);
+        this->run_bboxes.swap(other.run_bboxes);
+        this->v_starts.swap(other.v_starts);
+        this->v_ends.swap(other.v_ends);
+    }
+    /**
+     * @brief A public method that returns the size of the layout in bytes
+     * @return a size_t value
+     */
+    inline size_t get_bytes() const
+    {
+        return (sons.size() + leaf_begins.size() + leaf_ends.size() + leaves.size() +
+                t_offsets.size() + tetrahedra.size() + r_offsets.size() + v_starts.size() + v_ends.size()) * sizeof(int) +
+                run_bboxes.size() * sizeof(Run_Bounding_Box);
+    }
+
+private:
+    //indexed by node position
+    int_vect sons;
+    int_vect leaf_begins;
+    int_vect leaf_ends;
+    //indexed by leaf rank
+    int_vect leaves;
+    int_vect t_offsets;
+    int_vect tetrahedra;
+    int_vect r_offsets;
+    vector<Run_Bounding_Box> run_bboxes;
+    int_vect v_starts;
+    int_vect v_ends;
+
+    friend class Frozen_Node;
+};
+
+/**
+ * @brief The Frozen_Node class represents a node of a frozen Tetrahedral tree.
+ * A Frozen_Node only refers to a position of a Frozen_Layout, and the nodes of a frozen tree are stored in an array following the same positions.
+ * Thus, the sons are reached with an offset from the current node, and the class can be used in place of Node_V and Node_T
+ * by the (read-only) templated procedures visiting the trees.
+ * The vertices are encoded as a range, as in a Node_V of a reindexed tree.
+ */
+class Frozen_Node
+{
+public:
+    ///A constructor method
+    Frozen_Node(Frozen_Layout *layout, int id) { this->layout = layout; this->id = id; }
+    ///A public method that returns the position of the node in the layout
+    inline int get_id() const { return this->id; }
+    ///A public method that checks if the node is a leaf node
+    inline bool is_leaf() const { return (this->layout->sons[this->id] < 0); }
+    ///A public method that returns a node son
+    /*!
+     * \param i an integer argument, represents the son position into the list
+     * \return a Frozen_Node*, representing the son at the i-th position
+     */
+    inline Frozen_Node* get_son(int i) { return this + (this->layout->sons[this->id] - this->id + i); }
+    ///A public method that returns the rank of the first leaf in the subtree of the node
+    inline int get_leaves_begin() const { return this->layout->leaf_begins[this->id]; }
+    ///A public method that returns the rank following the last leaf in the subtree of the node
+    inline int get_leaves_end() const { return this->layout->leaf_ends[this->id]; }
+    ///A public method that returns a leaf of the tree
+    /*!
+     * \param rank an integer argument, representing the rank of the leaf
+     * \return a Frozen_Node*, representing the leaf
+     */
+    inline Frozen_Node* get_leaf(int rank) { return this + (this->layout->leaves[rank] - this->id); }
+
+    ///A public method that returns the run_iterator pair to navigate the tetrahedra array
+    inline RunIteratorPair make_t_array_iterator_pair() { return make_pair(this->t_array_begin_iterator(),this->t_array_end_iterator()); }
+    ///A public method that returns the begin run_iterator to navigate the tetrahedra array
+    inline RunIterator t_array_begin_iterator() { return run_iterator<int>(this->get_t_array_begin(),this->get_t_array_end()); }
+    ///A public method that returns the end run_iterator to navigate the tetrahedra array
+    inline RunIterator t_array_end_iterator() { return run_iterator<int>(this->get_t_array_end()); }
+    ///A public method that return the begin iterator of the tetrahedra array for explicitly unroll the runs of tetrahedra
+    inline int_vect_iter get_t_array_begin() { return this->layout->tetrahedra.begin() + this->t_begin(); }
+    ///A public method that return the end iterator of the tetrahedra array for explicitly unroll the runs of tetrahedra
+    inline int_vect_iter get_t_array_end() { return this->layout->tetrahedra.begin() + this->t_end(); }
+    ///A public method that returns the size of the tetrahedral array
+    inline int get_t_array_size() const { return this->t_end() - this->t_begin(); }
+    /**
+     * @brief A public method that returns the number of indexed tetrahedra
+     * NOTA: this method expand the runs and returns the real number of top d-cells indexed in the node
+     *
+     * @return int
+     */
+    inline int get_real_t_array_size() const
+    {
+        int count = 0;
+        for(int i=this->t_begin(); i<this->t_end(); i++)
+        {
+            if(this->layout->tetrahedra[i] < 0)
+            {
+                count += this->layout->tetrahedra[i+1] + 1;
+                i++;
+            }
+            else
+                count++;
+        }
+        return count;
+    }
+    /**
+     * @brief A public method that returns the bounding box of a run
+     * As in Node, the box is read from the stored array if available, otherwise it is computed.
+     *
+     * @param id an iterator to the current array entry
+     * @param bb a Box& argument, that is set with the run bounding box (if a run is found)
+     * @param mesh a Mesh& representing the tetrahedral mesh
+     * @param run a pair that will contains the run, if any
+     * @param run_id an integer containing the position of the current run, that is incremented if a run is found
+     * @return true if a run has been encounter, false otherwise
+     */
+    inline bool get_run_bounding_box(int_vect_iter &id, Box& bb, Mesh &mesh, pair<int,int> &run, int &run_id)
+    {
+        int r_begin = this->layout->r_offsets[this->get_leaves_begin()];
+        if(r_begin == this->layout->r_offsets[this->get_leaves_begin()+1])
+            return Geometry_Wrapper::get_run_bounding_box(id,bb,mesh,run);
+        if(*id<0) //I have a run
+        {
+            run.first = abs(*id);
+            ++id;
+            run.second = run.first + *id;
+            this->layout->run_bboxes[r_begin + run_id++].get_box(bb);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief A public method that returns the size of the vertices array
+     * As in a reindexed Node_V, it is 2 if the leaf encodes a vertices range, 0 otherwise
+     *
+     * @return int
+     */
+    inline int get_v_array_size() const { return (this->is_leaf() && this->get_v_start() > 0) ? 2 : 0; }
+    ///A public method that returns the first vertex indexed by the leaf
+    inline int get_v_start() const { return this->layout->v_starts[this->get_leaves_begin()]; }
+    ///A public method that returns the first vertex outside the leaf
+    inline int get_v_end() const { return this->layout->v_ends[this->get_leaves_begin()]; }
+    /**
+     * @brief A public method that checks if a vertex is indexed by the node
+     *
+     * @param v_id an integer representing the position index of the vertex
+     * @return true if v_id is indexed, false otherwise
+     */
+    inline bool indexes_vertex(int v_id) const { return (v_id >= this->get_v_start() && v_id < this->get_v_end()); }
+
+private:
+    Frozen_Layout *layout;
+    int id;
+
+    // only the leaves have a tetrahedra array
+    inline int t_begin() const { return this->layout->t_offsets[this->get_leaves_begin()]; }
+    inline int t_end() const { return this->is_leaf() ? this->layout->t_offsets[this->get_leaves_begin()+1] : this->t_begin(); }
+};
+
+#endif // FROZEN_NODE_H
@@ -0,0 +1,188 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FROZEN_TREE_H
+#define FROZEN_TREE_H
+
+#include "tree.h"
+#include "node_v.h"
+#include "node_t.h"
+#include "frozen_node.h"
+
+/**
+ * @brief The Frozen_Tree class represents a read-only, linearized, copy of a Tetrahedral tree.
+ * Once a tree has been built (and reindexed), it can be frozen in a Frozen_Layout, that encodes the hierarchy
+ * with the positions of the sons instead of pointers, and stores all the tetrahedra arrays contiguously.
+ * The class offers the same interface used by Spatial_Queries and Topological_Queries on the trees (get_root, get_mesh and get_decomposition),
+ * and thus, the queries can be executed on the frozen tree as well.
+ * NOTA: the vertices ranges of the leaves are defined only if the tree has been reindexed before freezing it.
+ */
+template<class D> class Frozen_Tree
+{
+public:
+    /**
+     * @brief A constructor method, that freezes a tree
+     * The frozen tree refers to the mesh of the input tree, while the tree hierarchy is copied and can be released.
+     *
+     * @param tree a Tree<N,D>& argument, representing the tree to freeze
+     */
+    template<class N> Frozen_Tree(Tree<N,D> &tree);
+    /**
+     * @brief A constructor method, that initializes a frozen tree from a layout (e.g., loaded from a snapshot)
+     *
+     * @param mesh a Mesh& argument, representing the mesh indexed by the layout
+     * @param layout a Frozen_Layout& argument, whose content is moved in the tree
+     */
+    Frozen_Tree(Mesh &mesh, Frozen_Layout &layout);
+    ///A public method that returns the mesh associated to the tree
+    inline Mesh& get_mesh() { return this->mesh; }
+    ///A public method that returns the root node of the tree
+    inline Frozen_Node& get_root() { return this->nodes[0]; }
+    ///A public method that returns the division type associated to the tree
+    inline D& get_decomposition() { return this->decomposition; }
+    ///A public method that returns the linearized representation of the tree
+    inline Frozen_Layout& get_layout() { return this->layout; }
+
+private:
+    ///A private variable representing the mesh associated to the tree
+    Mesh &mesh;
+    ///A private variable representing the division type of the tree
+    D decomposition;
+    ///A private variable representing the arrays encoding the tree
+    Frozen_Layout layout;
+    ///A private variable containing the nodes of the tree, one for each position of the layout
+    vector<Frozen_Node> nodes;
+
+    ///A private method that creates the nodes of the tree, one for each position of the layout
+    void init_nodes()
+    {
+        int nodes_num = this->layout.get_nodes_num();
+        this->nodes.reserve(nodes_num);
+        for(int i=0; i<nodes_num; i++)
+            this->nodes.push_back(Frozen_Node(&this->layout,i));
+    }
+    /**
+     * @brief A private method that encodes the sons of a node, and recursively their subtrees, in the layout
+     * The sons get a contiguous block of positions, while the leaves are ranked in depth-first order.
+     *
+     * @param n a N& argument, representing the current node
+     * @param pos an integer argument, representing the position of n
+     * @param dom a Box& argument, representing the node domain
+     * @param level an integer argument, representing the node level in the hierarchy
+     */
+    template<class N> void freeze_node(N &n, int pos, Box &dom, int level);
+    /**
+     * @brief A private method that returns the vertices range of a Node_V
+     * The range is encoded only if the tree has been reindexed
+     */
+    void get_v_range(Node_V &n, Box &, int &v_start, int &v_end)
+    {
+        if(n.has_v_range())
+        {
+            v_start = n.get_v_start();
+            v_end = n.get_v_end();
+        }
+    }
+    /**
+     * @brief A private method that returns the vertices range of a Node_T
+     * The range is computed from the tetrahedra in the leaf, and it is consistent only if the tree has been reindexed
+     */
+    void get_v_range(Node_T &n, Box &dom, int &v_start, int &v_end)
+    {
+        int start, end;
+        n.get_v_range(start,end,dom,this->mesh);
+        if(start != -1)
+        {
+            v_start = start;
+            v_end = end;
+        }
+    }
+
+    Frozen_Tree(const Frozen_Tree&);
+    Frozen_Tree& operator=(const Frozen_Tree&);
+};
+
+template<class D> template<class N> Frozen_Tree<D>::Frozen_Tree(Tree<N,D> &tree) : mesh(tree.get_mesh())
+{
+    this->decomposition = tree.get_decomposition();
+
+    this->layout.get_sons().push_back(-1);
+    this->layout.get_leaf_begins().push_back(0);
+    this->layout.get_leaf_ends().push_back(0);
+    this->layout.get_t_offsets().push_back(0);
+    this->layout.get_r_offsets().push_back(0);
+    this->freeze_node(tree.get_root(),0,this->mesh.get_domain(),0);
+    this->init_nodes();
+}
+
+template<class D> Frozen_Tree<D>::Frozen_Tree(Mesh &mesh, Frozen_Layout &layout) : mesh(mesh)
+{
+    this->layout.swap(layout);
+    this->init_nodes();
+}
+
+template<class D> template<class N> void Frozen_Tree<D>::freeze_node(N &n, int pos, Box &dom, int level)
+{
+    int_vect &sons = this->layout.get_sons();
+    int_vect &leaves = this->layout.get_leaves();
+
+    this->layout.get_leaf_begins()[pos] = leaves.size();
+
+    if(n.is_leaf())
+    {
+        leaves.push_back(pos);
+
+        int_vect &tetrahedra = this->layout.get_tetrahedra();
+        tetrahedra.insert(tetrahedra.end(),n.get_t_array_begin(),n.get_t_array_end());
+        this->layout.get_t_offsets().push_back(tetrahedra.size());
+        vector<Run_Bounding_Box> &run_bboxes = this->layout.get_run_bboxes();
+        run_bboxes.insert(run_bboxes.end(),n.get_run_bounding_boxes().begin(),n.get_run_bounding_boxes().end());
+        this->layout.get_r_offsets().push_back(run_bboxes.size());
+
+        int v_start = 0, v_end = 0;
+        this->get_v_range(n,dom,v_start,v_end);
+        this->layout.get_v_starts().push_back(v_start);
+        this->layout.get_v_ends().push_back(v_end);
+    }
+    else
+    {
+        int first = sons.size();
+        sons[pos] = first;
+        for(int i=0; i<this->decomposition.son_number(); i++)
+        {
+            sons.push_back(-1);
+            this->layout.get_leaf_begins().push_back(0);
+            this->layout.get_leaf_ends().push_back(0);
+        }
+        for(int i=0; i<this->decomposition.son_number(); i++)
+        {
+            Box son_dom = this->decomposition.compute_domain(dom,level,i);
+            this->freeze_node(*n.get_son(i),first+i,son_dom,level+1);
+        }
+    }
+
+    this->layout.get_leaf_ends()[pos] = leaves.size();
+}
+
+#endif // FROZEN_TREE_H
@@ -32,16 +32,14 @@ class KD_Subdivision : public Subdivision
 public:
     ///A constructor method
     KD_Subdivision() {}
-    ///A copy-constructor method
-    KD_Subdivision(const KD_Subdivision& orig) : Subdivision(orig){}
-    ///A destructor method
-    virtual ~KD_Subdivision() {}
 
+    ///A public constant representing the number of son nodes
+    static constexpr int SON_NUMBER = 2;
     ///Public method that returns the number of son nodes, in this case the costant value 2
     /*!
      * \return an integer value representing the number of sons
      */
-    inline int son_number() { return 2; }
+    static constexpr int son_number() { return SON_NUMBER; }
     ///Public method that computes the box domain of a son node.
     /*!
      * In this case the domain is computed considering the parent node level.
@@ -52,9 +50,48 @@ public:
      * \param child_ind a integer argument, representing the son index position in the sub-tree
      * \return a Box value, representing the domain of the son node
      */
-    Box compute_domain(Box& parent_dom, int level, int child_ind);
-private:
+    inline Box compute_domain(Box& parent_dom, int level, int child_ind)
+    {
+        int coord_to_change = level % 3; // 3D
+        double mid = get_middle_coordinate(parent_dom,coord_to_change);
+        Box son_dom = parent_dom;
+        if(child_ind == 1)
+            son_dom.get_min().set_c(coord_to_change,mid);
+        else if(child_ind == 0)
+            son_dom.get_max().set_c(coord_to_change,mid);
+        return son_dom;
+    }
+    ///Public method that computes the box domains of the two son nodes
+    /*!
+     * \param parent_dom a Box& argument, representing the node domain
+     * \param level an integer argument representing the level of n in the hierarchy
+     * \param son_doms a Box* argument, pointing to an array of SON_NUMBER boxes, that are set with the domains of the sons
+     */
+    inline void compute_domains(Box& parent_dom, int level, Box* son_doms)
+    {
+        int coord_to_change = level % 3; // 3D
+        double mid = get_middle_coordinate(parent_dom,coord_to_change);
+        son_doms[0] = parent_dom;
+        son_doms[0].get_max().set_c(coord_to_change,mid);
+        son_doms[1] = parent_dom;
+        son_doms[1].get_min().set_c(coord_to_change,mid);
+    }
+    ///Public method that returns which half of a coordinate axis is covered by a son node
+    /*!
+     * Only the axis level%3 is splitted, son 0 covering the lower half and son 1 the upper one.
+     *
+     * \param level an integer argument representing the level of the parent node in the hierarchy
+     * \param child_ind a integer argument, representing the son index position in the sub-tree
+     * \param axis an integer argument, representing the coordinate axis
+     * \return an integer value, 1 for the upper half, 0 for the lower half and -1 if the axis is not splitted
+     */
+    static inline int son_half(int level, int child_ind, int axis) { return (axis == level % 3) ? child_ind : -1; }
 
+private:
+    static inline double get_middle_coordinate(Box& parent_dom, int axis)
+    {
+        return parent_dom.get_min().get_c(axis)+(parent_dom.get_max().get_c(axis)-parent_dom.get_min().get_c(axis))/2.0;
+    }
 };
 
 #endif	/* _KDDIVISION_H */
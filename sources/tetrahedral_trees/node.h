@@ -30,7 +30,9 @@
 #include <bm/bm.h>
 #include "basic_types/box.h"
 #include "basic_types/mesh.h"
+#include "geometry/geometry_wrapper.h"
 #include "run_iterator.h"
+#include "run_bounding_box.h"
 
 /**
  * @brief A super-class, not instantiable, that represents a generic node of the tree with associated an array of tetrahedra
@@ -39,13 +41,7 @@ template<class N> class Node
 {
 public:
     ///A destructor method
-    virtual ~Node() {}
-    ///A public method that sets a node son
-    /*!
-     * \param n a N* argument, represents the son to set
-     * \param pos an integer, represents the son position in the array
-     */
-    inline void set_son(N* n, int pos) { this->sons[pos] = n; }
+    ~Node() {}
     ///A public method that checks if the node is a leaf node
     /*!
      * \return a boolean, true if the node is a leaf, false otherwise
@@ -56,12 +52,12 @@ public:
      * \param i an integer argument, represents the son position into the list
      * \return a Node*, representing the son at the i-th position
      */
-    inline N* get_son(int i) { return this->sons[i]; }
+    inline N* get_son(int i) { return &this->sons[i]; }
     /**
-     * @brief A public method that initializes the sons array
-     * @param son_number an integer containing the sons number
+     * @brief A public method that sets the sons of the node
+     * @param sons_block a N* argument, pointing to a contiguous block of nodes (allocated by the tree arena)
      */
-    inline void init_sons(int son_number) { this->sons = new N*[son_number]; }
+    inline void set_sons(N* sons_block) { this->sons = sons_block; }
     ///A public method that adds a tetrahedron index to the array
     /*!
      * \param ind an integer argument, representing the tetrahedron index
@@ -88,16 +84,28 @@ public:
      * @return int
      */
     inline int get_t_array_size() { return this->tetrahedra.size(); }
+    /**
+     * @brief A public method that returns the bytes allocated by the tetrahedra array
+     *
+     * @return size_t
+     */
+    inline size_t get_t_array_bytes() const { return this->tetrahedra.capacity() * sizeof(int); }
     /**
      * @brief A public method returning the tetrahedra array
      *
      * @return
      */
     inline int_vect get_t_array() const { return this->tetrahedra; }
+    /**
+     * @brief A public method that sets the tetrahedra array, swapping its content with the one of the argument
+     *
+     * @param t_array an int_vect& argument containing the tetrahedra indices
+     */
+    inline void set_t_array(int_vect &t_array) { this->tetrahedra.swap(t_array); this->run_bboxes.clear(); }
     /**
      * @brief A public method that clears the space used by the tetrahedra array
      */
-    inline void clear_t_array() { tetrahedra.clear(); }
+    inline void clear_t_array() { tetrahedra.clear(); run_bboxes.clear(); }
     ///A public method that return the begin iterator of the tetrahedra array for explicitly unroll the runs of tetrahedra
     inline int_vect_iter get_t_array_begin() { return this->tetrahedra.begin(); }
     ///A public method that return the end iterator of the tetrahedra array for explicitly unroll the runs of tetrahedra
@@ -135,14 +143,54 @@ public:
         return false;
     }
     /**
-     * @brief A public method that computes the bounding box of a run
+     * @brief A public method that returns the bounding box of a run
+     * If the bounding boxes of the runs have been stored (see compute_run_bounding_boxes), the box is read from the stored array,
+     * otherwise it is computed from the vertices of the tetrahedra in the run.
+     * The runs must be visited in order, starting with run_id equal to 0.
+     *
      * @param id an iterator to the current array entry
      * @param bb a Box& argument, that is set with the run bounding box (if a run is found)
      * @param mesh a Mesh& representing the tetrahedral mesh
      * @param run a pair that will contains the run, if any
+     * @param run_id an integer containing the position of the current run, that is incremented if a run is found
      * @return true if a run has been encounter, false otherwise
      */
-    bool get_run_bounding_box(int_vect_iter &id, Box& bb, Mesh &mesh, pair<int,int> &run);
+    inline bool get_run_bounding_box(int_vect_iter &id, Box& bb, Mesh &mesh, pair<int,int> &run, int &run_id)
+    {
+        if(this->run_bboxes.empty())
+            return Geometry_Wrapper::get_run_bounding_box(id,bb,mesh,run);
+        if(*id<0) //I have a run
+        {
+            run.first = abs(*id);
+            ++id;
+            run.second = run.first + *id;
+            this->run_bboxes[run_id++].get_box(bb);
+            return true;
+        }
+        return false;
+    }
+    /**
+     * @brief A public method that computes and stores the bounding boxes of the runs of the tetrahedra array
+     * The method must be called each time the tetrahedra array or the mesh geometry change.
+     *
+     * @param mesh a Mesh& representing the tetrahedral mesh
+     */
+    inline void compute_run_bounding_boxes(Mesh &mesh)
+    {
+        vector<Run_Bounding_Box> boxes;
+        Box bb;
+        pair<int,int> run;
+        for(int_vect_iter it=this->tetrahedra.begin(); it!=this->tetrahedra.end(); ++it)
+        {
+            if(Geometry_Wrapper::get_run_bounding_box(it,bb,mesh,run))
+                boxes.push_back(Run_Bounding_Box(bb));
+        }
+        this->run_bboxes.swap(boxes);
+    }
+    ///A public method that returns the stored bounding boxes of the runs
+    inline vector<Run_Bounding_Box>& get_run_bounding_boxes() { return this->run_bboxes; }
+    ///A public method that returns the bytes allocated by the bounding boxes of the runs
+    inline size_t get_run_bounding_boxes_bytes() const { return this->run_bboxes.capacity() * sizeof(Run_Bounding_Box); }
 
 protected:    
     ///A constructor method
@@ -152,71 +200,15 @@ protected:
     {
         this->sons = orig.sons;
         this->tetrahedra = orig.tetrahedra;
+        this->run_bboxes = orig.run_bboxes;
     }
-    ///A protected variable representing the list of node sons
-    N** sons;
+    ///A protected variable representing the block of node sons (stored contiguously)
+    N* sons;
     ///A private variable representing the list containing the tetrahedra indexed by the node
     int_vect tetrahedra;
+    ///A private variable containing the bounding boxes of the runs of the tetrahedra array (if computed), following the runs order
+    vector<Run_Bounding_Box> run_bboxes;
 };
 
-template<class N> bool Node<N>::get_run_bounding_box(int_vect_iter &id, Box& bb, Mesh &mesh, pair<int,int> &run)
-{
-    if(*id<0) //I have a run
-    {
-        run.first = abs(*id);
-        ++id;
-        run.second = run.first + *id;
-
-        double min_p[3]={std::numeric_limits<double>::max(),std::numeric_limits<double>::max(),std::numeric_limits<double>::max()};
-        double max_p[3]={-std::numeric_limits<double>::max(),-std::numeric_limits<double>::max(),-std::numeric_limits<double>::max()};
-
-//        // init phase
-//        int t_id=run.first;
-//        Tetrahedron &t_first = mesh.get_tetrahedron(t_id);
-//        min_p[0] = mesh.get_vertex(t_first.TV(0)).get_x();
-//        min_p[1] = mesh.get_vertex(t_first.TV(0)).get_y();
-//        min_p[2] = mesh.get_vertex(t_first.TV(0)).get_z();
-//        max_p[0] = mesh.get_vertex(t_first.TV(0)).get_x();
-//        max_p[1] = mesh.get_vertex(t_first.TV(0)).get_y();
-//        max_p[2] = mesh.get_vertex(t_first.TV(0)).get_z();
-
-//        for(int i=1; i<t_first.vertices_num(); i++)
-//        {
-//            Vertex &v = mesh.get_vertex(t_first.TV(i));
-//            for(int j=0;j<v.get_dimension();j++)
-//            {
-//                if(v.get_c(j) < min_p[j])
-//                    min_p[j] = v.get_c(j);
-//                else if(v.get_c(j) > max_p[j])
-//                    max_p[j] = v.get_c(j);
-//            }
-//        }
-//        t_id++;
-        for(int t_id=run.first; t_id<=run.second; t_id++)
-        {
-            Tetrahedron &tet = mesh.get_tetrahedron(t_id);
-            for(int i=0; i<tet.vertices_num(); i++)
-            {
-                Vertex &v = mesh.get_vertex(tet.TV(i));
-                for(int j=0;j<v.get_dimension();j++)
-                {
-                    if(v.get_c(j) < min_p[j])
-                        min_p[j] = v.get_c(j);
-                    if(v.get_c(j) > max_p[j])
-                        max_p[j] = v.get_c(j);
-                }
-            }
-        }
-        //save the computed bounding box
-        bb.set_min(min_p[0],min_p[1],min_p[2]);
-        bb.set_max(max_p[0],max_p[1],max_p[2]);
-        return true;
-    }
-    else
-    {
-        return false;
-    }
-}
-
 #endif	/* _NODE_H */
 
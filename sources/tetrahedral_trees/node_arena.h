@@ -0,0 +1,114 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <cstddef>
+
+/**
+ * @brief A class representing an arena allocator for the nodes of a tree.
+ * The nodes are allocated in large chunks, and the sons of a node are always stored in a contiguous block.
+ * All the nodes are released together with the arena.
+ * The copies of an arena share the same nodes, which are released when the last copy is destroyed
+ * (this is needed as the tree copy-constructors copy the root, and thus the pointer to its sons).
+ * The allocation is thread-safe.
+ */
+template<class N> class Node_Arena
+{
+public:
+    ///A constructor method
+    Node_Arena() : storage(new Storage()) {}
+    /**
+     * @brief A public method that allocates a contiguous block of default-constructed nodes
+     * @param son_number an integer containing the number of nodes of the block
+     * @return a pointer to the first node of the block
+     */
+    inline N* allocate_sons(int son_number) { return this->storage->allocate(son_number); }
+    /**
+     * @brief A public method that returns the number of nodes allocated by the arena
+     * @return a size_t value
+     */
+    inline size_t get_nodes_num() const { return this->storage->nodes_num; }
+    /**
+     * @brief A public method that returns the number of bytes reserved by the arena
+     * @return a size_t value
+     */
+    inline size_t get_reserved_bytes() const { return this->storage->chunks.size() * CHUNK_NODES * sizeof(N); }
+
+private:
+    ///the number of nodes contained by a chunk
+    static const size_t CHUNK_NODES = 4096;
+
+    ///the chunks of nodes, shared by the copies of the arena
+    struct Storage
+    {
+        std::mutex mutex;
+        std::vector<N*> chunks;
+        ///the number of nodes used in the last chunk
+        size_t used;
+        ///the total number of nodes allocated
+        size_t nodes_num;
+
+        Storage() { used = CHUNK_NODES; nodes_num = 0; }
+        ~Storage()
+        {
+            for(size_t c=0; c<chunks.size(); c++)
+            {
+                size_t chunk_used = (c+1 == chunks.size()) ? used : CHUNK_NODES;
+                for(size_t i=0; i<chunk_used; i++)
+                    chunks[c][i].~N();
+                ::operator delete(chunks[c]);
+            }
+        }
+        N* allocate(int son_number)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(used + son_number > CHUNK_NODES)
+            {
+                // the remaining nodes of the last chunk are initialized, as the destructor visits them
+                if(!chunks.empty())
+                {
+                    for(; used < CHUNK_NODES; used++)
+                        new (&chunks.back()[used]) N();
+                }
+                chunks.push_back(static_cast<N*>(::operator new(CHUNK_NODES * sizeof(N))));
+                used = 0;
+            }
+            N* block = &chunks.back()[used];
+            for(int i=0; i<son_number; i++)
+                new (&block[i]) N();
+            used += son_number;
+            nodes_num += son_number;
+            return block;
+        }
+    };
+
+    std::shared_ptr<Storage> storage;
+};
+
+#endif // NODE_ARENA_H
@@ -38,7 +38,7 @@ public:
     ///A copy-constructor
     Node_T(const Node_T& orig) : Node<Node_T>(orig) { }
     ///A destructor
-    virtual ~Node_T() {}
+    ~Node_T() {}
     friend std::ostream& operator<<(std::ostream& out, const Node_T& p)
     {
         if(p.is_leaf())
@@ -38,12 +38,18 @@ public:
     ///A copy-constructor
     Node_V(const Node_V& orig) : Node<Node_V>(orig) { this->vertices = orig.vertices; }
     ///A destructor
-    virtual ~Node_V() {}
+    ~Node_V() {}
     ///A public method that add a vertex index to the corresponding node list
     /*!
      * \param ind an integer argument, representing the vertex index
      */
     inline void add_vertex(int ind) { this->vertices.push_back(ind); }
+    /**
+     * @brief A public method that sets the vertices array, swapping its content with the one of the argument
+     *
+     * @param v_array an int_vect& argument containing the vertices indices
+     */
+    inline void set_v_array(int_vect &v_array) { this->vertices.swap(v_array); }
     ///A public method that free space occupied by the two lists
     inline void clear_v_array() { this->vertices.clear(); }
     /**
@@ -53,6 +59,12 @@ public:
      * @param end an integer with the first vertex position index outside the node
      */
     inline void set_v_range(int start, int end) { vertices.push_back(-start); vertices.push_back(end-start-1); }
+    /**
+     * @brief A public method that checks if the vertices are encoded as a range
+     *
+     * @return true if the vertices array encodes a range, false otherwise
+     */
+    inline bool has_v_range() const { return (vertices.size() == 2 && vertices[0] < 0); }
     ///
     inline int get_v_start() const { return abs(vertices[0]); }
     ///
@@ -150,6 +162,12 @@ public:
      * @return int
      */
     inline int get_v_array_size() const { return this->vertices.size(); }
+    /**
+     * @brief A public method that returns the bytes allocated by the vertices array
+     *
+     * @return size_t
+     */
+    inline size_t get_v_array_bytes() const { return this->vertices.capacity() * sizeof(int); }
 
 protected:    
    int_vect vertices;
@@ -32,16 +32,14 @@ class OK_Subdivision : public Subdivision
 public:
     ///A constructor method
     OK_Subdivision()  {}
-    ///A copy-constructor method
-    OK_Subdivision(const OK_Subdivision& orig) : Subdivision(orig){}
-    ///A destructor method
-    virtual ~OK_Subdivision() {}
 
+    ///A public constant representing the number of son nodes
+    static constexpr int SON_NUMBER = 8;
     ///Public method that returns the number of son nodes, in this case the costant value 8
     /*!
      * \return an integer value representing the number of son nodes
      */
-    inline int son_number() { return 8; }
+    static constexpr int son_number() { return SON_NUMBER; }
     ///Public method that computes the box domain of a son node
     /*!     
      * \param parent_dom a Box& argument, representing the node domain
@@ -49,12 +47,73 @@ public:
      * \param child_ind a integer argument, representing the son index position in the sub-tree
      * \return a Box value, representing the domain of the son node
      */
-    Box compute_domain(Box& parent_dom, int, int child_ind);
+    inline Box compute_domain(Box& parent_dom, int, int child_ind)
+    {
+        double mid[3];
+        get_middle_point(parent_dom,mid);
+        Box son_dom;
+        set_son_domain(parent_dom,mid,child_ind,son_dom);
+        return son_dom;
+    }
+    ///Public method that computes the box domains of all the son nodes
+    /*!
+     * The middle point of the parent domain is computed once, and shared by all the sons.
+     *
+     * \param parent_dom a Box& argument, representing the node domain
+     * \param level an integer argument representing the level of n in the hierarchy (unused)
+     * \param son_doms a Box* argument, pointing to an array of SON_NUMBER boxes, that are set with the domains of the sons
+     */
+    inline void compute_domains(Box& parent_dom, int, Box* son_doms)
+    {
+        double mid[3];
+        get_middle_point(parent_dom,mid);
+        for(int i=0; i<SON_NUMBER; i++)
+            set_son_domain(parent_dom,mid,i,son_doms[i]);
+    }
+    ///Public method that returns which half of a coordinate axis is covered by a son node
+    /*!
+     * The x and y axes are covered in their upper half by the sons 0,1,4,5 and 0,2,4,6, respectively,
+     * while the z axis is covered in its upper half by the sons 4,5,6,7 (see son_halves).
+     *
+     * \param level an integer argument representing the level of the parent node in the hierarchy (unused)
+     * \param child_ind a integer argument, representing the son index position in the sub-tree
+     * \param axis an integer argument, representing the coordinate axis
+     * \return an integer value, 1 for the upper half, 0 for the lower half and -1 if the axis is not splitted
+     */
+    static inline int son_half(int, int child_ind, int axis) { return son_halves[child_ind][axis]; }
+
 private:
+    /// the half (1 upper, 0 lower) of each coordinate axis covered by each son
+    /// NOTA: this ordering has been pushed-back from the 2016 implementation, that visits differently some of the children
+    /// (0 and 3, and 4 and 7) w.r.t. Stellar trees and Terrain trees. We keep it to be coherent with the experiments executed back then,
+    /// as different visit orderings lead to different reindexing and, later, to different geometric tests executed for a query
+    static constexpr int son_halves[SON_NUMBER][3] = { {1,1,0}, {1,0,0}, {0,1,0}, {0,0,0},
+                                                       {1,1,1}, {1,0,1}, {0,1,1}, {0,0,1} };
 
+    static inline void get_middle_point(Box& parent_dom, double mid[3])
+    {
+        Point &p_min = parent_dom.get_min();
+        Point &p_max = parent_dom.get_max();
+        for(int j=0; j<3; j++)
+            mid[j] = p_min.get_c(j)+(p_max.get_c(j)-p_min.get_c(j))/2.0;
+    }
+    static inline void set_son_domain(Box& parent_dom, const double mid[3], int child_ind, Box& son_dom)
+    {
+        for(int j=0; j<3; j++)
+        {
+            if(son_halves[child_ind][j])
+            {
+                son_dom.get_min().set_c(j,mid[j]);
+                son_dom.get_max().set_c(j,parent_dom.get_max().get_c(j));
+            }
+            else
+            {
+                son_dom.get_min().set_c(j,parent_dom.get_min().get_c(j));
+                son_dom.get_max().set_c(j,mid[j]);
+            }
+        }
+    }
 };
 
-
-
 #endif	/* _OKDIVISION_H */
 
@@ -27,6 +27,8 @@
 #include "tree.h"
 #include "node_v.h"
 #include <geometry/geometry_wrapper.h>
+#include <utilities/sorting.h>
+#include <algorithm>
 
 ///An inner-class, implementing Tree, that represents a tree which uses the Point-based criterion
 template<class D> class P_Tree : public Tree<Node_V,D>
@@ -57,6 +59,29 @@ public:
      * The insertion of tetrahedra does not change the hierarchy.
      */
     void build_tree();
+    ///A public method that builds the tree top-down in parallel
+    /*!
+     * A node is splitted if it contains more vertices than the threshold, as in build_tree.
+     *
+     * \param threads_num an integer argument, representing the number of threads used
+     */
+    void build_tree_bulk(int threads_num);
+    ///A public method that builds the tree by sorting the vertices on their locational codes
+    /*!
+     * As the hierarchy depends only on the vertices position, the locational code of each vertex is computed
+     * (following the son order of the subdivision) and the vertices are sorted with a parallel radix sort.
+     * Then, each node covers a contiguous range of the sorted array, and it is splitted if the range contains more vertices than the threshold.
+     * The mesh vertices are reordered following the sorted array, thus, the nodes directly encode their vertices as ranges
+     * (as done by the Reindexer). Finally, the tetrahedra are inserted top-down into the hierarchy.
+     * The hierarchy is the same produced by build_tree.
+     *
+     * \param threads_num an integer argument, representing the number of threads used
+     */
+    void build_tree_morton(int threads_num);
+
+protected:
+    ///A protected method that decides if a node is a leaf during the bulk construction
+    void bulk_node(Node_V& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool);
 
 private:
     ///A private variable representing the maximum number of vertices admitted for a node
@@ -98,6 +123,43 @@ private:
      * \return a boolean value, true if the limit is exceeded, false otherwise
      */
     inline bool is_full(Node_V &n) { return (n.get_v_array_size() > this->vertices_threshold); }
+
+    ///A private variable representing the first son covering a combination of upper/lower halves of the axes, for each level modulo 3
+    int code_sons[3][8];
+    ///A private variable representing the number of bits encoding a level in a locational code
+    int code_bits;
+    ///A private variable representing the number of levels encoded by a locational code
+    int code_levels;
+    ///A private method that initializes the variables used to compute the locational codes
+    void init_locational_codes();
+    ///A private method that computes the locational code of a vertex
+    /*!
+     * The code contains the son indices visited by the vertex insertion starting from a given node,
+     * and it is computed by halving the node domain with the same operations executed by the subdivision.
+     *
+     * \param v an integer argument, represents the vertex index
+     * \param domain a Box& argument, represents the domain of the starting node
+     * \param level an integer argument representing the level of the starting node in the hierarchy
+     * \return the locational code of the vertex
+     */
+    uint64_t compute_locational_code(int v, Box& domain, int level);
+    ///A private method that builds the subtree covering a range of the vertices sorted on their locational codes
+    /*!
+     * \param n a Node_V& argument, represents the node
+     * \param domain a Box& argument, represents the node domain
+     * \param level an integer argument representing the level of n in the hierarchy
+     * \param codes a vector<code_vertex_pair>& argument, containing the sorted vertices
+     * \param begin an integer argument, representing the first position of the range
+     * \param end an integer argument, representing the first position outside the range
+     * \param code_level an integer argument, representing the level from which the codes have been computed
+     * \param pool a Thread_Pool& argument, executing the tasks
+     */
+    void morton_node(Node_V& n, Box& domain, int level, vector<code_vertex_pair>& codes, int begin, int end, int code_level, Thread_Pool& pool);
+    ///A private method that reorders the mesh vertices following the sorted array
+    /*!
+     * \param codes a vector<code_vertex_pair>& argument, containing the sorted vertices
+     */
+    void reorder_mesh_vertices(vector<code_vertex_pair>& codes);
 };
 
 template<class D> P_Tree<D>::P_Tree(int vertices_per_leaf)
@@ -124,6 +186,206 @@ template<class D> void P_Tree<D>::build_tree()
     }
 }
 
+template<class D> void P_Tree<D>::build_tree_bulk(int threads_num)
+{
+    Thread_Pool pool(threads_num);
+    int_vect vertices, tetrahedra;
+    vertices.reserve(this->mesh.get_num_vertices());
+    for(int i=1;i<=this->mesh.get_num_vertices(); i++)
+        vertices.push_back(i);
+    this->init_bulk_tetrahedra(tetrahedra);
+    this->bulk_node(this->root,this->mesh.get_domain(),0,vertices,tetrahedra,0,pool);
+    pool.wait();
+}
+
+template<class D> void P_Tree<D>::bulk_node(Node_V& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int, Thread_Pool& pool)
+{
+    if((int)vertices.size() > this->vertices_threshold)
+        this->bulk_split(n,domain,level,vertices,tetrahedra,0,pool);
+    else
+    {
+        n.set_v_array(vertices);
+        n.set_t_array(tetrahedra);
+    }
+}
+
+template<class D> void P_Tree<D>::build_tree_morton(int threads_num)
+{
+    Thread_Pool pool(threads_num);
+    this->init_locational_codes();
+
+    int num_v = this->mesh.get_num_vertices();
+    vector<code_vertex_pair> codes(num_v);
+    int chunk_size = std::max(1,num_v / (4 * pool.get_threads_num()));
+    for(int c=0; c<num_v; c+=chunk_size)
+    {
+        pool.submit([this,&codes,c,chunk_size,num_v]()
+        {
+            for(int i=c; i<std::min(num_v,c+chunk_size); i++)
+            {
+                codes[i].v = i+1;
+                codes[i].code = this->compute_locational_code(i+1,this->mesh.get_domain(),0);
+            }
+        });
+    }
+    pool.wait();
+    radix_sorting(codes,pool);
+
+    this->morton_node(this->root,this->mesh.get_domain(),0,codes,0,num_v,0,pool);
+    pool.wait();
+    this->reorder_mesh_vertices(codes);
+
+    int_vect tetrahedra;
+    this->init_bulk_tetrahedra(tetrahedra);
+    this->bulk_tetrahedra(this->root,this->mesh.get_domain(),0,tetrahedra,pool);
+    pool.wait();
+}
+
+template<class D> void P_Tree<D>::init_locational_codes()
+{
+    int son_number = this->decomposition.son_number();
+    this->code_bits = 0;
+    while((1 << this->code_bits) < son_number)
+        this->code_bits++;
+    this->code_levels = 63 / this->code_bits;
+
+    for(int l=0; l<3; l++)
+    {
+        for(int mask=7; mask>=0; mask--)
+        {
+            this->code_sons[l][mask] = 0;
+            for(int s=son_number-1; s>=0; s--)
+            {
+                bool matches = true;
+                for(int a=0; a<3 && matches; a++)
+                {
+                    int half = this->decomposition.son_half(l,s,a);
+                    matches = (half == -1 || half == ((mask >> a) & 1));
+                }
+                if(matches)
+                    this->code_sons[l][mask] = s;
+            }
+        }
+    }
+}
+
+template<class D> uint64_t P_Tree<D>::compute_locational_code(int v, Box& domain, int level)
+{
+    Vertex vert = this->mesh.get_vertex(v);
+    Point &max_domain = this->mesh.get_domain().get_max();
+    double min[3], max[3];
+    for(int a=0; a<3; a++)
+    {
+        min[a] = domain.get_min().get_c(a);
+        max[a] = domain.get_max().get_c(a);
+    }
+
+    uint64_t code = 0;
+    for(int l=level; l<level+this->code_levels; l++)
+    {
+        // the upper halves containing the vertex, and the axes where the vertex is contained by both halves
+        int upper = 0, both = 0;
+        for(int a=0; a<3; a++)
+        {
+            if(this->decomposition.son_half(l,0,a) == -1)
+                continue;
+            double mid = min[a]+(max[a]-min[a])/2.0;
+            if(vert.get_c(a) >= mid)
+            {
+                upper |= 1 << a;
+                // the lower half is closed if it touches the mesh domain
+                if(mid == max_domain.get_c(a))
+                    both |= 1 << a;
+            }
+        }
+        // as during the insertion, the vertex goes in the first son containing it
+        int son = this->code_sons[l%3][upper];
+        for(int m=both; m>0; m=(m-1)&both)
+            son = std::min(son,this->code_sons[l%3][upper&~m]);
+        code = (code << this->code_bits) | son;
+
+        for(int a=0; a<3; a++)
+        {
+            int half = this->decomposition.son_half(l,son,a);
+            if(half == -1)
+                continue;
+            double mid = min[a]+(max[a]-min[a])/2.0;
+            if(half == 1)
+                min[a] = mid;
+            else
+                max[a] = mid;
+        }
+    }
+    return code;
+}
+
+template<class D> void P_Tree<D>::morton_node(Node_V& n, Box& domain, int level, vector<code_vertex_pair>& codes, int begin, int end, int code_level, Thread_Pool& pool)
+{
+    if(end - begin > this->vertices_threshold)
+    {
+        // the codes do not encode deeper levels: we compute them again from the current node
+        if(level - code_level == this->code_levels)
+        {
+            for(int i=begin; i<end; i++)
+                codes[i].code = this->compute_locational_code(codes[i].v,domain,level);
+            std::sort(codes.begin()+begin,codes.begin()+end);
+            code_level = level;
+        }
+        int shift = (this->code_levels - 1 - (level - code_level)) * this->code_bits;
+        uint64_t son_mask = (1 << this->code_bits) - 1;
+
+        this->init_sons(n);
+        n.set_v_range(begin+1,end+1);
+
+        bool spawn = (end - begin > (int)this->BULK_TASK_CUTOFF);
+        int son_begin = begin;
+        for(int i=0;i<this->decomposition.son_number();i++)
+        {
+            // the sons cover consecutive ranges of the sorted array
+            int son_end = std::partition_point(codes.begin()+son_begin,codes.begin()+end,
+                                               [shift,son_mask,i](const code_vertex_pair &p) { return (int)((p.code >> shift) & son_mask) <= i; }) - codes.begin();
+            Node_V *s = n.get_son(i);
+            Box son_dom = this->decomposition.compute_domain(domain,level,i);
+            if(spawn)
+                pool.submit([this,s,son_dom,level,&codes,son_begin,son_end,code_level,&pool]() mutable
+                            { this->morton_node(*s,son_dom,level+1,codes,son_begin,son_end,code_level,pool); });
+            else
+                this->morton_node(*s,son_dom,level+1,codes,son_begin,son_end,code_level,pool);
+            son_begin = son_end;
+        }
+    }
+    else if(end > begin)
+    {
+        // inside a leaf, the vertices keep their original order
+        std::sort(codes.begin()+begin,codes.begin()+end,[](const code_vertex_pair &a, const code_vertex_pair &b) { return a.v < b.v; });
+        n.set_v_range(begin+1,end+1);
+    }
+}
+
+template<class D> void P_Tree<D>::reorder_mesh_vertices(vector<code_vertex_pair>& codes)
+{
+    int_vect new_indices(codes.size());
+    vector<Vertex> vertices;
+    vertices.reserve(codes.size());
+    for(unsigned i=0; i<codes.size(); i++)
+    {
+        vertices.push_back(this->mesh.get_vertex(codes[i].v));
+        new_indices[codes[i].v-1] = i+1;
+    }
+
+    this->mesh.reset_vertices();
+    this->mesh.reserve_vertices_space(vertices.size());
+    for(unsigned i=0; i<vertices.size(); i++)
+        this->mesh.add_vertex(vertices[i]);
+
+    for(int i=1;i<=this->mesh.get_num_tetrahedra();i++)
+    {
+        Tetrahedron& t = this->mesh.get_tetrahedron(i);
+        for(int j=0;j<t.vertices_num();j++)
+            t.setTV(j,new_indices[t.TV(j)-1]);
+    }
+}
+
 template<class D> void P_Tree<D>::add_vertex(Node_V& n, Box& domain, int level, int v)
 {
     if (n.is_leaf())
@@ -168,13 +430,7 @@ template<class D> void P_Tree<D>::add_tetrahedron(Node_V& n, Box& domain, int le
 
 template<class D> void P_Tree<D>::split(Node_V& n, Box& domain, int level)
 {
-    n.init_sons(this->decomposition.son_number());
-    //initilize the son nodes
-    for(int i=0;i<this->decomposition.son_number();i++)
-    {
-        Node_V* s = new Node_V();
-        n.set_son(s,i);
-    }
+    this->init_sons(n);
 
     //re-insert the vertices
     for(RunIterator runIt = n.v_array_begin_iterator(), runEnd = n.v_array_end_iterator(); runIt != runEnd; ++runIt)
@@ -189,5 +445,9 @@ template<class D> void P_Tree<D>::split(Node_V& n, Box& domain, int level)
     n.clear_t_array();
 }
 
+/// the construction on the locational codes is defined only for the P-Ttrees
+template<class T> void build_tree_morton(T& tree, int) { tree.build_tree(); }
+template<class D> void build_tree_morton(P_Tree<D>& tree, int threads_num) { tree.build_tree_morton(threads_num); }
+
 #endif	/* P_TREE_H */
 
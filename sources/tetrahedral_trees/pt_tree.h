@@ -25,6 +25,9 @@
 #define	PT_TREE3D_H
 
 #include "tree.h"
+#include "common_vertices.h"
+
+#include <unordered_map>
 #include "node_v.h"
 #include <geometry/geometry_wrapper.h>
 #include <utilities/sorting.h>
@@ -68,11 +71,26 @@ public:
      * This method before inserts all the vertices and then all the tetrahedra
      */
     void build_tree();
+    ///A public method that builds the tree top-down in parallel
+    /*!
+     * A node is splitted if it contains more vertices than the vertices threshold, or
+     * if it contains more tetrahedra than the tetrahedra threshold not all incident in a common vertex, as in build_tree.
+     *
+     * \param threads_num an integer argument, representing the number of threads used
+     */
+    void build_tree_bulk(int threads_num);
+
+protected:
+    ///A protected method that decides if a node is a leaf during the bulk construction
+    void bulk_node(Node_V& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool);
+
 private:
     ///A private variable representing the maximum number of vertices admitted for a node
     int vertices_threshold;
     ///A private variable representing the maximum number of tetrahedra admitted for a node
     int tetrahedra_threshold;
+    ///A private variable containing, during the construction, the vertices shared by the tetrahedra of each leaf
+    std::unordered_map<const Node_V*,Common_Vertices> leaf_common_vertices;
     ///A private method that adds a tetrahedron to the tree structure
     /*!
      * This method checks if a vertex is contained by a node, and then insert the vertex into
@@ -114,13 +132,22 @@ private:
      * \return a boolean value, true if the limit is exceeded, false otherwise
      */
     inline bool is_full_vertex(Node_V &n) { return (n.get_v_array_size() > this->vertices_threshold); }
-    ///A public method that checks if a node contains the maximum number of tetrahedra admitted
+    ///A public method that checks if a leaf contains the maximum number of tetrahedra admitted, after the insertion of a tetrahedron
     /*!
-     * \param n a Node_V& argument, represents the node to check
+     * The vertices shared by all the tetrahedra of the leaf are updated incrementally, thus the check runs in constant time.
+     *
+     * \param n a Node_V& argument, represents the leaf to check
+     * \param t an integer argument, represents the tetrahedron just inserted in the leaf
+     * \return a boolean value, true if the limit is exceeded and the tetrahedra are not all incident in a common vertex, false otherwise
+     */
+    bool is_full_tetrahedra(Node_V &n, int t);
+    ///A public method that checks if an array of tetrahedra exceeds the maximum number of tetrahedra admitted
+    /*!
+     * \param tetrahedra a const int_vect& argument, represents the tetrahedra to check
      * \param mesh a Mesh& argument, representing the tetrahedral mesh
-     * \return a boolean value, true if the limit is exceeded, false otherwise
+     * \return a boolean value, true if the limit is exceeded and the tetrahedra are not all incident in a common vertex, false otherwise
      */
-    bool is_full_tetrahedra(Node_V &n, Mesh &mesh);
+    bool is_full_tetrahedra(const int_vect &tetrahedra, Mesh &mesh);
 };
 
 template<class D> PT_Tree<D>::PT_Tree(const PT_Tree& orig) : Tree<Node_V,D>(orig)
@@ -147,6 +174,30 @@ template<class D> void PT_Tree<D>::build_tree()
     {
         this->add_tetrahedron(this->root,this->mesh.get_domain(),0,i);
     }
+    this->leaf_common_vertices.clear();
+}
+
+template<class D> void PT_Tree<D>::build_tree_bulk(int threads_num)
+{
+    Thread_Pool pool(threads_num);
+    int_vect vertices, tetrahedra;
+    vertices.reserve(this->mesh.get_num_vertices());
+    for(int i=1;i<=this->mesh.get_num_vertices();i++)
+        vertices.push_back(i);
+    this->init_bulk_tetrahedra(tetrahedra);
+    this->bulk_node(this->root,this->mesh.get_domain(),0,vertices,tetrahedra,0,pool);
+    pool.wait();
+}
+
+template<class D> void PT_Tree<D>::bulk_node(Node_V& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int, Thread_Pool& pool)
+{
+    if((int)vertices.size() > this->vertices_threshold || is_full_tetrahedra(tetrahedra,this->mesh))
+        this->bulk_split(n,domain,level,vertices,tetrahedra,0,pool);
+    else
+    {
+        n.set_v_array(vertices);
+        n.set_t_array(tetrahedra);
+    }
 }
 
 template<class D> void PT_Tree<D>::add_vertex(Node_V& n, Box& domain, int level, int v)
@@ -179,7 +230,7 @@ template<class D> void PT_Tree<D>::add_tetrahedron(Node_V& n, Box& domain, int l
     if(n.is_leaf())
     {
         n.add_tetrahedron(t);
-        if(is_full_tetrahedra(n,this->get_mesh()))
+        if(is_full_tetrahedra(n,t))
             this->split(n,domain,level);
     }
     else
@@ -195,13 +246,7 @@ template<class D> void PT_Tree<D>::add_tetrahedron(Node_V& n, Box& domain, int l
 
 template<class D> void PT_Tree<D>::split(Node_V& n, Box& domain, int level)
 {
-    n.init_sons(this->decomposition.son_number());
-    //initiliaze the son nodes
-    for(int i=0;i<this->decomposition.son_number();i++)
-    {
-        Node_V* s = new Node_V();
-        n.set_son(s,i);
-    }
+    this->init_sons(n);
 
     //reinsert the vertices
     for(RunIterator runIt = n.v_array_begin_iterator(), runEnd = n.v_array_end_iterator(); runIt != runEnd; ++runIt)
@@ -215,34 +260,31 @@ template<class D> void PT_Tree<D>::split(Node_V& n, Box& domain, int level)
     n.clear_t_array();
 }
 
-template<class D> bool PT_Tree<D>::is_full_tetrahedra(Node_V &n, Mesh &mesh)
+template<class D> bool PT_Tree<D>::is_full_tetrahedra(Node_V &n, int t)
 {
-    int t_size = n.get_t_array_size();
-    if(t_size > this->tetrahedra_threshold)
+    Common_Vertices &common = this->leaf_common_vertices[&n];
+    common.add_tetrahedron(this->mesh.get_tetrahedron(t));
+    if(n.get_t_array_size() > this->tetrahedra_threshold && !common.has_common_vertex())
     {
-        //check if the tetrahedra are all incident in a common vertex
-        vector<vertex_tetrahedron_pair> vert_vec;
-        vert_vec.assign(t_size*4,vertex_tetrahedron_pair());
-        sorting_vertices(vert_vec,n.get_t_array(),mesh);
-        int count = 1;
-        for(int i=0;i<(t_size*4)-1;i++)
-        {
-            if(vert_vec[i].v == vert_vec[i+1].v){
-                count++;
-                if(count > this->tetrahedra_threshold && count==t_size)
-                {
-                    //if we find this vertex, then we have no convinience at splitting..
-                    return false;
-                }
-            }
-            else{
-                count = 1;
-            }
-        }
+        // the leaf is going to be splitted
+        this->leaf_common_vertices.erase(&n);
         return true;
     }
     return false;
 }
 
+template<class D> bool PT_Tree<D>::is_full_tetrahedra(const int_vect &tetrahedra, Mesh &mesh)
+{
+    if((int)tetrahedra.size() > this->tetrahedra_threshold)
+    {
+        //check if the tetrahedra are all incident in a common vertex
+        //if we find this vertex, then we have no convinience at splitting..
+        Common_Vertices common;
+        common.add_tetrahedra(tetrahedra,mesh);
+        return !common.has_common_vertex();
+    }
+    return false;
+}
+
 #endif	/* PT_TREE3D_H */
 
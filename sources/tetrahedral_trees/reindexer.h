@@ -88,6 +88,17 @@ private:
      * @param mesh a Mesh& argument, the tetrahedral mesh
      */
     void update_mesh_vertices(Mesh& mesh);
+    /**
+     * @brief A private method that checks if the vertices are already sorted following the tree (as done by P_Tree::build_tree_morton)
+     *
+     * @param root a Node_V& representing the root of the tree
+     * @param mesh a Mesh& representing the tetrahedral mesh
+     * @return true if the root encodes the range of all the mesh vertices, false otherwise
+     */
+    inline bool has_coherent_vertices(Node_V &root, Mesh &mesh)
+    {
+        return (root.has_v_range() && root.get_v_start() == 1 && root.get_v_end() == mesh.get_num_vertices()+1);
+    }
 
     // FOR TETRAHEDRA
     /**
@@ -131,6 +142,15 @@ private:
      * @param mesh a Mesh& argument, the tetrahedral mesh
      */
     template<class N> void compress_t_array(N& n,int_vect &new_t_list);
+    /**
+     * @brief A private method that stores in the leaf blocks the bounding boxes of the runs of tetrahedra
+     * The bounding boxes are computed once, after the mesh has been resorted, and then read by the queries.
+     *
+     * @param n a N& argument, represents the node
+     * @param division a D& argument, representing the tree subdivision
+     * @param mesh a Mesh& argument, the tetrahedral mesh
+     */
+    template<class N,class D> void compute_run_bounding_boxes(N& n, D& division, Mesh& mesh);
     /**
      * @brief A private method that resort the tetrahedra array of the mesh
      *
@@ -169,6 +189,7 @@ template<class T> void Reindexer::reindex_tree_and_mesh(T& tree)
 
     reindex_tetrahedra(tree.get_root(),tree.get_decomposition(),tree.get_mesh());
     update_mesh_tetrahedra(tree.get_mesh());
+    compute_run_bounding_boxes(tree.get_root(),tree.get_decomposition(),tree.get_mesh());
 
     reset();
     return;
@@ -176,10 +197,13 @@ template<class T> void Reindexer::reindex_tree_and_mesh(T& tree)
 
 template<class D> void Reindexer::reindex_tree_and_mesh(P_Tree<D> &tree)
 {
-    coherent_indices.assign(tree.get_mesh().get_num_vertices(),-1);
-    reindex_vertices(tree.get_root(),tree.get_decomposition());
-    update_mesh_vertices(tree.get_mesh());
-    reset();
+    if(!has_coherent_vertices(tree.get_root(),tree.get_mesh()))
+    {
+        coherent_indices.assign(tree.get_mesh().get_num_vertices(),-1);
+        reindex_vertices(tree.get_root(),tree.get_decomposition());
+        update_mesh_vertices(tree.get_mesh());
+        reset();
+    }
 
     coherent_indices.assign(tree.get_mesh().get_num_tetrahedra(),-1);
     tetra_leaves_association.assign(tree.get_mesh().get_num_tetrahedra(),vector<pair<int,int> >());
@@ -188,6 +212,7 @@ template<class D> void Reindexer::reindex_tree_and_mesh(P_Tree<D> &tree)
 
     reindex_tetrahedra(tree.get_root(),tree.get_decomposition(),tree.get_mesh());
     update_mesh_tetrahedra(tree.get_mesh());
+    compute_run_bounding_boxes(tree.get_root(),tree.get_decomposition(),tree.get_mesh());
 
     reset();
     return;
@@ -195,10 +220,13 @@ template<class D> void Reindexer::reindex_tree_and_mesh(P_Tree<D> &tree)
 
 template<class D> void Reindexer::reindex_tree_and_mesh(PT_Tree<D> &tree)
 {
-    coherent_indices.assign(tree.get_mesh().get_num_vertices(),-1);
-    reindex_vertices(tree.get_root(),tree.get_decomposition());
-    update_mesh_vertices(tree.get_mesh());
-    reset();
+    if(!has_coherent_vertices(tree.get_root(),tree.get_mesh()))
+    {
+        coherent_indices.assign(tree.get_mesh().get_num_vertices(),-1);
+        reindex_vertices(tree.get_root(),tree.get_decomposition());
+        update_mesh_vertices(tree.get_mesh());
+        reset();
+    }
 
     coherent_indices.assign(tree.get_mesh().get_num_tetrahedra(),-1);
     tetra_leaves_association.assign(tree.get_mesh().get_num_tetrahedra(),vector<pair<int,int> >());
@@ -207,6 +235,7 @@ template<class D> void Reindexer::reindex_tree_and_mesh(PT_Tree<D> &tree)
 
     reindex_tetrahedra(tree.get_root(),tree.get_decomposition(),tree.get_mesh());
     update_mesh_tetrahedra(tree.get_mesh());
+    compute_run_bounding_boxes(tree.get_root(),tree.get_decomposition(),tree.get_mesh());
 
     reset();
     return;
@@ -333,6 +362,17 @@ template<class N,class D> void Reindexer::reindex_tetrahedra(N& n, D& division,
     }
 }
 
+template<class N,class D> void Reindexer::compute_run_bounding_boxes(N& n, D& division, Mesh &mesh)
+{
+    if (n.is_leaf())
+        n.compute_run_bounding_boxes(mesh);
+    else
+    {
+        for (int i = 0; i < division.son_number(); i++)
+            compute_run_bounding_boxes(*n.get_son(i),division,mesh);
+    }
+}
+
 template<class N> void Reindexer::compress_t_array(N& n, int_vect &new_t_list)
 {
     sort(new_t_list.begin(),new_t_list.end());
@@ -27,6 +27,7 @@
 #include "tree.h"
 #include "node_t.h"
 #include <geometry/geometry_wrapper.h>
+#include <algorithm>
 
 ///An inner-class, implementing Tree, that represents a tree which uses the RT-T criterion
 template<class D>
@@ -56,6 +57,20 @@ public:
      * Only the tetrahedra are inserted into the hierarchy.
      */
     void build_tree();
+    ///A public method that builds the tree top-down in parallel
+    /*!
+     * As in build_tree, a node is splitted as soon as its tetrahedra exceed the threshold and
+     * the tetrahedra received from the father split are not further splitted. Thus, a node with n tetrahedra
+     * received during the father split is splitted when its (max(n,threshold)+1)-th tetrahedron is inserted
+     * (following the insertion order), and its sons receive only the tetrahedra inserted up to that one.
+     *
+     * \param threads_num an integer argument, representing the number of threads used
+     */
+    void build_tree_bulk(int threads_num);
+
+protected:
+    ///A protected method that decides if a node is a leaf during the bulk construction
+    void bulk_node(Node_T& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool);
 
 private:
     ///A private variable representing the maximum number of tetrahedra admitted for a node
@@ -117,6 +132,25 @@ template<class D> void RT_Tree<D>::build_tree()
     }
 }
 
+template<class D> void RT_Tree<D>::build_tree_bulk(int threads_num)
+{
+    Thread_Pool pool(threads_num);
+    int_vect vertices, tetrahedra;
+    this->init_bulk_tetrahedra(tetrahedra);
+    this->bulk_node(this->root,this->mesh.get_domain(),0,vertices,tetrahedra,0,pool);
+    pool.wait();
+}
+
+template<class D> void RT_Tree<D>::bulk_node(Node_T& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool)
+{
+    // the insertion position that causes the split
+    int split_pos = std::max(snapshot,this->tetrahedra_threshold) + 1;
+    if((int)tetrahedra.size() >= split_pos)
+        this->bulk_split(n,domain,level,vertices,tetrahedra,split_pos,pool);
+    else
+        n.set_t_array(tetrahedra);
+}
+
 template<class D> void RT_Tree<D>::add_tetrahedron(Node_T& n, Box& domain, int level, int t)
 {
     if (!Geometry_Wrapper::tetra_in_box_build(t,domain,this->mesh)) return;
@@ -152,13 +186,7 @@ template<class D> void RT_Tree<D>::reinsert_tetrahedron_once(Node_T& n, Box& dom
 
 template<class D> void RT_Tree<D>::split(Node_T& n, Box& domain, int level)
 {
-    n.init_sons(this->decomposition.son_number());
-
-    for (int i = 0; i<this->decomposition.son_number(); i++)
-    {
-        Node_T* s = new Node_T();
-        n.set_son(s,i);
-    }
+    this->init_sons(n);
 
     // we reinsert the tetrahedra in the son nodes only once
     // thus, without splitting any further the space
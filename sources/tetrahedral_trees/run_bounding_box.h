@@ -0,0 +1,87 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RUN_BOUNDING_BOX_H
+#define RUN_BOUNDING_BOX_H
+
+#include <cmath>
+#include "basic_types/box.h"
+
+#ifdef RUN_BBOX_FLOAT
+///the type of the coordinates of the stored run bounding boxes
+typedef float run_coord;
+#else
+///the type of the coordinates of the stored run bounding boxes
+typedef double run_coord;
+#endif
+
+/**
+ * @brief A class representing the bounding box of a run of tetrahedra, stored in a compact form (without virtual tables).
+ * By default the coordinates are stored in double precision. If the RUN_BBOX_FLOAT flag is defined at compile time, they are stored
+ * in single precision, rounding the minimum down and the maximum up, so that the stored box always contains the exact one.
+ */
+class Run_Bounding_Box
+{
+public:
+    ///A constructor method
+    Run_Bounding_Box() {}
+    /**
+     * @brief A constructor method
+     * @param bb a Box& argument, representing the exact bounding box of the run
+     */
+    Run_Bounding_Box(Box &bb)
+    {
+        for(int j=0; j<3; j++)
+        {
+            this->min[j] = round_down(bb.get_min().get_c(j));
+            this->max[j] = round_up(bb.get_max().get_c(j));
+        }
+    }
+    /**
+     * @brief A public method that sets a Box with the stored bounding box
+     * @param bb a Box& argument, that is set with the stored coordinates
+     */
+    inline void get_box(Box &bb) const
+    {
+        bb.set_min(this->min[0],this->min[1],this->min[2]);
+        bb.set_max(this->max[0],this->max[1],this->max[2]);
+    }
+
+private:
+    run_coord min[3];
+    run_coord max[3];
+
+    static inline run_coord round_down(double c)
+    {
+        run_coord r = static_cast<run_coord>(c);
+        return (r > c) ? std::nextafter(r,static_cast<run_coord>(-HUGE_VAL)) : r;
+    }
+    static inline run_coord round_up(double c)
+    {
+        run_coord r = static_cast<run_coord>(c);
+        return (r < c) ? std::nextafter(r,static_cast<run_coord>(HUGE_VAL)) : r;
+    }
+};
+
+#endif // RUN_BOUNDING_BOX_H
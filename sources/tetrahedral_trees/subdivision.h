@@ -27,33 +27,19 @@
 #include "basic_types/box.h"
 
 ///A super-class, not instantiable, representing a generic spatial subdivision of a tree
+/*!
+ * The trees are templated on the subdivision type, thus the subdivisions are resolved at compile time and do not use virtual methods.
+ * A subdivision must define:
+ * - SON_NUMBER and son_number(), the (compile-time) number of sons of a node;
+ * - compute_domain(Box& parent_dom, int level, int child_ind), returning the domain of a son;
+ * - compute_domains(Box& parent_dom, int level, Box* son_doms), computing at once the domains of all the sons;
+ * - son_half(int level, int child_ind, int axis), returning which half of a coordinate axis is covered by a son.
+ */
 class Subdivision
 {
-public:
-    ///A destructor method
-    virtual ~Subdivision() {}
-    ///Public pure virtual method that returns the number of son nodes
-    /*!
-     * \return an integer value representing the number of sons
-     */
-    virtual int son_number()=0;
-    ///Public pure virtual method that computes the box domain of a node
-    /*!
-     * \param parent_dom a Box& argument, representing the node domain
-     * @param level an integer argument representing the level of n in the hierarchy
-     * \param child_ind a integer argument, representing the index position of the son in the sub-tree
-     * \return a Box value, representing the domain of the son
-     */
-    virtual Box compute_domain(Box& parent_dom, int level, int child_ind)=0;
-
 protected:
     ///A constructor method
     Subdivision() {}
-    ///A copy-constructor method
-    Subdivision(const Subdivision&) {}
-
-private:
-
 };
 
 #endif	/* _SUBDIVISION_H */
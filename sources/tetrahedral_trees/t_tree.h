@@ -25,10 +25,12 @@
 #define	T_TREE_H
 
 #include "tree.h"
+#include "common_vertices.h"
 #include "node_t.h"
 
 #include <iostream>
 #include <algorithm>
+#include <unordered_map>
 
 ///An inner-class, implementing Tree, that represents a tree which uses the pm criterion, without vertices
 template<class D>
@@ -55,9 +57,23 @@ public:
     inline void set_tetrahedra_threshold(int maxT) { this->tetrahedra_threshold = maxT; }
     ///A public method that builds the tree
     void build_tree();
+    ///A public method that builds the tree top-down in parallel
+    /*!
+     * A node is splitted if it contains more tetrahedra than the threshold not all incident in a common vertex, as in build_tree.
+     *
+     * \param threads_num an integer argument, representing the number of threads used
+     */
+    void build_tree_bulk(int threads_num);
+
+protected:
+    ///A protected method that decides if a node is a leaf during the bulk construction
+    void bulk_node(Node_T& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool);
+
 private:
     ///A private variable representing the maximum number of tetrahedra admitted for a node
     int tetrahedra_threshold;
+    ///A private variable containing, during the construction, the vertices shared by the tetrahedra of each leaf
+    std::unordered_map<const Node_T*,Common_Vertices> leaf_common_vertices;
     ///A private method that adds a tetrahedron to the tree structure
     /*!
      * This method checks if a tetrahedron has a proper intersection with the node, and then insert the tetrahedron into
@@ -79,13 +95,22 @@ private:
      * @param level an integer argument representing the level of n in the hierarchy
      */
     void split(Node_T& n, Box& domain, int level);
-    ///A public method that checks if a node contains the maximum number of tetrahedra admitted
+    ///A public method that checks if a leaf contains the maximum number of tetrahedra admitted, after the insertion of a tetrahedron
     /*!
-     * \param n a Node_T& argument, represents the node to check
+     * The vertices shared by all the tetrahedra of the leaf are updated incrementally, thus the check runs in constant time.
+     *
+     * \param n a Node_T& argument, represents the leaf to check
+     * \param t an integer argument, represents the tetrahedron just inserted in the leaf
+     * \return a boolean value, true if the limit is exceeded and the tetrahedra are not all incident in a common vertex, false otherwise
+     */
+    bool is_full(Node_T &n, int t);
+    ///A public method that checks if an array of tetrahedra exceeds the maximum number of tetrahedra admitted
+    /*!
+     * \param tetrahedra a const int_vect& argument, represents the tetrahedra to check
      * \param mesh a Mesh& argument, representing the tetrahedral mesh
-     * \return a boolean value, true if the limit is exceeded, false otherwise
+     * \return a boolean value, true if the limit is exceeded and the tetrahedra are not all incident in a common vertex, false otherwise
      */
-    bool is_full(Node_T &n, Mesh &mesh);
+    bool is_full(const int_vect &tetrahedra, Mesh &mesh);
 };
 
 template<class D> T_Tree<D>::T_Tree(int maxT)
@@ -101,6 +126,24 @@ template<class D> void T_Tree<D>::build_tree()
     {
         this->add_tetrahedron(this->root,this->mesh.get_domain(),0,i);
     }
+    this->leaf_common_vertices.clear();
+}
+
+template<class D> void T_Tree<D>::build_tree_bulk(int threads_num)
+{
+    Thread_Pool pool(threads_num);
+    int_vect vertices, tetrahedra;
+    this->init_bulk_tetrahedra(tetrahedra);
+    this->bulk_node(this->root,this->mesh.get_domain(),0,vertices,tetrahedra,0,pool);
+    pool.wait();
+}
+
+template<class D> void T_Tree<D>::bulk_node(Node_T& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int, Thread_Pool& pool)
+{
+    if(is_full(tetrahedra,this->mesh))
+        this->bulk_split(n,domain,level,vertices,tetrahedra,0,pool);
+    else
+        n.set_t_array(tetrahedra);
 }
 
 template<class D> void T_Tree<D>::add_tetrahedron(Node_T& n, Box& domain, int level, int t)
@@ -110,7 +153,7 @@ template<class D> void T_Tree<D>::add_tetrahedron(Node_T& n, Box& domain, int le
     if(n.is_leaf())
     {
         n.add_tetrahedron(t);
-        if(is_full(n,this->get_mesh()))
+        if(is_full(n,t))
             this->split(n,domain,level);
     }
     else
@@ -126,12 +169,7 @@ template<class D> void T_Tree<D>::add_tetrahedron(Node_T& n, Box& domain, int le
 
 template<class D> void T_Tree<D>::split(Node_T& n, Box& domain, int level)
 {
-    n.init_sons(this->decomposition.son_number());
-    for(int i=0;i<this->decomposition.son_number();i++)
-    {
-        Node_T* s = new Node_T();
-        n.set_son(s,i);
-    }
+    this->init_sons(n);
 
     for(RunIterator runIt = n.t_array_begin_iterator(), runEnd = n.t_array_end_iterator(); runIt != runEnd; ++runIt)
         this->add_tetrahedron(n,domain,level,*runIt);
@@ -139,35 +177,31 @@ template<class D> void T_Tree<D>::split(Node_T& n, Box& domain, int level)
     n.clear_t_array();
 }
 
-template<class D> bool T_Tree<D>::is_full(Node_T &n, Mesh &mesh)
+template<class D> bool T_Tree<D>::is_full(Node_T &n, int t)
 {
-    int t_size = n.get_t_array_size();
-    if(t_size > this->tetrahedra_threshold)
+    Common_Vertices &common = this->leaf_common_vertices[&n];
+    common.add_tetrahedron(this->mesh.get_tetrahedron(t));
+    if(n.get_t_array_size() > this->tetrahedra_threshold && !common.has_common_vertex())
     {
-        //check if the tetrahedra are all incident in a common vertex
-        vector<vertex_tetrahedron_pair> vert_vec;
-        vert_vec.assign(t_size*4,vertex_tetrahedron_pair());
-        sorting_vertices(vert_vec,n.get_t_array(),mesh);
-        int count = 1;
-        for(int i=0;i<(t_size*4)-1;i++)
-        {
-            if(vert_vec[i].v == vert_vec[i+1].v){
-                count++;
-                if(count > this->tetrahedra_threshold && count==t_size)
-                {
-                    //if we find this vertex, then we have no convinience at splitting..
-                    return false;
-                }
-            }
-            else{
-                count = 1;
-            }
-        }
+        // the leaf is going to be splitted
+        this->leaf_common_vertices.erase(&n);
         return true;
     }
     return false;
 }
 
+template<class D> bool T_Tree<D>::is_full(const int_vect &tetrahedra, Mesh &mesh)
+{
+    if((int)tetrahedra.size() > this->tetrahedra_threshold)
+    {
+        //check if the tetrahedra are all incident in a common vertex
+        //if we find this vertex, then we have no convinience at splitting..
+        Common_Vertices common;
+        common.add_tetrahedra(tetrahedra,mesh);
+        return !common.has_common_vertex();
+    }
+    return false;
+}
 
 #endif	/* T_TREE_H */
 
@@ -24,7 +24,12 @@
 #ifndef TREE_H
 #define	TREE_H
 
+#include <memory>
+#include "basic_types/basic_types.h"
 #include "basic_types/mesh.h"
+#include "geometry/geometry_wrapper.h"
+#include "utilities/thread_pool.h"
+#include "node_arena.h"
 
 ///A super-class not instantiable representing a generic tree
 template<class N, class D> class Tree
@@ -45,8 +50,28 @@ public:
      * \return a D& variable, representing the division type of the tree
      */
     inline D& get_decomposition() { return this->decomposition; }
+    ///A public method that returns the arena containing the tree nodes
+    /*!
+     * \return a Node_Arena<N>& variable, representing the arena
+     */
+    inline Node_Arena<N>& get_nodes() { return this->nodes; }
+    ///A public method that creates the sons of a node, allocating them in a contiguous block of the tree arena
+    /*!
+     * \param n a N& argument, represents the node
+     */
+    inline void init_sons(N& n) { n.set_sons(this->nodes.allocate_sons(this->decomposition.son_number())); }
     ///A public pure virtual method, implemented by the heirs class, that builds the tree
     virtual void build_tree()=0;
+    ///A public pure virtual method, implemented by the heirs class, that builds the tree top-down in parallel
+    /*!
+     * Instead of inserting the entities one at a time, each node receives the whole lists of vertices and tetrahedra
+     * it indexes and decides at once whether it must be split, following the same criterion of build_tree.
+     * The sons of a node are built as independent tasks of a work-stealing pool.
+     * The resulting tree is identical to the one produced by build_tree.
+     *
+     * \param threads_num an integer argument, representing the number of threads used
+     */
+    virtual void build_tree_bulk(int threads_num)=0;
     
 protected:
     ///A constructor method
@@ -57,6 +82,7 @@ protected:
         this->decomposition = orig.decomposition;
         this->mesh = orig.mesh;
         this->root = orig.root;
+        this->nodes = orig.nodes;
     }
     ///A destructor method
     virtual ~Tree() {}
@@ -67,6 +93,8 @@ protected:
     N root;
     ///A protected variable representing the division type of the tree
     D decomposition;
+    ///A protected variable representing the arena containing all the nodes but the root
+    Node_Arena<N> nodes;
 
     ///A protected pure virtual method, implemented by the heirs class, that split a node, creating the sons node, following the current division type
     /*!
@@ -76,9 +104,168 @@ protected:
      */
     virtual void split(N& n, Box& domain, int level)=0;
 
+    ///A protected variable representing the minimum size of the lists of a node for building its sons as separate tasks
+    static const unsigned BULK_TASK_CUTOFF = 4096;
+    ///A protected structure containing the lists of a node splitted during the bulk construction, shared by the tasks building its sons
+    struct Bulk_Block
+    {
+        int_vect vertices;
+        int_vect tetrahedra;
+        Box son_domains[D::SON_NUMBER];
+        int son_level;
+        int snapshot;
+    };
+    ///A protected pure virtual method, implemented by the heirs class, that decides if a node is a leaf during the bulk construction
+    /*!
+     * If the node is full, the method must call bulk_split, otherwise it saves the lists in the leaf
+     *
+     * \param n a N& argument, represents the node
+     * \param domain a Box& argument, represents the node domain
+     * \param level an integer argument, representing the node level in the hierarchy
+     * \param vertices an int_vect& argument, containing the vertices indexed by the node (sorted)
+     * \param tetrahedra an int_vect& argument, containing the tetrahedra intersecting the node domain (sorted)
+     * \param snapshot an integer argument, representing the number of tetrahedra received by the node when its parent was splitted
+     * \param pool a Thread_Pool& argument, executing the tasks
+     */
+    virtual void bulk_node(N& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool)=0;
+    ///A protected method that initializes the tetrahedra list of the root for the bulk construction
+    /*!
+     * \param tetrahedra an int_vect& argument, that will contain the tetrahedra intersecting the mesh domain
+     */
+    void init_bulk_tetrahedra(int_vect& tetrahedra);
+    ///A protected method that splits a node during the bulk construction and schedules the construction of its sons
+    /*!
+     * \param n a N& argument, represents the node to split
+     * \param domain a Box& argument, represents the node domain
+     * \param level an integer argument, representing the node level in the hierarchy
+     * \param vertices an int_vect& argument, containing the vertices indexed by the node (the list is consumed)
+     * \param tetrahedra an int_vect& argument, containing the tetrahedra indexed by the node (the list is consumed)
+     * \param snapshot an integer argument, representing the number of tetrahedra that the node contained before splitting
+     * \param pool a Thread_Pool& argument, executing the tasks
+     */
+    void bulk_split(N& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool);
+    ///A protected method that inserts the tetrahedra top-down into an already built hierarchy
+    /*!
+     * Each leaf receives the tetrahedra intersecting its domain, without further splitting.
+     *
+     * \param n a N& argument, represents the node
+     * \param domain a Box& argument, represents the node domain
+     * \param level an integer argument, representing the node level in the hierarchy
+     * \param tetrahedra an int_vect& argument, containing the tetrahedra intersecting the node domain (the list is consumed)
+     * \param pool a Thread_Pool& argument, executing the tasks
+     */
+    void bulk_tetrahedra(N& n, Box& domain, int level, int_vect& tetrahedra, Thread_Pool& pool);
+
 private:
+    ///A private method that extracts the lists of a son node from the ones of its father and then builds the son subtree
+    void bulk_son(N& s, int pos, std::shared_ptr<Bulk_Block> block, Thread_Pool& pool);
+    ///A private method that extracts the tetrahedra of a son node from the ones of its father, and inserts them in the son subtree
+    void bulk_son_tetrahedra(N& s, int pos, std::shared_ptr<Bulk_Block> block, Thread_Pool& pool);
 
 };
 
+template<class N, class D> void Tree<N,D>::init_bulk_tetrahedra(int_vect& tetrahedra)
+{
+    tetrahedra.reserve(this->mesh.get_num_tetrahedra());
+    for(int i=1;i<=this->mesh.get_num_tetrahedra();i++)
+    {
+        if(Geometry_Wrapper::tetra_in_box_build(i,this->mesh.get_domain(),this->mesh))
+            tetrahedra.push_back(i);
+    }
+}
+
+template<class N, class D> void Tree<N,D>::bulk_split(N& n, Box& domain, int level, int_vect& vertices, int_vect& tetrahedra, int snapshot, Thread_Pool& pool)
+{
+    std::shared_ptr<Bulk_Block> block(new Bulk_Block());
+    block->vertices.swap(vertices);
+    block->tetrahedra.swap(tetrahedra);
+    block->son_level = level + 1;
+    block->snapshot = snapshot;
+    this->decomposition.compute_domains(domain,level,block->son_domains);
+
+    this->init_sons(n);
+
+    bool spawn = (block->vertices.size() + block->tetrahedra.size() > BULK_TASK_CUTOFF);
+    for(int i=0;i<this->decomposition.son_number();i++)
+    {
+        N* s = n.get_son(i);
+        if(spawn)
+            pool.submit([this,s,i,block,&pool]() { this->bulk_son(*s,i,block,pool); });
+        else
+            this->bulk_son(*s,i,block,pool);
+    }
+}
+
+template<class N, class D> void Tree<N,D>::bulk_son(N& s, int pos, std::shared_ptr<Bulk_Block> block, Thread_Pool& pool)
+{
+    Box &son_dom = block->son_domains[pos];
+    Point &max_domain = this->mesh.get_domain().get_max();
+
+    // a vertex is inserted in the first son containing it
+    int_vect vertices;
+    for(unsigned v=0; v<block->vertices.size(); v++)
+    {
+        Vertex vert = this->mesh.get_vertex(block->vertices[v]);
+        if(!son_dom.contains(vert,max_domain))
+            continue;
+        bool first = true;
+        for(int i=0; i<pos && first; i++)
+            first = !block->son_domains[i].contains(vert,max_domain);
+        if(first)
+            vertices.push_back(block->vertices[v]);
+    }
+
+    // a tetrahedron is inserted in all the sons it intersects
+    int_vect tetrahedra;
+    int snapshot = 0;
+    for(unsigned t=0; t<block->tetrahedra.size(); t++)
+    {
+        if(Geometry_Wrapper::tetra_in_box_build(block->tetrahedra[t],son_dom,this->mesh))
+        {
+            tetrahedra.push_back(block->tetrahedra[t]);
+            if((int)t < block->snapshot)
+                snapshot++;
+        }
+    }
+
+    this->bulk_node(s,son_dom,block->son_level,vertices,tetrahedra,snapshot,pool);
+}
+template<class N, class D> void Tree<N,D>::bulk_tetrahedra(N& n, Box& domain, int level, int_vect& tetrahedra, Thread_Pool& pool)
+{
+    if(n.is_leaf())
+    {
+        n.set_t_array(tetrahedra);
+        return;
+    }
+
+    std::shared_ptr<Bulk_Block> block(new Bulk_Block());
+    block->tetrahedra.swap(tetrahedra);
+    block->son_level = level + 1;
+    block->snapshot = 0;
+    this->decomposition.compute_domains(domain,level,block->son_domains);
+
+    bool spawn = (block->tetrahedra.size() > BULK_TASK_CUTOFF);
+    for(int i=0;i<this->decomposition.son_number();i++)
+    {
+        N* s = n.get_son(i);
+        if(spawn)
+            pool.submit([this,s,i,block,&pool]() { this->bulk_son_tetrahedra(*s,i,block,pool); });
+        else
+            this->bulk_son_tetrahedra(*s,i,block,pool);
+    }
+}
+
+template<class N, class D> void Tree<N,D>::bulk_son_tetrahedra(N& s, int pos, std::shared_ptr<Bulk_Block> block, Thread_Pool& pool)
+{
+    Box &son_dom = block->son_domains[pos];
+    int_vect tetrahedra;
+    for(unsigned t=0; t<block->tetrahedra.size(); t++)
+    {
+        if(Geometry_Wrapper::tetra_in_box_build(block->tetrahedra[t],son_dom,this->mesh))
+            tetrahedra.push_back(block->tetrahedra[t]);
+    }
+    this->bulk_tetrahedra(s,son_dom,block->son_level,tetrahedra,pool);
+}
+
 #endif	/* TREE_H */
 
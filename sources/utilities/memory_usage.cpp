@@ -0,0 +1,83 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "memory_usage.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+bool Memory_Usage::reset_failed = false;
+
+size_t Memory_Usage::read_status_field(const std::string &field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status,line))
+    {
+        // each line has the form "VmRSS:     1234 kB"
+        if(line.compare(0,field.size(),field) == 0 && line.size() > field.size() && line[field.size()] == ':')
+        {
+            std::istringstream value(line.substr(field.size()+1));
+            size_t kbytes = 0;
+            value >> kbytes;
+            return kbytes * 1024;
+        }
+    }
+    return 0;
+}
+
+size_t Memory_Usage::get_rss_bytes()
+{
+    return read_status_field("VmRSS");
+}
+
+size_t Memory_Usage::get_peak_rss_bytes()
+{
+    return read_status_field("VmHWM");
+}
+
+bool Memory_Usage::reset_peak_rss()
+{
+    // writing 5 to clear_refs resets the peak resident set size (Linux 4.0 and later)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if(!clear_refs)
+        return false;
+    clear_refs << "5" << std::endl;
+    return clear_refs.good();
+}
+
+void Memory_Usage::start_phase()
+{
+    if(!reset_peak_rss() && !reset_failed)
+    {
+        std::cerr << "[MEMORY] the peak RSS cannot be reset: the peaks are the ones since the start of the execution" << std::endl;
+        reset_failed = true;
+    }
+}
+
+void Memory_Usage::print_phase(const std::string &phase)
+{
+    std::cerr << "[MEMORY] peak RSS " << phase << ": " << get_peak_rss_bytes() << " bytes (current: " << get_rss_bytes() << " bytes)" << std::endl;
+}
@@ -0,0 +1,76 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief A class measuring the memory used by the process, as resident set size (RSS).
+ * The values are read from /proc/self/status, and are 0 where it is not available.
+ * The peak of a phase is obtained by resetting the peak before the phase starts, and by reading it once finished.
+ * The reset is supported by Linux only (/proc/self/clear_refs): if it fails, the peaks printed are the ones of the whole execution.
+ */
+class Memory_Usage
+{
+public:
+    /**
+     * @brief A public static method that returns the current resident set size of the process
+     * @return a size_t value, in bytes
+     */
+    static size_t get_rss_bytes();
+    /**
+     * @brief A public static method that returns the peak resident set size of the process, since the start or the last reset
+     * @return a size_t value, in bytes
+     */
+    static size_t get_peak_rss_bytes();
+    /**
+     * @brief A public static method that resets the peak resident set size to the current one
+     * @return true if the peak has been reset, false otherwise
+     */
+    static bool reset_peak_rss();
+    /**
+     * @brief A public static procedure that starts a phase, resetting the peak resident set size
+     */
+    static void start_phase();
+    /**
+     * @brief A public static procedure that prints on the standard error the peak and the current resident set size of a phase
+     * @param phase a string containing the name of the phase
+     */
+    static void print_phase(const std::string &phase);
+
+private:
+    /**
+     * @brief A private static method that reads a field of /proc/self/status
+     * @param field a string containing the name of the field (e.g., VmRSS)
+     * @return a size_t value, in bytes
+     */
+    static size_t read_status_field(const std::string &field);
+    ///A private variable that is true if the last reset of the peak has failed
+    static bool reset_failed;
+};
+
+#endif // MEMORY_USAGE_H
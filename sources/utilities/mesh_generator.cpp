@@ -0,0 +1,274 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mesh_generator.h"
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <iostream>
+
+// the Kuhn tetrahedra of a cell: each one follows a monotone path from the corner (0,0,0) to the corner (1,1,1), moving along the axes in the given order
+static const int KUHN_PATHS[6][3] = { {0,1,2}, {1,2,0}, {2,0,1}, {0,2,1}, {1,0,2}, {2,1,0} };
+// the odd permutations (the last three) are written with two vertices swapped, so that all the tetrahedra have the same orientation
+static const int KUHN_EVEN_PATHS = 3;
+
+constexpr double Mesh_Generator::MAX_JITTER;
+
+Mesh_Generator::Mesh_Generator(int nx, int ny, int nz, uint64_t seed)
+{
+    this->nx = std::max(1,nx);
+    this->ny = std::max(1,ny);
+    this->nz = std::max(1,nz);
+    this->seed = seed;
+    this->jitter = 0;
+    this->grading = 0;
+    this->center[0] = this->center[1] = this->center[2] = 0.5;
+    this->notch = false;
+    this->tetrahedra_num = 0;
+}
+
+void Mesh_Generator::set_jitter(double jitter)
+{
+    this->jitter = std::min(std::max(jitter,0.0),MAX_JITTER);
+}
+
+void Mesh_Generator::set_grading(double grading, double cx, double cy, double cz)
+{
+    this->grading = std::max(grading,0.0);
+    double c[3] = { cx, cy, cz };
+    // the stretching function is not defined for a clustering point on the boundary
+    for(int a=0; a<3; a++)
+        this->center[a] = std::min(std::max(c[a],0.01),0.99);
+}
+
+void Mesh_Generator::set_holes(int holes_num)
+{
+    this->holes.clear();
+    this->plane_offsets.clear();
+    mt19937_64 gen(this->seed);
+    uniform_real_distribution<double> center_dist(0.15,0.85);
+    uniform_real_distribution<double> radius_dist(0.05,0.15);
+    for(int h=0; h<holes_num; h++)
+    {
+        Hole hole;
+        hole.x = center_dist(gen);
+        hole.y = center_dist(gen);
+        hole.z = center_dist(gen);
+        hole.radius = radius_dist(gen);
+        this->holes.push_back(hole);
+    }
+}
+
+int64_t Mesh_Generator::get_vertices_num()
+{
+    if(this->plane_offsets.empty())
+        this->count_entities();
+    return this->plane_offsets.back();
+}
+
+int64_t Mesh_Generator::get_tetrahedra_num()
+{
+    if(this->plane_offsets.empty())
+        this->count_entities();
+    return this->tetrahedra_num;
+}
+
+bool Mesh_Generator::is_cell_kept(int i, int j, int k) const
+{
+    if(i < 0 || j < 0 || k < 0 || i >= this->nx || j >= this->ny || k >= this->nz)
+        return false;
+    // the tests are made on the center of the cell, relative to the grid (i.e., before the grading)
+    double x = (i + 0.5) / this->nx, y = (j + 0.5) / this->ny, z = (k + 0.5) / this->nz;
+    if(this->notch && x > 0.5 && y > 0.5 && z > 0.5)
+        return false;
+    for(unsigned h=0; h<this->holes.size(); h++)
+    {
+        const Hole &hole = this->holes[h];
+        double dx = x - hole.x, dy = y - hole.y, dz = z - hole.z;
+        if(dx*dx + dy*dy + dz*dz < hole.radius*hole.radius)
+            return false;
+    }
+    return true;
+}
+
+void Mesh_Generator::get_cells_layer(int k, vector<char> &cells) const
+{
+    cells.assign((this->nx+2)*(this->ny+2),0);
+    if(k < 0 || k >= this->nz)
+        return;
+    for(int j=0; j<this->ny; j++)
+    {
+        for(int i=0; i<this->nx; i++)
+            cells[(j+1)*(this->nx+2)+(i+1)] = this->is_cell_kept(i,j,k);
+    }
+}
+
+void Mesh_Generator::get_vertices_plane(const vector<char> &below, const vector<char> &above, int64_t first_id, vector<int64_t> &ids) const
+{
+    ids.assign((this->nx+1)*(this->ny+1),-1);
+    int64_t next_id = first_id;
+    int row = this->nx+2;
+    for(int j=0; j<=this->ny; j++)
+    {
+        for(int i=0; i<=this->nx; i++)
+        {
+            // the vertex (i,j) is shared by the cells (i-1..i, j-1..j) of the layers below and above the plane (shifted by the border)
+            int c = j*row + i;
+            if(below[c] || below[c+1] || below[c+row] || below[c+row+1] ||
+               above[c] || above[c+1] || above[c+row] || above[c+row+1])
+                ids[j*(this->nx+1)+i] = next_id++;
+        }
+    }
+}
+
+void Mesh_Generator::count_entities()
+{
+    this->plane_offsets.assign(this->nz+2,0);
+    this->tetrahedra_num = 0;
+
+    vector<char> below, above;
+    vector<int64_t> ids;
+    this->get_cells_layer(-1,below);
+    for(int k=0; k<=this->nz; k++)
+    {
+        this->get_cells_layer(k,above);
+        this->get_vertices_plane(below,above,0,ids);
+        this->plane_offsets[k+1] = this->plane_offsets[k] + (int64_t)std::count_if(ids.begin(),ids.end(),[](int64_t id) { return id >= 0; });
+        this->tetrahedra_num += 6 * (int64_t)std::count(above.begin(),above.end(),1);
+        below.swap(above);
+    }
+}
+
+double Mesh_Generator::get_random(uint64_t key) const
+{
+    // splitmix64
+    uint64_t z = this->seed + (key + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return (z >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+double Mesh_Generator::grade(int axis, double u) const
+{
+    if(this->grading == 0)
+        return u;
+    // the interior clustering of Vinokur, with f(0)=0, f(1)=1 and the densest spacing at the center
+    double b = this->grading, c = this->center[axis];
+    double a = 0.5 / b * log((1 + (exp(b) - 1) * c) / (1 + (exp(-b) - 1) * c));
+    return c * (1 + sinh(b * (u - a)) / sinh(b * a));
+}
+
+double Mesh_Generator::get_coordinate(int axis, int p, int n, uint64_t vertex_key) const
+{
+    double coord = n * this->grade(axis,(double)p / n);
+    // the vertices on the boundary are not moved along the axis, thus the domain remains a box
+    if(this->jitter > 0 && p > 0 && p < n)
+    {
+        double side = std::min(n * this->grade(axis,(double)(p+1) / n) - coord, coord - n * this->grade(axis,(double)(p-1) / n));
+        coord += this->jitter * side * this->get_random(3 * vertex_key + axis);
+    }
+    return coord;
+}
+
+bool Mesh_Generator::write_ts(string path)
+{
+    if(this->plane_offsets.empty())
+        this->count_entities();
+
+    FILE *file = fopen(path.c_str(),"w");
+    if(file == NULL)
+        return false;
+    vector<char> buffer(1 << 22);
+    setvbuf(file,&buffer[0],_IOFBF,buffer.size());
+
+    fprintf(file,"%lld %lld\n",(long long)this->plane_offsets.back(),(long long)this->tetrahedra_num);
+
+    // the vertices, following the order of their indices (by plane, row and column)
+    vector<char> below, above;
+    vector<int64_t> ids;
+    this->get_cells_layer(-1,below);
+    for(int k=0; k<=this->nz; k++)
+    {
+        this->get_cells_layer(k,above);
+        this->get_vertices_plane(below,above,this->plane_offsets[k],ids);
+        for(int j=0; j<=this->ny; j++)
+        {
+            for(int i=0; i<=this->nx; i++)
+            {
+                if(ids[j*(this->nx+1)+i] < 0)
+                    continue;
+                uint64_t key = ((uint64_t)k * (this->ny+1) + j) * (this->nx+1) + i;
+                double x = this->get_coordinate(0,i,this->nx,key);
+                double y = this->get_coordinate(1,j,this->ny,key);
+                double z = this->get_coordinate(2,k,this->nz,key);
+                // the field value is the distance from the center of the domain
+                double field = sqrt((x/this->nx-0.5)*(x/this->nx-0.5) + (y/this->ny-0.5)*(y/this->ny-0.5) + (z/this->nz-0.5)*(z/this->nz-0.5));
+                fprintf(file,"%.10g %.10g %.10g %.10g\n",x,y,z,field);
+            }
+        }
+        below.swap(above);
+    }
+
+    // the tetrahedra, one layer of cells at a time (the vertex indices start from 0 in the .ts format)
+    vector<char> current;
+    vector<int64_t> low_ids, high_ids;
+    this->get_cells_layer(-1,below);
+    this->get_cells_layer(0,current);
+    this->get_vertices_plane(below,current,this->plane_offsets[0],low_ids);
+    for(int k=0; k<this->nz; k++)
+    {
+        this->get_cells_layer(k+1,above);
+        this->get_vertices_plane(current,above,this->plane_offsets[k+1],high_ids);
+        for(int j=0; j<this->ny; j++)
+        {
+            for(int i=0; i<this->nx; i++)
+            {
+                if(!current[(j+1)*(this->nx+2)+(i+1)])
+                    continue;
+                for(int t=0; t<6; t++)
+                {
+                    int64_t tet[4];
+                    int corner[3] = { 0, 0, 0 };
+                    for(int v=0; v<4; v++)
+                    {
+                        if(v > 0)
+                            corner[KUHN_PATHS[t][v-1]] = 1;
+                        const vector<int64_t> &plane = corner[2] ? high_ids : low_ids;
+                        tet[v] = plane[(j+corner[1])*(this->nx+1)+(i+corner[0])];
+                    }
+                    if(t >= KUHN_EVEN_PATHS)
+                        std::swap(tet[2],tet[3]);
+                    fprintf(file,"%lld %lld %lld %lld\n",(long long)tet[0],(long long)tet[1],(long long)tet[2],(long long)tet[3]);
+                }
+            }
+        }
+        current.swap(above);
+        low_ids.swap(high_ids);
+    }
+
+    bool ok = !ferror(file);
+    return (fclose(file) == 0) && ok;
+}
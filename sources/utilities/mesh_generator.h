@@ -0,0 +1,142 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MESH_GENERATOR_H
+#define MESH_GENERATOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+using namespace std;
+
+/**
+ * @brief A class that generates synthetic tetrahedral meshes, for measuring how the costs of the trees scale with the size of the mesh.
+ * The mesh is the Kuhn (Freudenthal) tetrahedralization of a grid of nx*ny*nz cells, in which each cell is split in six tetrahedra
+ * sharing its main diagonal. The vertices can be moved by a random jitter, and clustered around a point of the domain (graded density),
+ * while the cells inside some spherical holes, and in a corner of the domain (notch, giving a non-convex boundary), can be removed.
+ *
+ * The mesh is written in a .ts file without being stored in memory: the vertices and the tetrahedra are generated one layer of cells at a time,
+ * and only the O(nx*ny) entries of the current layers are kept. Each random value is computed from the seed and the position of the vertex,
+ * thus the same parameters always produce the same file.
+ */
+class Mesh_Generator
+{
+public:
+    /**
+     * @brief A constructor method
+     * @param nx an integer representing the number of cells along the x axis
+     * @param ny an integer representing the number of cells along the y axis
+     * @param nz an integer representing the number of cells along the z axis
+     * @param seed the seed of the random values
+     */
+    Mesh_Generator(int nx, int ny, int nz, uint64_t seed);
+    /**
+     * @brief A public method that sets the jitter of the vertices
+     * Each coordinate of a vertex is moved by a random offset of at most jitter times the side of the adjacent cells along that axis.
+     * The jitter is clamped to MAX_JITTER, so that no tetrahedron is inverted, and the vertices on the boundary are moved only along it.
+     * @param jitter a double in [0,MAX_JITTER]
+     */
+    void set_jitter(double jitter);
+    /**
+     * @brief A public method that sets the grading of the vertices
+     * The coordinates along each axis are clustered around the point (cx,cy,cz) (in [0,1]^3), following a sinh stretching function.
+     * As the stretching is monotone and separable, each cell remains a box and the tetrahedra remain valid.
+     * @param grading a double representing the clustering strength (0 means a uniform grid)
+     * @param cx, cy, cz the clustering point, relative to the domain
+     */
+    void set_grading(double grading, double cx = 0.5, double cy = 0.5, double cz = 0.5);
+    /**
+     * @brief A public method that sets the number of spherical holes
+     * The centers and the radii of the holes are randomly picked from the seed: the cells whose center is inside a hole are removed.
+     * @param holes_num an integer
+     */
+    void set_holes(int holes_num);
+    /**
+     * @brief A public method that removes (or not) the cells in the upper corner of the domain (x, y and z greater than the half of the domain),
+     * producing an L-shaped, non-convex, boundary
+     * @param notch a boolean
+     */
+    void set_notch(bool notch) { this->notch = notch; this->plane_offsets.clear(); }
+    /**
+     * @brief A public method that writes the mesh in a .ts file
+     * The vertices not incident in any tetrahedron (due to the holes or to the notch) are not written.
+     * @param path a string containing the path of the file
+     * @return true if the file has been written, false otherwise
+     */
+    bool write_ts(string path);
+    /**
+     * @brief A public method that returns the number of vertices of the mesh
+     * The mesh entities are counted by the first call (also made by write_ts).
+     * @return an int64_t value
+     */
+    int64_t get_vertices_num();
+    /**
+     * @brief A public method that returns the number of tetrahedra of the mesh
+     * @return an int64_t value
+     */
+    int64_t get_tetrahedra_num();
+
+    ///the maximum jitter, as a fraction of the side of the cells
+    static constexpr double MAX_JITTER = 0.07;
+
+private:
+    ///a spherical hole, in coordinates relative to the domain
+    struct Hole { double x, y, z, radius; };
+
+    int nx, ny, nz;
+    uint64_t seed;
+    double jitter;
+    double grading;
+    double center[3];
+    bool notch;
+    vector<Hole> holes;
+    ///the number of used vertices preceding each plane of vertices (nz+2 entries, empty if not counted yet)
+    vector<int64_t> plane_offsets;
+    int64_t tetrahedra_num;
+
+    ///A private method that counts the vertices and the tetrahedra, one layer at a time
+    void count_entities();
+    ///A private method that returns true if the cell (i,j,k) belongs to the mesh (false outside the grid)
+    bool is_cell_kept(int i, int j, int k) const;
+    ///A private method that sets the cells of the layer k kept by the mesh ((nx+2)*(ny+2) entries, with a border of removed cells)
+    void get_cells_layer(int k, vector<char> &cells) const;
+    /**
+     * @brief A private method that sets the indices of the vertices of the plane k, or -1 for the vertices not used
+     * @param below the cells of the layer k-1
+     * @param above the cells of the layer k
+     * @param first_id the index of the first used vertex of the plane
+     * @param ids the (nx+1)*(ny+1) indices
+     */
+    void get_vertices_plane(const vector<char> &below, const vector<char> &above, int64_t first_id, vector<int64_t> &ids) const;
+    ///A private method that returns the coordinate of the position p (in [0,n]) along an axis, after the grading and the jitter
+    double get_coordinate(int axis, int p, int n, uint64_t vertex_key) const;
+    ///A private method that applies the grading to a relative coordinate u in [0,1]
+    double grade(int axis, double u) const;
+    ///A private method that returns a deterministic random value in [-1,1], from the seed and a key
+    double get_random(uint64_t key) const;
+};
+
+#endif // MESH_GENERATOR_H
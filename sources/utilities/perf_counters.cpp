@@ -0,0 +1,220 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "perf_counters.h"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+std::atomic<bool> Perf_Counters::enabled(false);
+std::atomic<bool> Perf_Counters::failure_reported(false);
+
+Perf_Counters::Perf_Counters(bool inherit)
+{
+    this->inherit = inherit;
+    this->opened = false;
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        this->fds[e] = -1;
+        this->values[e] = 0;
+    }
+}
+
+Perf_Counters::~Perf_Counters()
+{
+#ifdef __linux__
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        if(this->fds[e] >= 0)
+            close(this->fds[e]);
+    }
+#endif
+}
+
+const char* Perf_Counters::get_event_name(Event e)
+{
+    static const char* names[EVENTS_NUM] = { "cycles", "instructions", "llc_misses", "branch_misses" };
+    return names[e];
+}
+
+void Perf_Counters::open_counters()
+{
+    this->opened = true;
+#ifdef __linux__
+    static const uint64_t configs[EVENTS_NUM] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    int error = 0;
+    bool any = false;
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        perf_event_attr attr;
+        memset(&attr,0,sizeof(perf_event_attr));
+        attr.size = sizeof(perf_event_attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.disabled = 1;
+        attr.inherit = this->inherit;
+        // counting only the user space is allowed also with a restrictive perf_event_paranoid
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // the enabled and running times are needed to scale the counters multiplexed by the kernel
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // pid 0 and cpu -1: the calling thread, on any cpu
+        this->fds[e] = syscall(__NR_perf_event_open,&attr,0,-1,-1,0);
+        if(this->fds[e] < 0)
+            error = errno;
+        else
+            any = true;
+    }
+    if(!any && !failure_reported.exchange(true))
+        cerr<<"[PERF] hardware counters not available: "<<strerror(error)<<endl;
+#else
+    if(!failure_reported.exchange(true))
+        cerr<<"[PERF] hardware counters not available on this system"<<endl;
+#endif
+}
+
+void Perf_Counters::start()
+{
+    if(!enabled)
+        return;
+    if(!this->opened)
+        this->open_counters();
+#ifdef __linux__
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        if(this->fds[e] >= 0)
+        {
+            ioctl(this->fds[e],PERF_EVENT_IOC_RESET,0);
+            ioctl(this->fds[e],PERF_EVENT_IOC_ENABLE,0);
+        }
+    }
+#endif
+}
+
+void Perf_Counters::stop()
+{
+    if(!enabled || !this->opened)
+        return;
+#ifdef __linux__
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        if(this->fds[e] >= 0)
+            ioctl(this->fds[e],PERF_EVENT_IOC_DISABLE,0);
+    }
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        this->values[e] = 0;
+        if(this->fds[e] < 0)
+            continue;
+        // value, time enabled, time running
+        uint64_t data[3];
+        if(read(this->fds[e],data,sizeof(data)) != sizeof(data))
+            continue;
+        if(data[2] > 0 && data[2] < data[1])
+            this->values[e] = (uint64_t)((double)data[0] * data[1] / data[2]);
+        else
+            this->values[e] = data[0];
+    }
+#endif
+}
+
+void Perf_Counters::print_counters(string caption)
+{
+    if(!enabled)
+        return;
+    cerr<<"[PERF] "<<caption;
+    for(int e=0; e<EVENTS_NUM; e++)
+    {
+        cerr<<" "<<get_event_name((Event)e)<<": ";
+        if(this->is_available((Event)e))
+            cerr<<this->values[e];
+        else
+            cerr<<"n/a";
+    }
+    if(this->is_available(CYCLES) && this->is_available(INSTRUCTIONS) && this->values[CYCLES] > 0)
+        cerr<<" IPC: "<<(double)this->values[INSTRUCTIONS] / this->values[CYCLES];
+    cerr<<endl;
+}
+
+Perf_Query_Summary::Perf_Query_Summary()
+{
+    for(int e=0; e<Perf_Counters::EVENTS_NUM; e++)
+    {
+        this->queries_num[e] = 0;
+        this->sums[e] = 0;
+        this->maxs[e] = 0;
+    }
+}
+
+void Perf_Query_Summary::add(const Perf_Counters &counters)
+{
+    for(int e=0; e<Perf_Counters::EVENTS_NUM; e++)
+    {
+        if(!counters.is_available((Perf_Counters::Event)e))
+            continue;
+        uint64_t value = counters.get_value((Perf_Counters::Event)e);
+        this->queries_num[e]++;
+        this->sums[e] += value;
+        if(value > this->maxs[e])
+            this->maxs[e] = value;
+    }
+}
+
+void Perf_Query_Summary::merge(const Perf_Query_Summary &other)
+{
+    for(int e=0; e<Perf_Counters::EVENTS_NUM; e++)
+    {
+        this->queries_num[e] += other.queries_num[e];
+        this->sums[e] += other.sums[e];
+        if(other.maxs[e] > this->maxs[e])
+            this->maxs[e] = other.maxs[e];
+    }
+}
+
+void Perf_Query_Summary::print_counters(string caption)
+{
+    if(!Perf_Counters::is_enabled())
+        return;
+    cerr<<"[PERF] "<<caption<<" per query (avg/max)";
+    for(int e=0; e<Perf_Counters::EVENTS_NUM; e++)
+    {
+        cerr<<" "<<Perf_Counters::get_event_name((Perf_Counters::Event)e)<<": ";
+        if(this->queries_num[e] > 0)
+            cerr<<this->sums[e] / this->queries_num[e]<<"/"<<this->maxs[e];
+        else
+            cerr<<"n/a";
+    }
+    if(this->sums[Perf_Counters::CYCLES] > 0 && this->queries_num[Perf_Counters::INSTRUCTIONS] > 0)
+        cerr<<" IPC: "<<(double)this->sums[Perf_Counters::INSTRUCTIONS] / this->sums[Perf_Counters::CYCLES];
+    cerr<<endl;
+}
@@ -0,0 +1,122 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief A class representing a set of hardware performance counters (cycles, instructions, last-level cache misses and branch misses),
+ * read through perf_event_open (Linux only).
+ * The counters are opened on the first start(), and count the events of the calling thread only in user space.
+ * With inherit, the events of the threads created after the opening (e.g., by a Thread_Pool) are counted too,
+ * thus a phase that spawns its own threads is measured as a whole.
+ * The counters are read only if they have been globally enabled (see set_enabled). When an event is not available
+ * (e.g., no access to the counters, or a virtual machine without a performance monitoring unit) it is simply reported as n/a.
+ */
+class Perf_Counters
+{
+public:
+    ///the events counted
+    enum Event { CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, EVENTS_NUM };
+
+    /**
+     * @brief A constructor method
+     * @param inherit a boolean, true if the events of the threads created by the calling thread are counted too
+     */
+    Perf_Counters(bool inherit = false);
+    ///A destructor method, that closes the counters
+    ~Perf_Counters();
+    ///A public method that resets the counters and starts counting
+    void start();
+    ///A public method that stops counting and reads the counters
+    void stop();
+    /**
+     * @brief A public method that returns true if an event has been counted
+     */
+    inline bool is_available(Event e) const { return this->fds[e] >= 0; }
+    /**
+     * @brief A public method that returns the value of an event read by the last stop (scaled if the counter has been multiplexed)
+     */
+    inline uint64_t get_value(Event e) const { return this->values[e]; }
+    /**
+     * @brief A public method that prints the counters read by the last stop, with a user-defined caption (only if the counters are enabled)
+     * @param caption a string containing the name of the measured phase
+     */
+    void print_counters(string caption);
+
+    ///A public static method that enables (or disables) the reading of the counters in the whole program
+    static inline void set_enabled(bool value) { enabled = value; }
+    ///A public static method that returns true if the counters are enabled
+    static inline bool is_enabled() { return enabled; }
+    ///A public static method that returns the name of an event
+    static const char* get_event_name(Event e);
+
+private:
+    int fds[EVENTS_NUM];
+    uint64_t values[EVENTS_NUM];
+    bool inherit;
+    bool opened;
+
+    static std::atomic<bool> enabled;
+    ///true once the unavailability of the counters has been reported
+    static std::atomic<bool> failure_reported;
+
+    ///A private method that opens the counters for the calling thread
+    void open_counters();
+
+    Perf_Counters(const Perf_Counters&);
+    Perf_Counters& operator=(const Perf_Counters&);
+};
+
+/**
+ * @brief A class representing a summary of the hardware counters read for each query of a series (average and maximum per query)
+ */
+class Perf_Query_Summary
+{
+public:
+    ///A constructor method
+    Perf_Query_Summary();
+    ///A public method that adds the counters read for a query
+    void add(const Perf_Counters &counters);
+    ///A public method that adds the queries summarized by another summary
+    void merge(const Perf_Query_Summary &other);
+    /**
+     * @brief A public method that prints the average and the maximum counters per query, with a user-defined caption (only if the counters are enabled)
+     * @param caption a string containing the name of the queries
+     */
+    void print_counters(string caption);
+
+private:
+    uint64_t queries_num[Perf_Counters::EVENTS_NUM];
+    uint64_t sums[Perf_Counters::EVENTS_NUM];
+    uint64_t maxs[Perf_Counters::EVENTS_NUM];
+};
+
+#endif // PERF_COUNTERS_H
@@ -43,3 +43,65 @@ void sorting_vertices(vector<vertex_tetrahedron_pair> &vert_vec, const vector<in
 }
 
 void sorting_faces(vector< triangle_tetrahedron_tuple >& faces) { std::sort(faces.begin(),faces.end()); }
+
+void radix_sorting(vector<code_vertex_pair> &pairs, Thread_Pool &pool)
+{
+    const int radix_bits = 8;
+    const int buckets = 1 << radix_bits;
+
+    size_t num = pairs.size();
+    int chunks_num = pool.get_threads_num();
+    if(num < (size_t)chunks_num * buckets)
+        chunks_num = 1;
+    size_t chunk_size = (num + chunks_num - 1) / chunks_num;
+
+    vector<code_vertex_pair> tmp(num);
+    vector<vector<size_t> > offsets(chunks_num,vector<size_t>(buckets,0));
+
+    for(int shift=0; shift<64; shift+=radix_bits)
+    {
+        //count the digits of each chunk
+        for(int c=0; c<chunks_num; c++)
+        {
+            pool.submit([&pairs,&offsets,c,chunk_size,num,shift]()
+            {
+                vector<size_t> &hist = offsets[c];
+                std::fill(hist.begin(),hist.end(),0);
+                for(size_t i=c*chunk_size; i<std::min(num,(c+1)*chunk_size); i++)
+                    hist[(pairs[i].code >> shift) & (buckets-1)]++;
+            });
+        }
+        pool.wait();
+
+        //turn the counters into the scatter positions
+        size_t pos = 0;
+        bool skip = false;
+        for(int d=0; d<buckets && !skip; d++)
+        {
+            size_t bucket_size = 0;
+            for(int c=0; c<chunks_num; c++)
+            {
+                size_t count = offsets[c][d];
+                offsets[c][d] = pos;
+                pos += count;
+                bucket_size += count;
+            }
+            //all the codes have the same digit
+            skip = (bucket_size == num);
+        }
+        if(skip)
+            continue;
+
+        for(int c=0; c<chunks_num; c++)
+        {
+            pool.submit([&pairs,&tmp,&offsets,c,chunk_size,num,shift]()
+            {
+                vector<size_t> &pos = offsets[c];
+                for(size_t i=c*chunk_size; i<std::min(num,(c+1)*chunk_size); i++)
+                    tmp[pos[(pairs[i].code >> shift) & (buckets-1)]++] = pairs[i];
+            });
+        }
+        pool.wait();
+        pairs.swap(tmp);
+    }
+}
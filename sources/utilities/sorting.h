@@ -26,6 +26,7 @@
 
 #include "basic_types/mesh.h"
 #include "sorting_structure.h"
+#include "thread_pool.h"
 #include <vector>
 #include <set>
 #include <list>
@@ -46,5 +47,13 @@ void sorting_vertices(vector<vertex_tetrahedron_pair> &vert_vec, const vector<in
  */
 void sorting_faces(vector<triangle_tetrahedron_tuple>& faces);
 
+/**
+ * @brief A procedure that sorts an array of code_vertex pairs with a parallel (LSD) radix sort on the codes
+ * The sort is stable, thus pairs with the same code keep their relative order.
+ *
+ * @param pairs a vector<code_vertex_pair>& argument, the array to sort
+ * @param pool a Thread_Pool& argument, executing the sorting passes
+ */
+void radix_sorting(vector<code_vertex_pair>& pairs, Thread_Pool &pool);
 
 #endif	/* _SORTING_H */
@@ -25,6 +25,7 @@
 #define SORTING_STRUCTURE_H
 
 #include <algorithm>
+#include <stdint.h>
 
 ///A container used to store couple of vertex and tetrahedron indexes
 struct vertex_tetrahedron_pair
@@ -38,6 +39,18 @@ struct vertex_tetrahedron_pair
     bool operator < (const vertex_tetrahedron_pair& p) const { return (v < p.v); }
 };
 
+///A container used to store the locational code of a vertex
+struct code_vertex_pair
+{
+    ///The locational code
+    uint64_t code;
+    ///The vertex index
+    int v;
+
+    inline code_vertex_pair() { code = 0; v = 0; }
+    bool operator < (const code_vertex_pair& p) const { return (code < p.code) || (code == p.code && v < p.v); }
+};
+
 /// for border checker
 ///A container used to store quadruplet of vertex, vertex, vertex and tetrahedron indexes
 struct triangle_tetrahedron_tuple
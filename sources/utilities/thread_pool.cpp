@@ -0,0 +1,170 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.h"
+
+// the pool, and the queue in that pool, owned by the current thread
+static thread_local Thread_Pool* current_pool = NULL;
+static thread_local int current_queue = -1;
+
+Thread_Pool::Thread_Pool(int threads_num)
+{
+    this->threads_num = (threads_num < 1) ? 1 : threads_num;
+    this->pending = 0;
+    this->queued = 0;
+    this->stop = false;
+    this->next_queue = 0;
+    // queue 0 belongs to the thread that waits on the pool
+    for(int i=0; i<this->threads_num; i++)
+        this->queues.push_back(std::unique_ptr<Task_Queue>(new Task_Queue()));
+    for(int i=1; i<this->threads_num; i++)
+        this->workers.push_back(std::thread(&Thread_Pool::worker_loop,this,i));
+}
+
+Thread_Pool::~Thread_Pool()
+{
+    this->wait();
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stop = true;
+    }
+    this->sleep_cond.notify_all();
+    for(unsigned i=0; i<this->workers.size(); i++)
+        this->workers[i].join();
+}
+
+int Thread_Pool::get_hardware_threads_num()
+{
+    int num = std::thread::hardware_concurrency();
+    return (num < 1) ? 1 : num;
+}
+
+void Thread_Pool::submit(std::function<void()> task)
+{
+    int q;
+    if(current_pool == this)
+        q = current_queue;
+    else
+        q = this->next_queue++ % this->threads_num;
+
+    this->pending++;
+    {
+        std::lock_guard<std::mutex> lock(this->queues[q]->mutex);
+        this->queues[q]->tasks.push_back(std::move(task));
+    }
+    this->queued++;
+    {
+        // synchronize with the sleeping threads, so that the notification cannot be lost
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    }
+    this->sleep_cond.notify_one();
+}
+
+void Thread_Pool::wait()
+{
+    Thread_Pool *old_pool = current_pool;
+    int old_queue = current_queue;
+    if(current_pool != this)
+    {
+        current_pool = this;
+        current_queue = 0;
+    }
+
+    std::function<void()> task;
+    while(this->pending > 0)
+    {
+        if(this->pop_task(current_queue,task))
+            this->run_task(task);
+        else
+        {
+            std::unique_lock<std::mutex> lock(this->sleep_mutex);
+            this->sleep_cond.wait(lock, [this]{ return this->pending == 0 || this->queued > 0; });
+        }
+    }
+
+    current_pool = old_pool;
+    current_queue = old_queue;
+}
+
+void Thread_Pool::worker_loop(int id)
+{
+    current_pool = this;
+    current_queue = id;
+
+    std::function<void()> task;
+    while(true)
+    {
+        if(this->pop_task(id,task))
+            this->run_task(task);
+        else
+        {
+            std::unique_lock<std::mutex> lock(this->sleep_mutex);
+            this->sleep_cond.wait(lock, [this]{ return this->stop || this->queued > 0; });
+            if(this->stop && this->queued == 0)
+                return;
+        }
+    }
+}
+
+bool Thread_Pool::pop_task(int id, std::function<void()> &task)
+{
+    // first, the most recent task of the own queue
+    {
+        Task_Queue &own = *this->queues[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            this->queued--;
+            return true;
+        }
+    }
+    // then, we steal the oldest task from the other queues
+    for(int i=1; i<this->threads_num; i++)
+    {
+        Task_Queue &other = *this->queues[(id+i) % this->threads_num];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if(!other.tasks.empty())
+        {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            this->queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Thread_Pool::run_task(std::function<void()> &task)
+{
+    task();
+    task = std::function<void()>();
+    if(--this->pending == 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        }
+        this->sleep_cond.notify_all();
+    }
+}
@@ -0,0 +1,104 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief A class representing a pool of worker threads with work-stealing scheduling.
+ * Each worker owns a double-ended queue: the tasks submitted by a worker are pushed and popped from the back of its own queue,
+ * while idle workers steal the oldest tasks from the front of the other queues.
+ * The thread that calls wait() takes part in the execution, thus a pool of n threads spawns n-1 workers.
+ */
+class Thread_Pool
+{
+public:
+    /**
+     * @brief A constructor method
+     * @param threads_num an integer representing the number of threads executing the tasks (the calling thread included)
+     */
+    Thread_Pool(int threads_num);
+    /**
+     * @brief A destructor method. The pending tasks are completed before joining the workers.
+     */
+    ~Thread_Pool();
+    /**
+     * @brief A public method that schedules a task
+     * The method can be safely called by the tasks themselves, allowing a recursive decomposition of the work
+     * @param task the procedure to execute
+     */
+    void submit(std::function<void()> task);
+    /**
+     * @brief A public method that blocks until all the submitted tasks (and the ones they spawn) are completed
+     * The calling thread executes the pending tasks while waiting.
+     */
+    void wait();
+    /**
+     * @brief A public method that returns the number of threads of the pool
+     * @return an integer
+     */
+    inline int get_threads_num() const { return this->threads_num; }
+    /**
+     * @brief A public static method that returns the number of hardware threads of the system (at least one)
+     * @return an integer
+     */
+    static int get_hardware_threads_num();
+
+private:
+    /// a double-ended queue of tasks protected by its own mutex
+    struct Task_Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    int threads_num;
+    std::vector<std::unique_ptr<Task_Queue> > queues;
+    std::vector<std::thread> workers;
+    /// the number of submitted tasks not completed yet
+    std::atomic<long> pending;
+    /// the number of tasks currently in the queues
+    std::atomic<long> queued;
+    std::atomic<bool> stop;
+    std::atomic<unsigned> next_queue;
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cond;
+
+    void worker_loop(int id);
+    bool pop_task(int id, std::function<void()> &task);
+    void run_task(std::function<void()> &task);
+
+    Thread_Pool(const Thread_Pool&);
+    Thread_Pool& operator=(const Thread_Pool&);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,141 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VISITED_SET_H
+#define VISITED_SET_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief A class representing a set of entities (e.g., the tetrahedra checked by a query) that can be cleared in constant time.
+ * Each entry is stamped with the epoch in which it has been inserted, and an entry belongs to the set if its stamp is equal to the current epoch.
+ * Clearing the set simply starts a new epoch (the stamps are reset only when the epoch counter wraps around).
+ */
+class Visited_Set
+{
+public:
+    ///A constructor method
+    Visited_Set() { this->epoch = 1; }
+    /**
+     * @brief A constructor method
+     * @param size an integer representing the number of entries (the valid positions are from 0 to size-1)
+     */
+    Visited_Set(int size) : stamps(size,0) { this->epoch = 1; }
+    /**
+     * @brief A public method that sets the number of entries, clearing the set
+     * @param size an integer representing the number of entries
+     */
+    inline void resize(int size) { this->stamps.assign(size,0); this->epoch = 1; }
+    /**
+     * @brief A public method that checks if an entry belongs to the set
+     * @param i an integer representing the entry position
+     * @return true if the entry has been inserted after the last clear, false otherwise
+     */
+    inline bool contains(int i) const { return (this->stamps[i] == this->epoch); }
+    /**
+     * @brief A public method that inserts an entry in the set
+     * @param i an integer representing the entry position
+     */
+    inline void insert(int i) { this->stamps[i] = this->epoch; }
+    /**
+     * @brief A public method that returns the bytes allocated by the set
+     * @return a size_t value
+     */
+    inline size_t get_bytes() const { return this->stamps.capacity() * sizeof(uint32_t); }
+    /**
+     * @brief A public method that removes all the entries from the set
+     */
+    inline void clear()
+    {
+        if(++this->epoch == 0)
+        {
+            std::fill(this->stamps.begin(),this->stamps.end(),0);
+            this->epoch = 1;
+        }
+    }
+
+private:
+    vector<uint32_t> stamps;
+    uint32_t epoch;
+};
+
+/**
+ * @brief A class representing a counter of the accesses to a set of entities, that is cleared in time proportional to the entries accessed.
+ * The positions of the entries accessed are stored in a list when they are accessed the first time.
+ */
+class Access_Counter
+{
+public:
+    ///A constructor method
+    Access_Counter() {}
+    /**
+     * @brief A constructor method
+     * @param size an integer representing the number of entries (the valid positions are from 0 to size-1)
+     */
+    Access_Counter(int size) : counters(size,0) {}
+    /**
+     * @brief A public method that increments the counter of an entry
+     * @param i an integer representing the entry position
+     */
+    inline void increment(int i)
+    {
+        if(this->counters[i]++ == 0)
+            this->accessed.push_back(i);
+    }
+    /**
+     * @brief A public method that returns the counter of an entry
+     * @param i an integer representing the entry position
+     * @return the number of accesses since the last clear
+     */
+    inline int get(int i) const { return this->counters[i]; }
+    /**
+     * @brief A public method that returns the bytes allocated by the counter
+     * @return a size_t value
+     */
+    inline size_t get_bytes() const { return (this->counters.capacity() + this->accessed.capacity()) * sizeof(int); }
+    /**
+     * @brief A public method that returns the positions of the entries accessed since the last clear
+     * @return a vector<int>& containing the positions, in the order of the first access
+     */
+    inline const vector<int>& get_accessed() const { return this->accessed; }
+    /**
+     * @brief A public method that resets the counters of the entries accessed
+     */
+    inline void clear()
+    {
+        for(unsigned i=0; i<this->accessed.size(); i++)
+            this->counters[this->accessed[i]] = 0;
+        this->accessed.clear();
+    }
+
+private:
+    vector<int> counters;
+    vector<int> accessed;
+};
+
+#endif // VISITED_SET_H
@@ -0,0 +1,102 @@
+/*
+    This file is part of the Tetrahedral Trees library.
+
+    Author(s): Riccardo Fellegara (riccardo.fellegara@gmail.com)
+
+    This project has been supported by the Italian Ministry of Education and
+    Research under the PRIN 2009 program, and by the National Science Foundation
+    under grant number IIS-1116747.
+
+    The Tetrahedral Trees library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    The Tetrahedral Trees library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the Tetrahedral Trees library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+/*
+ * Checks the percentiles of the Latency_Histogram on known distributions.
+ * The latencies recorded are smaller than 2*SUB_BUCKETS, thus each one has its own bucket and the percentiles are exact.
+ * Returns 0 if all the checks pass.
+ *
+ * usage: latency_histogram_test
+ */
+
+#include <iostream>
+#include "statistics/latency_histogram.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static void check(string name, uint64_t value, uint64_t expected)
+{
+    if(value != expected)
+    {
+        cerr<<"[FAIL] "<<name<<": "<<value<<" (expected "<<expected<<")"<<endl;
+        failures++;
+    }
+}
+
+///records fast_num queries with latency 10 (visiting 1 node), followed by slow_num queries with latency 100 (visiting 10 nodes)
+static Latency_Histogram two_level_histogram(uint64_t fast_num, uint64_t slow_num)
+{
+    Latency_Histogram histogram;
+    for(uint64_t i=0; i<fast_num; i++)
+        histogram.record(10,1,2);
+    for(uint64_t i=0; i<slow_num; i++)
+        histogram.record(100,10,20);
+    return histogram;
+}
+
+int main()
+{
+    uint64_t queries_num;
+    double avg_nodes, avg_tests;
+
+    // with 1000 queries, the rank of p99.9 is 999 (not the slowest query)
+    Latency_Histogram thousand = two_level_histogram(999,1);
+    check("p99.9 of 1000 queries",thousand.get_percentile(99.9),10);
+    check("p99 of 1000 queries",thousand.get_percentile(99),10);
+    check("max of 1000 queries",thousand.get_percentile(100),100);
+    thousand.get_percentile_costs(99.9,queries_num,avg_nodes,avg_tests);
+    check("p99.9 bucket queries",queries_num,999);
+    check("p99.9 bucket nodes",avg_nodes,1);
+    thousand.get_percentile_costs(100,queries_num,avg_nodes,avg_tests);
+    check("max queries",queries_num,1);
+    check("max nodes",avg_nodes,10);
+    check("max tests",avg_tests,20);
+
+    // with 10000 queries, the rank of p99.9 is 9990
+    Latency_Histogram ten_thousand = two_level_histogram(9990,10);
+    check("p99.9 of 10000 queries",ten_thousand.get_percentile(99.9),10);
+    ten_thousand = two_level_histogram(9989,11);
+    check("p99.9 of 10000 queries (11 slow)",ten_thousand.get_percentile(99.9),100);
+
+    Latency_Histogram distinct;
+    for(uint64_t i=1; i<=200; i++)
+        distinct.record(i,i,0);
+    check("p99 of 200 distinct latencies",distinct.get_percentile(99),198);
+    check("p50 of 200 distinct latencies",distinct.get_percentile(50),100);
+    check("p0 of 200 distinct latencies",distinct.get_percentile(0),1);
+
+    // the slowest query is kept by the merge, with its costs
+    Latency_Histogram merged = two_level_histogram(500,0);
+    merged.merge(two_level_histogram(499,1));
+    check("p99.9 of merged histograms",merged.get_percentile(99.9),10);
+    merged.get_percentile_costs(100,queries_num,avg_nodes,avg_tests);
+    check("max nodes of merged histograms",avg_nodes,10);
+
+    if(failures == 0)
+        cerr<<"[OK] latency histogram checks passed"<<endl;
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Checks of the latency percentiles
+#
+#-------------------------------------------------
+
+include(../tetrahedral_trees.pri)
+
+TEMPLATE = app
+TARGET = latency_histogram_test
+
+# Directories
+DESTDIR = ../dist/
+OBJECTS_DIR = ../build/latency_histogram_test/
+
+# the library sources are not compiled again, but linked from the library (built by the main project)
+LIBS += -L$$OUT_PWD/../dist -ltetrahedral_trees
+# the shared library is searched next to the executable
+QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+
+SOURCES += \
+    latency_histogram_test.cpp
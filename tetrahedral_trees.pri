@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Settings shared by the library, the executable, the benchmarks and the client
+#
+#-------------------------------------------------
+
+CONFIG   -= app_bundle
+CONFIG -= qt
+
+LANGUAGE = C++
+
+# Directories
+DESTDIR = dist/
+
+CONFIG += c++17
+QMAKE_CXXFLAGS += -pthread
+# the batched (SIMD) geometric tests must return the same results of the scalar ones, thus no FMA contraction is allowed
+QMAKE_CXXFLAGS += -ffp-contract=off
+LIBS+= -lrt -pthread
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3 \
+    -march=native
+
+# Uncomment to store the bounding boxes of the runs of tetrahedra in single precision (conservatively rounded)
+#DEFINES += RUN_BBOX_FLOAT
+# Uncomment to store the coordinates of the mesh vertices in single precision (the geometric tests use the rounded coordinates)
+#DEFINES += MESH_COORDS_FLOAT
+
+# the path is relative to this file, as the benchmarks and the client include it from their folders
+INCLUDEPATH += "$$PWD/sources"
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# The tetrahedral_trees executable, linked to the library
+#
+#-------------------------------------------------
+
+include(tetrahedral_trees.pri)
+
+TEMPLATE = app
+TARGET = tetrahedral_trees
+
+OBJECTS_DIR = build/executable/
+
+LIBS += -L$$OUT_PWD/dist -ltetrahedral_trees
+# the shared library is searched next to the executable
+QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+
+SOURCES += \
+    sources/main.cpp
+
+HEADERS += \
+    sources/main_utility_functions.h
@@ -0,0 +1,109 @@
+#-------------------------------------------------
+#
+# The Tetrahedral Trees library (libtetrahedral_trees), with its C interface (sources/api/tetrahedral_trees.h)
+#
+#-------------------------------------------------
+
+include(tetrahedral_trees.pri)
+
+TEMPLATE = lib
+TARGET = tetrahedral_trees
+# Uncomment to build a static library (libtetrahedral_trees.a) instead of a shared one
+#CONFIG += staticlib
+
+OBJECTS_DIR = build/library/
+
+SOURCES += \  
+    sources/utilities/sorting.cpp \
+    sources/geometry/geometry.cpp \
+    sources/geometry/geometry_distortion.cpp \
+    sources/geometry/geometry_wrapper.cpp \
+    sources/io/reader.cpp \
+    sources/io/writer.cpp \
+    sources/io/mapped_file.cpp \
+    sources/queries/border_checker.cpp \
+    sources/queries/topological_queries.cpp \
+    sources/tetrahedral_trees/reindexer.cpp \
+    sources/utilities/input_generator.cpp \
+    sources/utilities/mesh_generator.cpp \
+    sources/utilities/string_management.cpp \
+    sources/utilities/timer.cpp \
+    sources/utilities/thread_pool.cpp \
+    sources/utilities/perf_counters.cpp \
+    sources/utilities/memory_usage.cpp \
+    sources/server/channel.cpp \
+    sources/server/query_server.cpp \
+    sources/api/tetrahedral_trees_api.cpp \
+    sources/queries/spatial_queries.cpp \
+    sources/statistics/statistics.cpp \
+    sources/statistics/latency_histogram.cpp \
+    sources/basic_types/tetrahedron.cpp \
+    sources/tetrahedral_trees/ok_subdivision.cpp \
+    sources/tetrahedral_trees/node_t.cpp
+    
+
+HEADERS += \    
+    sources/basic_types/box.h \
+    sources/basic_types/mesh.h \
+    sources/basic_types/point.h \
+    sources/basic_types/tetrahedron.h \
+    sources/basic_types/vertex.h \
+    sources/geometry/geometry.h \
+    sources/geometry/geometry_distortion.h \
+    sources/geometry/geometry_wrapper.h \
+    sources/geometry/simd_lanes.h \
+    sources/io/reader.h \
+    sources/io/writer.h \
+    sources/io/snapshot.h \
+    sources/io/relations.h \
+    sources/io/mapped_file.h \
+    sources/queries/border_checker.h \
+    sources/queries/topological_queries.h \
+    sources/queries/topological_queries_windowed.h \
+    sources/queries/topological_relations.h \
+    sources/queries/windowed_results.h \
+    sources/server/protocol.h \
+    sources/server/channel.h \
+    sources/server/query_server.h \
+    sources/api/tetrahedral_trees.h \
+    sources/api/index_handle.h \
+    sources/queries/query_context.h \
+    sources/statistics/full_query_statistics.h \
+    sources/statistics/index_statistics.h \
+    sources/statistics/query_statistics.h \
+    sources/statistics/statistics.h \
+    sources/statistics/latency_histogram.h \
+    sources/tetrahedral_trees/kd_subdivision.h \
+    sources/tetrahedral_trees/node.h \
+    sources/tetrahedral_trees/node_arena.h \
+    sources/tetrahedral_trees/frozen_node.h \
+    sources/tetrahedral_trees/frozen_tree.h \
+    sources/tetrahedral_trees/common_vertices.h \
+    sources/tetrahedral_trees/run_bounding_box.h \
+    sources/tetrahedral_trees/node_v.h \
+    sources/tetrahedral_trees/ok_subdivision.h \
+    sources/tetrahedral_trees/reindexer.h \
+    sources/tetrahedral_trees/run_iterator.h \
+    sources/tetrahedral_trees/subdivision.h \
+    sources/utilities/input_generator.h \
+    sources/utilities/mesh_generator.h \
+    sources/utilities/sorting.h \
+    sources/utilities/sorting_structure.h \
+    sources/utilities/string_management.h \
+    sources/utilities/timer.h \
+    sources/utilities/thread_pool.h \
+    sources/utilities/perf_counters.h \
+    sources/utilities/memory_usage.h \
+    sources/utilities/visited_set.h \
+    sources/tetrahedral_trees/tree.h \
+    sources/tetrahedral_trees/pt_tree.h \
+    sources/tetrahedral_trees/t_tree.h \
+    sources/tetrahedral_trees/rt_tree.h \
+    sources/tetrahedral_trees/p_tree.h \
+    sources/queries/spatial_queries.h \
+    sources/queries/interleaved_point_locator.h \
+    sources/tetrahedral_trees/node_t.h \
+    sources/queries/topological_queries_batched.h \
+    sources/basic_types/basic_types.h
+    
+